@@ -28,6 +28,9 @@ extern "C" {
 /* Unix Domain Socket path */
 #define RBUS_DEFAULT_UDS_PATH "/tmp/rtrouted"
 
+/* rbus client default method call timeout in ms (RBUS_GET/SET_DEFAULT_TIMEOUT) */
+#define RBUS_DEFAULT_RESPONSE_TIMEOUT 15000
+
 /* Protocol version */
 #define RBUS_PROTOCOL_VERSION 1
 
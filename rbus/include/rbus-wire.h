@@ -0,0 +1,233 @@
+/*
+ * rbus-wire.h - RBus wire format decoding library
+ *
+ * Copyright 2026
+ * Licensed under the Apache License, Version 2.0
+ *
+ * Framing, header parsing, MessagePack decoding, METHOD_* identification and
+ * method field extraction for RBus messages, independent of Wireshark. All
+ * functions are reentrant: they work on caller-owned buffers, keep no global
+ * state and take their limits as arguments. Offsets in results are relative
+ * to the buffer passed in, so a caller can pass a pointer to the start of a
+ * message (or of a whole capture buffer) and map the results back onto its
+ * own data.
+ */
+
+#ifndef RBUS_WIRE_H
+#define RBUS_WIRE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Opening and closing header marker */
+#define RBUS_WIRE_MARKER 0xAAAA
+
+/* Bytes needed to compute the message length (up to and including payload_length) */
+#define RBUS_WIRE_FRAME_HEADER_LENGTH 22
+
+/* Largest header_length rbus_wire_header_plausible() accepts */
+#define RBUS_WIRE_MAX_HEADER_LENGTH 4096
+
+/* Number of MSG_ROUNDTRIP_TIME timestamps (T1-T5) */
+#define RBUS_WIRE_ROUNDTRIP_COUNT 5
+
+typedef enum {
+   RBUS_WIRE_OK = 0,
+   RBUS_WIRE_NEED_MORE = -1,    /* Buffer ends before the item does */
+   RBUS_WIRE_INVALID = -2       /* Not a valid RBus header / MessagePack object */
+} rbus_wire_status_t;
+
+/*
+ * Framing
+ */
+
+/* Whether a plausible header starts at data: marker, version, lengths and, if present, the closing marker */
+bool rbus_wire_header_plausible(const uint8_t* data, size_t length);
+
+/* Total message length (header + payload) of the header at data, or 0 if fewer than 22 bytes */
+size_t rbus_wire_message_length(const uint8_t* data, size_t length);
+
+/*
+ * Offset of the next plausible header in data, or -1. A marker too close to
+ * the end to be checked, including a lone 0xAA in the last byte, is returned
+ * as is, so framing can wait for more data.
+ */
+long rbus_wire_find_header(const uint8_t* data, size_t length);
+
+/*
+ * Header
+ */
+typedef struct {
+   uint16_t version;
+   uint16_t header_length;
+   uint32_t sequence;
+   uint32_t flags;
+   uint32_t control;
+   uint32_t payload_length;
+   uint32_t topic_offset;                           /* Topic bytes (not NUL-terminated) */
+   uint32_t topic_length;
+   uint32_t reply_topic_offset;
+   uint32_t reply_topic_length;
+   bool has_roundtrip;
+   uint32_t roundtrip[RBUS_WIRE_ROUNDTRIP_COUNT];   /* T1-T5 when has_roundtrip */
+} rbus_wire_header_t;
+
+rbus_wire_status_t rbus_wire_parse_header(const uint8_t* data, size_t length, rbus_wire_header_t* header);
+
+/*
+ * MessagePack
+ */
+typedef enum {
+   RBUS_MP_NIL,
+   RBUS_MP_BOOLEAN,
+   RBUS_MP_UINT,        /* Any integer encoding with a non-negative value */
+   RBUS_MP_INT,         /* Any integer encoding with a negative value */
+   RBUS_MP_FLOAT32,
+   RBUS_MP_FLOAT64,
+   RBUS_MP_STR,
+   RBUS_MP_BIN,
+   RBUS_MP_ARRAY,
+   RBUS_MP_MAP,
+   RBUS_MP_EXT
+} rbus_mp_type_t;
+
+typedef struct {
+   rbus_mp_type_t type;
+   uint32_t offset;        /* Offset of the type byte */
+   uint32_t length;        /* Total encoded length, including nested objects */
+   uint32_t data_offset;   /* STR/BIN/EXT: first data byte; ARRAY/MAP: first element */
+   union {
+      bool boolean;
+      uint64_t u64;
+      int64_t i64;
+      double f64;
+      uint32_t size;       /* STR/BIN/EXT: byte count; ARRAY: items; MAP: pairs */
+   } via;
+} rbus_mp_object_t;
+
+/*
+ * Decode the type byte and fixed-size head of the object at data[offset].
+ * For containers only the element count is read and length covers the head.
+ * Returns false if the object is truncated at end or the type byte is invalid.
+ */
+bool rbus_mp_read_head(const uint8_t* data, uint32_t offset, uint32_t end, rbus_mp_object_t* obj);
+
+/*
+ * Read the complete object at data[offset], nested objects included, and
+ * set obj->length to its full extent. Nesting deeper than max_depth is
+ * reported as RBUS_WIRE_INVALID.
+ */
+rbus_wire_status_t rbus_mp_read_object(const uint8_t* data, uint32_t offset, uint32_t end,
+   uint32_t max_depth, rbus_mp_object_t* obj);
+
+/*
+ * Methods
+ */
+typedef enum {
+   RBUS_METHOD_NONE = 0,              /* Not a METHOD_* string */
+   RBUS_METHOD_OTHER,                 /* METHOD_* that is not known here */
+   RBUS_METHOD_GETPARAMETERVALUES,
+   RBUS_METHOD_SETPARAMETERVALUES,
+   RBUS_METHOD_GETPARAMETERNAMES,
+   RBUS_METHOD_GETPARAMETERATTRIBUTES,
+   RBUS_METHOD_SETPARAMETERATTRIBUTES,
+   RBUS_METHOD_COMMIT,
+   RBUS_METHOD_SUBSCRIBE,
+   RBUS_METHOD_UNSUBSCRIBE,
+   RBUS_METHOD_RPC,
+   RBUS_METHOD_ADDTBLROW,
+   RBUS_METHOD_DELETETBLROW,
+   RBUS_METHOD_OPENDIRECT_CONN,
+   RBUS_METHOD_CLOSEDIRECT_CONN,
+   RBUS_METHOD_RESPONSE,
+   RBUS_METHOD_COUNT
+} rbus_method_t;
+
+/* Marker string of a method ("" for NONE, "METHOD_" for OTHER) */
+const char* rbus_wire_method_name(rbus_method_t method);
+
+/* Identify the method named by a string of length bytes */
+rbus_method_t rbus_wire_method_from_string(const uint8_t* str, size_t length);
+
+/*
+ * Payload summary: walks the top-level objects of a payload once and finds
+ * the METHOD_* marker. For consumers that need the message kind at line rate
+ * without building a tree.
+ */
+typedef struct {
+   uint32_t max_depth;          /* Nesting limit per object */
+   uint32_t max_objects;        /* Top-level objects to look at */
+} rbus_wire_limits_t;
+
+typedef struct {
+   rbus_method_t method;        /* RBUS_METHOD_NONE for events and unstructured payloads */
+   int32_t method_index;        /* Top-level index of the METHOD_* marker, -1 if none */
+   uint32_t object_count;       /* Top-level objects decoded */
+   uint32_t decoded_length;     /* Bytes covered by those objects */
+   bool complete;               /* Whole payload decoded within the limits */
+} rbus_wire_payload_t;
+
+rbus_wire_status_t rbus_wire_scan_payload(const uint8_t* data, size_t length,
+   const rbus_wire_limits_t* limits, rbus_wire_payload_t* payload);
+
+/*
+ * Method fields: the objects before the METHOD_* marker, identified per
+ * method. Consumers present or index them by id; the values a consumer acts
+ * on (session, parameter count, commit flag, error code) are read out too.
+ */
+typedef enum {
+   RBUS_FIELD_COMPONENT_NAME,
+   RBUS_FIELD_PARAM_COUNT,
+   RBUS_FIELD_PARAMETER_NAME,
+   RBUS_FIELD_EVENT_NAME,
+   RBUS_FIELD_REPLY_TOPIC,
+   RBUS_FIELD_SESSION_ID,
+   RBUS_FIELD_INVOKE_METHOD_NAME,
+   RBUS_FIELD_HAS_PARAMS,
+   RBUS_FIELD_DISCOVERY_DEPTH,
+   RBUS_FIELD_ROW_NAMES_ONLY,
+   RBUS_FIELD_TABLE_ALIAS,
+   RBUS_FIELD_ROLLBACK,
+   RBUS_FIELD_PARAMETER,        /* Name, type and value; offset is that of the name */
+   RBUS_FIELD_COMMIT,
+   RBUS_FIELD_ERROR_CODE,
+   RBUS_FIELD_FAILED_ELEMENT,
+   RBUS_FIELD_PROPERTY_COUNT,
+   RBUS_FIELD_PROPERTY,         /* Name, type and value; offset is that of the name */
+   RBUS_FIELD_COUNT
+} rbus_wire_field_id_t;
+
+typedef struct {
+   rbus_wire_field_id_t id;
+   uint32_t offset;             /* Offset of the field's object */
+} rbus_wire_field_t;
+
+typedef struct {
+   rbus_method_t method;
+   uint32_t method_index;       /* Top-level index of the METHOD_* marker */
+   rbus_wire_field_t* fields;   /* Caller's array, at least method_index entries */
+   uint32_t field_count;
+   bool set_request;            /* SET/COMMIT with a session ID; the next three are valid */
+   uint32_t session_id;
+   uint32_t param_count;        /* 0 for COMMIT */
+   bool commit;                 /* Commit flag of a SET; always true for COMMIT */
+   int32_t error_code;          /* RESPONSE, 0 if none */
+} rbus_wire_method_fields_t;
+
+/*
+ * Identify the fields of a method from its top-level objects. objects holds
+ * the method_index objects before the marker, decoded from data.
+ */
+void rbus_wire_method_fields(const uint8_t* data, const rbus_mp_object_t* objects, uint32_t method_index,
+   rbus_method_t method, rbus_wire_field_t* fields, rbus_wire_method_fields_t* result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RBUS_WIRE_H */
@@ -19,11 +19,16 @@
 #include <epan/expert.h>
 #include <epan/prefs.h>
 #include <epan/proto.h>
+#include <epan/proto_data.h>
+#include <epan/conversation.h>
+#include <epan/tap.h>
+#include <epan/srt_table.h>
+#include <epan/stats_tree.h>
 #include <epan/dissectors/packet-tcp.h>
 #include <wsutil/plugins.h>
-#include <msgpack.h>
 
 #include "rbus-protocol.h"
+#include "rbus-wire.h"
 
 /* Wireshark plugin version */
 #define PLUGIN_VERSION "1.0.0"
@@ -46,6 +51,9 @@ plugin_describe(void) {
 /* Protocol handle */
 static int proto_rbus = -1;
 
+/* Tap handle */
+static int rbus_tap = -1;
+
 /* Dissector handle */
 static dissector_handle_t rbus_handle;
 
@@ -66,6 +74,10 @@ static int hf_rbus_roundtrip_t2 = -1;
 static int hf_rbus_roundtrip_t3 = -1;
 static int hf_rbus_roundtrip_t4 = -1;
 static int hf_rbus_roundtrip_t5 = -1;
+static int hf_rbus_roundtrip_client_to_router = -1;
+static int hf_rbus_roundtrip_router_to_provider = -1;
+static int hf_rbus_roundtrip_provider = -1;
+static int hf_rbus_roundtrip_return = -1;
 static int hf_rbus_closing_marker = -1;
 static int hf_rbus_flags = -1;
 static int hf_rbus_flags_request = -1;
@@ -75,6 +87,7 @@ static int hf_rbus_flags_tainted = -1;
 static int hf_rbus_flags_raw_binary = -1;
 static int hf_rbus_flags_encrypted = -1;
 static int hf_rbus_payload = -1;
+static int hf_rbus_unsynchronized = -1;
 static int hf_rbus_payload_string = -1;
 static int hf_rbus_payload_int = -1;
 static int hf_rbus_payload_uint = -1;
@@ -159,6 +172,52 @@ static int hf_rbus_discovery_row_names_only = -1;
 static int hf_rbus_table_instance = -1;
 static int hf_rbus_table_alias = -1;
 
+/* Request/response tracking fields */
+static int hf_rbus_response_in = -1;
+static int hf_rbus_response_to = -1;
+static int hf_rbus_response_time = -1;
+static int hf_rbus_duplicate_of = -1;
+static int hf_rbus_method_id = -1;
+
+/* Event publication statistics fields */
+static int hf_rbus_event_stats = -1;
+static int hf_rbus_event_publication = -1;
+static int hf_rbus_event_previous = -1;
+static int hf_rbus_event_interarrival = -1;
+static int hf_rbus_event_jitter = -1;
+static int hf_rbus_event_rate = -1;
+static int hf_rbus_event_subscribers = -1;
+
+/* Subscription state fields */
+static int hf_rbus_subscription = -1;
+static int hf_rbus_subscription_event = -1;
+static int hf_rbus_subscription_inbox = -1;
+static int hf_rbus_subscription_subscribers = -1;
+static int hf_rbus_subscription_subscribed_in = -1;
+
+/* SET transaction fields */
+static int hf_rbus_set_txn = -1;
+static int hf_rbus_set_txn_id = -1;
+static int hf_rbus_set_txn_first = -1;
+static int hf_rbus_set_txn_commit = -1;
+static int hf_rbus_set_txn_complete = -1;
+static int hf_rbus_set_txn_messages = -1;
+static int hf_rbus_set_txn_params = -1;
+static int hf_rbus_set_txn_duration = -1;
+static int hf_rbus_set_txn_outcome = -1;
+static int hf_rbus_set_txn_error_code = -1;
+
+/* Discovery traffic fields */
+static int hf_rbus_discovery = -1;
+static int hf_rbus_discovery_inbox = -1;
+static int hf_rbus_discovery_request = -1;
+static int hf_rbus_discovery_previous = -1;
+static int hf_rbus_discovery_interval = -1;
+static int hf_rbus_discovery_window_requests = -1;
+static int hf_rbus_discovery_window_bytes = -1;
+static int hf_rbus_discovery_rate = -1;
+static int hf_rbus_discovery_fanout = -1;
+
 /* Subtree indices */
 static gint ett_rbus = -1;
 static gint ett_rbus_header = -1;
@@ -169,6 +228,10 @@ static gint ett_rbus_property = -1;
 static gint ett_rbus_metadata = -1;
 static gint ett_rbus_control = -1;
 static gint ett_rbus_event_metadata = -1;
+static gint ett_rbus_event_stats = -1;
+static gint ett_rbus_subscription = -1;
+static gint ett_rbus_set_txn = -1;
+static gint ett_rbus_discovery = -1;
 
 /* RBus Event Type IDs */
 static const value_string rbus_event_type_vals[] = {
@@ -211,6 +274,36 @@ static const value_string rbus_control_msg_type_vals[] = {
     { 0, NULL }
 };
 
+/* Request methods (rbus_method_t), as numbered in the SRT method table */
+static const value_string rbus_method_vals[] = {
+    { RBUS_METHOD_NONE, "Unknown" },
+    { RBUS_METHOD_OTHER, "Other METHOD_*" },
+    { RBUS_METHOD_GETPARAMETERVALUES, "METHOD_GETPARAMETERVALUES" },
+    { RBUS_METHOD_SETPARAMETERVALUES, "METHOD_SETPARAMETERVALUES" },
+    { RBUS_METHOD_GETPARAMETERNAMES, "METHOD_GETPARAMETERNAMES" },
+    { RBUS_METHOD_GETPARAMETERATTRIBUTES, "METHOD_GETPARAMETERATTRIBUTES" },
+    { RBUS_METHOD_SETPARAMETERATTRIBUTES, "METHOD_SETPARAMETERATTRIBUTES" },
+    { RBUS_METHOD_COMMIT, "METHOD_COMMIT" },
+    { RBUS_METHOD_SUBSCRIBE, "METHOD_SUBSCRIBE" },
+    { RBUS_METHOD_UNSUBSCRIBE, "METHOD_UNSUBSCRIBE" },
+    { RBUS_METHOD_RPC, "METHOD_RPC" },
+    { RBUS_METHOD_ADDTBLROW, "METHOD_ADDTBLROW" },
+    { RBUS_METHOD_DELETETBLROW, "METHOD_DELETETBLROW" },
+    { RBUS_METHOD_OPENDIRECT_CONN, "METHOD_OPENDIRECT_CONN" },
+    { RBUS_METHOD_CLOSEDIRECT_CONN, "METHOD_CLOSEDIRECT_CONN" },
+    { RBUS_METHOD_RESPONSE, "METHOD_RESPONSE" },
+    { 0, NULL }
+};
+
+/* SET transaction outcomes */
+static const value_string rbus_set_outcome_vals[] = {
+    { 0, "Open" },
+    { 1, "Committing" },
+    { 2, "Succeeded" },
+    { 3, "Failed" },
+    { 0, NULL }
+};
+
 /* RBus Value Type IDs */
 static const value_string rbus_type_vals[] = {
     /* CCSP/TR-181 Data Model Types (legacy, 0-5 range) */
@@ -244,18 +337,322 @@ static expert_field ei_rbus_invalid_length = EI_INIT;
 static expert_field ei_rbus_malformed_header = EI_INIT;
 static expert_field ei_rbus_truncated_packet = EI_INIT;
 static expert_field ei_rbus_msgpack_depth_exceeded = EI_INIT;
+static expert_field ei_rbus_no_response = EI_INIT;
+static expert_field ei_rbus_response_timeout = EI_INIT;
+static expert_field ei_rbus_slow_response = EI_INIT;
+static expert_field ei_rbus_unmatched_response = EI_INIT;
+static expert_field ei_rbus_duplicate_sequence = EI_INIT;
+static expert_field ei_rbus_discovery_storm = EI_INIT;
+static expert_field ei_rbus_slow_hop = EI_INIT;
+static expert_field ei_rbus_resync = EI_INIT;
+static expert_field ei_rbus_no_subscribers = EI_INIT;
+
+/* Bytes needed to compute the message length (up to and including payload_length) */
+#define RBUS_FRAME_HEADER_LENGTH RBUS_WIRE_FRAME_HEADER_LENGTH
+
+/*
+ * Frame proto data keys. Per-PDU data lives in file scope under
+ * RBUS_PDU_KEY(pdu index within the frame, kind); the PDU counter itself is
+ * packet scoped so every pass numbers the PDUs of a frame the same way.
+ */
+#define RBUS_PROTO_DATA_PDU_COUNTER 0
+#define RBUS_PDU_DATA_PAYLOAD 1
+#define RBUS_PDU_DATA_TRANSACTION 2
+#define RBUS_PDU_DATA_EVENT 3
+#define RBUS_PDU_DATA_SUBSCRIPTION 4
+#define RBUS_PDU_DATA_SET_TRANSACTION 5
+#define RBUS_PDU_DATA_DISCOVERY 6
+#define RBUS_PDU_KEY(pdu, kind) ((((guint32)(pdu) + 1) << 4) | (kind))
 
 /* Preferences */
+static bool pref_desegment = true;
 static guint32 pref_tcp_port = RBUS_DEFAULT_TCP_PORT;
 static guint32 pref_msgpack_depth_limit = 16;
 static guint32 pref_msgpack_object_limit = 20000;
+static guint32 pref_hop_threshold = 1;
+static guint32 pref_response_timeout = RBUS_DEFAULT_RESPONSE_TIMEOUT;
+static guint32 pref_response_sla = 1000;
+static guint32 pref_discovery_window = 10;
+static guint32 pref_discovery_threshold = 20;
+
+/*
+ * MessagePack objects are decoded by libRBusWire (rbus-wire.h) straight from
+ * the tvb's bytes, without copying the payload or allocating; every object
+ * carries its exact tvb offset and encoded length.
+ */
+
+/*
+ * Fetch a STR or BIN object's data as a string in pinfo->pool
+ */
+static gchar*
+rbus_mp_get_string(tvbuff_t* tvb, packet_info* pinfo, const rbus_mp_object_t* obj) {
+   return (gchar*)tvb_get_string_enc(pinfo->pool, tvb, obj->data_offset, obj->via.size, ENC_UTF_8 | ENC_NA);
+}
+
+/*
+ * Identify the method named by a STR object without copying it out of the tvb
+ */
+static rbus_method_t
+rbus_method_from_object(tvbuff_t* tvb, const rbus_mp_object_t* obj) {
+   if (obj->type != RBUS_MP_STR) {
+      return RBUS_METHOD_NONE;
+   }
+   return rbus_wire_method_from_string(tvb_get_ptr(tvb, obj->data_offset, obj->via.size), obj->via.size);
+}
+
+/*
+ * Decoded payload (IR). Every MessagePack object, nested ones included, is
+ * decoded once into a pre-order array of nodes; the payload summary, the event
+ * interpreter and the generic renderer all walk these nodes instead of
+ * re-reading the tvb. Top-level objects are decoded on first access. Nodes are
+ * stored in fixed-size blocks so pointers to them stay valid as decoding
+ * advances. A decoded payload lives in pinfo->pool; only its summary is kept
+ * across passes.
+ *
+ * Decoding is bounded: a container at the depth limit is kept as a single
+ * node whose children are skipped, not decoded, and a payload stops decoding
+ * once it has used RBUS_IR_MAX_NODES nodes.
+ */
+#define RBUS_IR_BLOCK_SHIFT 6
+#define RBUS_IR_BLOCK_SIZE (1u << RBUS_IR_BLOCK_SHIFT)
+#define RBUS_IR_MAX_NODES (1u << 18)   /* 8 MB of nodes per payload */
+
+/* method_index before the payload has been searched for a METHOD_* marker */
+#define RBUS_METHOD_INDEX_UNKNOWN (-2)
+
+typedef struct {
+   rbus_mp_object_t obj;
+   guint32 next;                /* Index of the first node after this object and its descendants */
+} rbus_mp_node_t;
+
+typedef struct {
+   guint32 node;                /* Container being filled */
+   guint64 remaining;           /* Child objects still to decode (two per map pair) */
+} rbus_mp_open_t;
+
+typedef struct {
+   tvbuff_t* tvb;               /* tvb of the current pass */
+   const guint8* data;          /* That tvb's bytes up to end */
+   guint start;                 /* Start of the payload */
+   guint parse_offset;          /* Offset of the next undecoded top-level object */
+   guint end;                   /* End of the payload */
+   gint method_index;           /* Top-level index of the METHOD_* marker, -1 if none */
+   rbus_method_t method;        /* Method named by that marker */
+   rbus_mp_node_t** blocks;     /* Node storage, RBUS_IR_BLOCK_SIZE nodes per block */
+   guint32 block_count;
+   guint32 block_capacity;      /* Allocated slots in blocks */
+   guint32 node_count;          /* Nodes decoded so far */
+   guint32 max_depth;           /* Containers at this depth are not decoded into */
+   guint32* tops;               /* Node index of each decoded top-level object */
+   guint32 count;               /* Number of top-level objects decoded so far */
+   guint32 capacity;            /* Allocated slots in tops */
+   rbus_mp_open_t* stack;       /* Open containers while decoding one top-level object */
+   guint32 stack_capacity;
+   guint32 limit;               /* Maximum number of top-level objects to decode */
+   gboolean done;               /* End of payload, decode error or limit reached */
+   gboolean limit_reached;      /* Stopped by the object limit rather than the data */
+   gboolean nodes_exhausted;    /* Stopped by RBUS_IR_MAX_NODES */
+   wmem_allocator_t* pool;
+} rbus_msgpack_cursor_t;
+
+static void
+rbus_cursor_init(rbus_msgpack_cursor_t* cursor, wmem_allocator_t* pool,
+   tvbuff_t* tvb, guint offset, guint length, guint32 limit, guint32 max_depth) {
+   memset(cursor, 0, sizeof(*cursor));
+   cursor->tvb = tvb;
+   cursor->data = tvb_get_ptr(tvb, 0, offset + length);
+   cursor->start = offset;
+   cursor->parse_offset = offset;
+   cursor->end = offset + length;
+   cursor->method_index = RBUS_METHOD_INDEX_UNKNOWN;
+   cursor->limit = limit;
+   cursor->max_depth = max_depth;
+   cursor->pool = pool;
+}
+
+static inline rbus_mp_node_t*
+rbus_cursor_node(const rbus_msgpack_cursor_t* cursor, guint32 node) {
+   return &cursor->blocks[node >> RBUS_IR_BLOCK_SHIFT][node & (RBUS_IR_BLOCK_SIZE - 1)];
+}
+
+/*
+ * Reserve the next node slot, adding a block when the current one is full.
+ * Returns NULL once the payload has used its node budget.
+ */
+static rbus_mp_node_t*
+rbus_cursor_new_node(rbus_msgpack_cursor_t* cursor) {
+   if (cursor->node_count >= RBUS_IR_MAX_NODES) {
+      return NULL;
+   }
+   if ((cursor->node_count >> RBUS_IR_BLOCK_SHIFT) == cursor->block_count) {
+      if (cursor->block_count == cursor->block_capacity) {
+         cursor->block_capacity = cursor->block_capacity ? cursor->block_capacity * 2 : 4;
+         cursor->blocks = wmem_realloc_array(cursor->pool, cursor->blocks, rbus_mp_node_t*, cursor->block_capacity);
+      }
+      cursor->blocks[cursor->block_count++] = wmem_alloc_array(cursor->pool, rbus_mp_node_t, RBUS_IR_BLOCK_SIZE);
+   }
+   return rbus_cursor_node(cursor, cursor->node_count++);
+}
+
+/*
+ * Decode the complete top-level object at parse_offset into nodes.
+ * Containers are walked with an explicit stack, so nesting depth costs no recursion.
+ * On failure the partially decoded nodes are discarded.
+ */
+static gboolean
+rbus_cursor_decode_object(rbus_msgpack_cursor_t* cursor) {
+   guint32 first = cursor->node_count;
+   guint32 depth = 0;
+   guint pos = cursor->parse_offset;
+
+   for (;;) {
+      guint32 index = cursor->node_count;
+      rbus_mp_node_t* node = rbus_cursor_new_node(cursor);
+
+      if (!node) {
+         cursor->nodes_exhausted = TRUE;
+         cursor->node_count = first;
+         return FALSE;
+      }
+      if (!rbus_mp_read_head(cursor->data, pos, cursor->end, &node->obj)) {
+         cursor->node_count = first;
+         return FALSE;
+      }
+
+      /* At the depth limit a container is only measured; its children get no nodes */
+      if ((node->obj.type == RBUS_MP_ARRAY || node->obj.type == RBUS_MP_MAP) && node->obj.via.size > 0 &&
+         depth >= cursor->max_depth) {
+         if (rbus_mp_read_object(cursor->data, pos, cursor->end, G_MAXUINT32, &node->obj) != RBUS_WIRE_OK) {
+            cursor->node_count = first;
+            return FALSE;
+         }
+      } else if ((node->obj.type == RBUS_MP_ARRAY || node->obj.type == RBUS_MP_MAP) && node->obj.via.size > 0) {
+         if (depth == cursor->stack_capacity) {
+            cursor->stack_capacity = cursor->stack_capacity ? cursor->stack_capacity * 2 : 8;
+            cursor->stack = wmem_realloc_array(cursor->pool, cursor->stack, rbus_mp_open_t, cursor->stack_capacity);
+         }
+         cursor->stack[depth].node = index;
+         cursor->stack[depth].remaining = (node->obj.type == RBUS_MP_MAP) ?
+            2 * (guint64)node->obj.via.size : node->obj.via.size;
+         depth++;
+         pos = node->obj.data_offset;
+         continue;
+      }
+
+      /* Scalar, empty or measured container: complete as read */
+      node->next = cursor->node_count;
+      pos = node->obj.offset + node->obj.length;
+
+      /* Close every container whose last child this was */
+      while (depth > 0 && --cursor->stack[depth - 1].remaining == 0) {
+         rbus_mp_node_t* container = rbus_cursor_node(cursor, cursor->stack[--depth].node);
+         container->obj.length = pos - container->obj.offset;
+         container->next = cursor->node_count;
+      }
+      if (depth == 0) {
+         break;
+      }
+   }
+
+   if (cursor->count == cursor->capacity) {
+      cursor->capacity = cursor->capacity ? cursor->capacity * 2 : 16;
+      cursor->tops = wmem_realloc_array(cursor->pool, cursor->tops, guint32, cursor->capacity);
+   }
+   cursor->tops[cursor->count++] = first;
+   cursor->parse_offset = pos;
+   return TRUE;
+}
+
+/*
+ * Decode forward until the top-level object at index is available.
+ * Returns FALSE if the payload ends (or the object limit is hit) first.
+ */
+static gboolean
+rbus_cursor_has(rbus_msgpack_cursor_t* cursor, guint32 index) {
+   while (index >= cursor->count) {
+      if (cursor->done) {
+         return FALSE;
+      }
+      if (cursor->parse_offset >= cursor->end) {
+         cursor->done = TRUE;
+         return FALSE;
+      }
+      if (cursor->count >= cursor->limit) {
+         cursor->done = TRUE;
+         cursor->limit_reached = TRUE;
+         return FALSE;
+      }
+      if (!rbus_cursor_decode_object(cursor)) {
+         cursor->done = TRUE;
+         return FALSE;
+      }
+   }
+   return TRUE;
+}
+
+/*
+ * Return the node index of the top-level object at index, which must exist
+ */
+static inline guint32
+rbus_cursor_top(const rbus_msgpack_cursor_t* cursor, guint32 index) {
+   return cursor->tops[index];
+}
+
+/*
+ * Return the top-level object at index, decoding forward as needed.
+ * Never returns NULL: indices past the end yield a zero-length NIL object.
+ */
+static const rbus_mp_object_t*
+rbus_cursor_at(rbus_msgpack_cursor_t* cursor, guint32 index) {
+   static const rbus_mp_object_t nil_object = { RBUS_MP_NIL, 0, 0, 0, { 0 } };
+
+   if (!rbus_cursor_has(cursor, index)) {
+      return &nil_object;
+   }
+   return &rbus_cursor_node(cursor, cursor->tops[index])->obj;
+}
+
+/*
+ * Return the top-level index of the payload's METHOD_* marker, -1 if none.
+ * The search runs once; the result is kept with the decoded payload.
+ */
+static gint
+rbus_cursor_method_index(tvbuff_t* tvb, rbus_msgpack_cursor_t* cursor) {
+   if (cursor->method_index == RBUS_METHOD_INDEX_UNKNOWN) {
+      cursor->method_index = -1;
+      for (guint32 i = 0; rbus_cursor_has(cursor, i); i++) {
+         rbus_method_t found = rbus_method_from_object(tvb, rbus_cursor_at(cursor, i));
+         if (found != RBUS_METHOD_NONE) {
+            cursor->method_index = i;
+            cursor->method = found;
+            break;
+         }
+      }
+   }
+   return cursor->method_index;
+}
+
+/*
+ * Number the RBus PDUs of the current frame in dissection order.
+ * The counter is packet scoped, so each pass starts again at 0.
+ */
+static guint32
+rbus_next_pdu_index(packet_info* pinfo) {
+   guint32* counter = (guint32*)p_get_proto_data(pinfo->pool, pinfo, proto_rbus, RBUS_PROTO_DATA_PDU_COUNTER);
+
+   if (!counter) {
+      counter = wmem_new0(pinfo->pool, guint32);
+      p_add_proto_data(pinfo->pool, pinfo, proto_rbus, RBUS_PROTO_DATA_PDU_COUNTER, counter);
+   }
+   return (*counter)++;
+}
 
 /* Context for tracking RBus message meta information parsing */
 typedef struct {
    guint object_index;          /* Current object being parsed */
    gboolean seen_method;        /* Have we seen a METHOD_* string? */
    guint meta_field_count;      /* Count of meta fields after METHOD_* */
-   const gchar* method_name;    /* The method name we detected */
+   rbus_method_t method;        /* The method we detected */
    guint params_count;          /* For SET: number of parameters */
    guint params_seen;           /* For SET: number of parameter fields seen (each param = 3 fields) */
 } rbus_parse_context_t;
@@ -264,8 +661,8 @@ typedef struct {
  * Helper to add a property/parameter value with the appropriate type
  * Returns a string representation of the value for namevalue field
  */
- static gchar* add_typed_value(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo, guint offset,
-   const msgpack_object* value_obj, gboolean is_property) {
+ static gchar* add_typed_value(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
+   const rbus_mp_object_t* value_obj, gboolean is_property) {
    /* Select appropriate header fields based on whether this is a property or parameter */
    int hf_string = is_property ? hf_rbus_property_value_string : hf_rbus_parameter_value_string;
    int hf_int = is_property ? hf_rbus_property_value_int : hf_rbus_parameter_value_int;
@@ -275,65 +672,63 @@ typedef struct {
    int hf_double = is_property ? hf_rbus_property_value_double : hf_rbus_parameter_value_double;
    int hf_boolean = is_property ? hf_rbus_property_value_boolean : hf_rbus_parameter_value_boolean;
 
+   guint offset = value_obj->offset;
+   guint length = value_obj->length;
    gchar* value_str = NULL;
 
    /* Handle different MessagePack value types */
    switch (value_obj->type) {
-      case MSGPACK_OBJECT_STR: {
-         gchar* str = (gchar*)wmem_alloc(pinfo->pool, value_obj->via.str.size + 1);
-         memcpy(str, value_obj->via.str.ptr, value_obj->via.str.size);
-         str[value_obj->via.str.size] = '\0';
-         proto_tree_add_string(tree, hf_string, tvb, offset, 1, str);
+      case RBUS_MP_STR: {
+         gchar* str = rbus_mp_get_string(tvb, pinfo, value_obj);
+         proto_tree_add_string(tree, hf_string, tvb, offset, length, str);
          value_str = str;
          break;
       }
-      case MSGPACK_OBJECT_BIN: {
+      case RBUS_MP_BIN: {
          /* Check if it's a boolean (RBus Boolean encoding) */
-         if (value_obj->via.bin.size == 1) {
-            guint8 byte = ((const guint8*)value_obj->via.bin.ptr)[0];
+         if (value_obj->via.size == 1) {
+            guint8 byte = tvb_get_uint8(tvb, value_obj->data_offset);
             if (byte == 0x00 || byte == 0x01) {
-               proto_tree_add_boolean(tree, hf_boolean, tvb, offset, 1, byte);
+               proto_tree_add_boolean(tree, hf_boolean, tvb, offset, length, byte);
                value_str = wmem_strdup(pinfo->pool, byte ? "true" : "false");
                break;
             }
          }
          /* Otherwise treat as string if it looks like UTF-8 */
-         gchar* str = (gchar*)wmem_alloc(pinfo->pool, value_obj->via.bin.size + 1);
-         memcpy(str, value_obj->via.bin.ptr, value_obj->via.bin.size);
-         str[value_obj->via.bin.size] = '\0';
-         proto_tree_add_string(tree, hf_string, tvb, offset, 1, str);
+         gchar* str = rbus_mp_get_string(tvb, pinfo, value_obj);
+         proto_tree_add_string(tree, hf_string, tvb, offset, length, str);
          value_str = str;
          break;
       }
-      case MSGPACK_OBJECT_POSITIVE_INTEGER:
+      case RBUS_MP_UINT:
          if (value_obj->via.u64 <= G_MAXUINT32) {
-            proto_tree_add_uint(tree, hf_uint, tvb, offset, 1, (guint32)value_obj->via.u64);
+            proto_tree_add_uint(tree, hf_uint, tvb, offset, length, (guint32)value_obj->via.u64);
             value_str = wmem_strdup_printf(pinfo->pool, "%u", (guint32)value_obj->via.u64);
          } else {
-            proto_tree_add_uint64(tree, hf_uint64, tvb, offset, 1, value_obj->via.u64);
+            proto_tree_add_uint64(tree, hf_uint64, tvb, offset, length, value_obj->via.u64);
             value_str = wmem_strdup_printf(pinfo->pool, "%" PRIu64, value_obj->via.u64);
          }
          break;
-      case MSGPACK_OBJECT_NEGATIVE_INTEGER:
+      case RBUS_MP_INT:
          if (value_obj->via.i64 >= G_MININT32 && value_obj->via.i64 <= G_MAXINT32) {
-            proto_tree_add_int(tree, hf_int, tvb, offset, 1, (gint32)value_obj->via.i64);
+            proto_tree_add_int(tree, hf_int, tvb, offset, length, (gint32)value_obj->via.i64);
             value_str = wmem_strdup_printf(pinfo->pool, "%d", (gint32)value_obj->via.i64);
          } else {
-            proto_tree_add_int64(tree, hf_int64, tvb, offset, 1, value_obj->via.i64);
+            proto_tree_add_int64(tree, hf_int64, tvb, offset, length, value_obj->via.i64);
             value_str = wmem_strdup_printf(pinfo->pool, "%" PRId64, value_obj->via.i64);
          }
          break;
-      case MSGPACK_OBJECT_FLOAT32:
-      case MSGPACK_OBJECT_FLOAT64:
-         proto_tree_add_double(tree, hf_double, tvb, offset, 1, value_obj->via.f64);
+      case RBUS_MP_FLOAT32:
+      case RBUS_MP_FLOAT64:
+         proto_tree_add_double(tree, hf_double, tvb, offset, length, value_obj->via.f64);
          value_str = wmem_strdup_printf(pinfo->pool, "%f", value_obj->via.f64);
          break;
-      case MSGPACK_OBJECT_BOOLEAN:
-         proto_tree_add_boolean(tree, hf_boolean, tvb, offset, 1, value_obj->via.boolean);
+      case RBUS_MP_BOOLEAN:
+         proto_tree_add_boolean(tree, hf_boolean, tvb, offset, length, value_obj->via.boolean);
          value_str = wmem_strdup(pinfo->pool, value_obj->via.boolean ? "true" : "false");
          break;
       default:
-         proto_tree_add_bytes_format(tree, hf_rbus_payload, tvb, offset, 1,
+         proto_tree_add_bytes_format(tree, hf_rbus_payload, tvb, offset, length,
             NULL, "Value: [Unsupported type]");
          value_str = wmem_strdup(pinfo->pool, "[unsupported]");
          break;
@@ -343,22 +738,38 @@ typedef struct {
 }
 
 /*
- * Helper to display a parsed msgpack_object recursively
+ * The children of a container at the depth limit were not decoded
+ */
+static void
+rbus_add_depth_exceeded(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo, const rbus_msgpack_cursor_t* ir,
+   const rbus_mp_object_t* obj) {
+   proto_tree_add_expert_format(tree, pinfo, &ei_rbus_msgpack_depth_exceeded, tvb, obj->data_offset,
+      obj->offset + obj->length - obj->data_offset,
+      "MessagePack depth limit (%u) exceeded; further nesting not displayed", ir->max_depth);
+}
+
+/*
+ * Helper to display a decoded MessagePack node and its children recursively
  */
 static void
-display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
-   guint offset, guint length, const msgpack_object* obj,
-   guint depth, const char* label, rbus_parse_context_t* ctx) {
-   if (depth > pref_msgpack_depth_limit) {
-      proto_tree_add_expert_format(tree, pinfo, &ei_rbus_msgpack_depth_exceeded, tvb, offset, length,
-         "MessagePack depth limit (%u) exceeded; further nesting not displayed", pref_msgpack_depth_limit);
+display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo, const rbus_msgpack_cursor_t* ir,
+   guint32 node, guint depth, const char* label, rbus_parse_context_t* ctx) {
+   const rbus_mp_object_t* obj = &rbus_cursor_node(ir, node)->obj;
+   guint offset = obj->offset;
+   guint length = obj->length;
+
+   if (!tree) {
       return;
    }
 
+   /* A tree that is only built for filtering or field extraction needs the
+    * field values but none of the label text */
+   gboolean visible = PTREE_DATA(tree)->visible;
+
    proto_item* item = NULL;
 
    switch (obj->type) {
-      case MSGPACK_OBJECT_NIL:
+      case RBUS_MP_NIL:
          if (label) {
             proto_tree_add_bytes_format(tree, hf_rbus_payload, tvb, offset, length,
                NULL, "%s: null", label);
@@ -368,7 +779,7 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
          }
          break;
 
-      case MSGPACK_OBJECT_BOOLEAN:
+      case RBUS_MP_BOOLEAN:
          if (label) {
             proto_tree_add_boolean_format(tree, hf_rbus_payload_boolean, tvb, offset, length,
                obj->via.boolean, "%s: %s", label, obj->via.boolean ? "true" : "false");
@@ -378,13 +789,15 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
          }
          break;
 
-      case MSGPACK_OBJECT_POSITIVE_INTEGER: {
+      case RBUS_MP_UINT: {
          /* Provide field labels for integers based on position */
          const char* field_label = label;
 
          /* After method is known, provide method-specific labels */
-         if (ctx && ctx->method_name) {
-            if (strcmp(ctx->method_name, "METHOD_SETPARAMETERVALUES") == 0) {
+         if (!visible) {
+            field_label = NULL;
+         } else if (ctx && ctx->method != RBUS_METHOD_NONE) {
+            if (ctx->method == RBUS_METHOD_SETPARAMETERVALUES) {
                /* SET request structure: sessionId(0), componentName(1), rollback(2), paramCount(3), params..., commit, method, ot, offset */
                if (ctx->object_index == 0) {
                   field_label = "Session ID";
@@ -398,14 +811,14 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
                } else if (ctx->meta_field_count >= 2) {
                   field_label = "Metadata Offset";
                }
-            } else if (strcmp(ctx->method_name, "METHOD_GETPARAMETERVALUES") == 0) {
+            } else if (ctx->method == RBUS_METHOD_GETPARAMETERVALUES) {
                /* GET request structure: componentName(0), paramCount(1), paramNames..., method, ot, offset */
                if (ctx->object_index == 1) {
                   field_label = "Parameter Count";
                } else if (ctx->meta_field_count >= 2) {
                   field_label = "Metadata Offset";
                }
-            } else if (strcmp(ctx->method_name, "METHOD_RESPONSE") == 0) {
+            } else if (ctx->method == RBUS_METHOD_RESPONSE) {
                /* Response structure: errorCode(0), propertyCount(1), properties..., method, ot_parent, ot_state, offset */
                if (ctx->object_index == 0) {
                   field_label = "Error Code";
@@ -450,7 +863,7 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
          break;
       }
 
-      case MSGPACK_OBJECT_NEGATIVE_INTEGER:
+      case RBUS_MP_INT:
          if (label) {
             proto_tree_add_int64_format(tree, hf_rbus_payload_int64, tvb, offset, length,
                obj->via.i64, "%s: %" PRId64, label, obj->via.i64);
@@ -460,8 +873,8 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
          }
          break;
 
-      case MSGPACK_OBJECT_FLOAT32:
-      case MSGPACK_OBJECT_FLOAT64:
+      case RBUS_MP_FLOAT32:
+      case RBUS_MP_FLOAT64:
          if (label) {
             proto_tree_add_double_format(tree, hf_rbus_payload_double, tvb, offset, length,
                obj->via.f64, "%s: %f", label, obj->via.f64);
@@ -471,18 +884,20 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
          }
          break;
 
-      case MSGPACK_OBJECT_STR: {
-         gchar* str = (gchar*)wmem_alloc(pinfo->pool, obj->via.str.size + 1);
-         memcpy(str, obj->via.str.ptr, obj->via.str.size);
-         str[obj->via.str.size] = '\0';
+      case RBUS_MP_STR: {
+         if (!visible && !proto_field_is_referenced(tree, hf_rbus_payload_string)) {
+            break;
+         }
+         gchar* str = rbus_mp_get_string(tvb, pinfo, obj);
+         rbus_method_t method = (ctx && !ctx->seen_method) ? rbus_method_from_object(tvb, obj) : RBUS_METHOD_NONE;
 
          /* Track RBus meta information fields */
          const char* field_label = label;
-         if (ctx && !ctx->seen_method && strncmp(str, "METHOD_", 7) == 0) {
+         if (method != RBUS_METHOD_NONE) {
             /* This is the method name field */
             ctx->seen_method = TRUE;
             ctx->meta_field_count = 0;
-            ctx->method_name = str;
+            ctx->method = method;
             field_label = "Method";
          } else if (ctx && ctx->seen_method && ctx->meta_field_count < 2) {
             /* These are OpenTelemetry fields after the method */
@@ -497,16 +912,16 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
             if (strcmp(str, "TRUE") == 0 || strcmp(str, "FALSE") == 0) {
                field_label = "Commit";
             }
-         } else if (ctx && ctx->method_name) {
+         } else if (ctx && ctx->method != RBUS_METHOD_NONE) {
             /* Method-specific string field handling */
-            if (strcmp(ctx->method_name, "METHOD_SETPARAMETERVALUES") == 0) {
+            if (ctx->method == RBUS_METHOD_SETPARAMETERVALUES) {
                /* SET request: track component name and parameter name fields */
                if (ctx->object_index == 1) {
                   field_label = "Component Name";
                } else if (ctx->params_count > 0 && ctx->params_seen < ctx->params_count * 3) {
                   ctx->params_seen++;
                }
-            } else if (strcmp(ctx->method_name, "METHOD_GETPARAMETERVALUES") == 0) {
+            } else if (ctx->method == RBUS_METHOD_GETPARAMETERVALUES) {
                /* GET request: first string is component name */
                if (ctx->object_index == 0) {
                   field_label = "Component Name";
@@ -527,15 +942,15 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
          break;
       }
 
-      case MSGPACK_OBJECT_BIN: {
+      case RBUS_MP_BIN: {
          /* Track parameter fields if we haven't seen the method yet and have a param count */
          if (ctx && !ctx->seen_method && ctx->params_count > 0 && ctx->params_seen < ctx->params_count * 3) {
             ctx->params_seen++;
          }
 
          /* Check for RBus Boolean encoding (1 byte: 0x00=false, 0x01=true) */
-         if (obj->via.bin.size == 1) {
-            guint8 byte = ((const guint8*)obj->via.bin.ptr)[0];
+         if (obj->via.size == 1) {
+            guint8 byte = tvb_get_uint8(tvb, obj->data_offset);
             if (byte == 0x00 || byte == 0x01) {
                /* Display as boolean value */
                if (label) {
@@ -551,12 +966,13 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
 
          /* Check if this binary data is valid UTF-8 text (common for RBus String values) */
          gboolean is_utf8 = TRUE;
-         if (obj->via.bin.size > 0) {
+         if (obj->via.size > 0) {
+            const guint8* bytes = tvb_get_ptr(tvb, obj->data_offset, obj->via.size);
             /* Simple UTF-8 validation - check for printable ASCII or valid UTF-8 sequences */
-            for (guint32 i = 0; i < obj->via.bin.size; i++) {
-               guint8 byte = ((const guint8*)obj->via.bin.ptr)[i];
+            for (guint32 i = 0; i < obj->via.size; i++) {
+               guint8 byte = bytes[i];
                /* Allow printable ASCII (0x20-0x7E), tabs, newlines, or null terminator */
-               if (byte == 0 && i == obj->via.bin.size - 1) {
+               if (byte == 0 && i == obj->via.size - 1) {
                   /* Null terminator at end is OK */
                   continue;
                }
@@ -574,15 +990,12 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
             }
          }
 
-         if (is_utf8 && obj->via.bin.size > 0) {
-            /* Display as string (RBus String type encoded as binary) */
-            gchar* str = (gchar*)wmem_alloc(pinfo->pool, obj->via.bin.size + 1);
-            memcpy(str, obj->via.bin.ptr, obj->via.bin.size);
-            str[obj->via.bin.size] = '\0';
-            /* Remove trailing null if present */
-            if (obj->via.bin.size > 0 && str[obj->via.bin.size - 1] == '\0') {
-               str[obj->via.bin.size - 1] = '\0';
+         if (is_utf8 && obj->via.size > 0) {
+            if (!visible && !proto_field_is_referenced(tree, hf_rbus_payload_string)) {
+               break;
             }
+            /* Display as string (RBus String type encoded as binary) */
+            gchar* str = rbus_mp_get_string(tvb, pinfo, obj);
             if (label) {
                proto_tree_add_string_format(tree, hf_rbus_payload_string, tvb, offset, length,
                   str, "%s: %s", label, str);
@@ -594,71 +1007,76 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
             /* Display as binary */
             if (label) {
                proto_tree_add_bytes_format(tree, hf_rbus_payload, tvb, offset, length,
-                  NULL, "%s: [Binary, %u bytes]", label, (guint)obj->via.bin.size);
+                  NULL, "%s: [Binary, %u bytes]", label, (guint)obj->via.size);
             } else {
                proto_tree_add_bytes_format_value(tree, hf_rbus_payload, tvb, offset, length,
-                  NULL, "[Binary, %u bytes]", (guint)obj->via.bin.size);
+                  NULL, "[Binary, %u bytes]", (guint)obj->via.size);
             }
          }
          break;
       }
 
-      case MSGPACK_OBJECT_ARRAY: {
+      case RBUS_MP_ARRAY: {
          proto_tree* array_tree;
          if (label) {
             item = proto_tree_add_bytes_format(tree, hf_rbus_payload, tvb, offset, length,
-               NULL, "%s: Array [%u items]", label, obj->via.array.size);
+               NULL, "%s: Array [%u items]", label, obj->via.size);
          } else {
             item = proto_tree_add_bytes_format_value(tree, hf_rbus_payload, tvb, offset, length,
-               NULL, "Array [%u items]", obj->via.array.size);
+               NULL, "Array [%u items]", obj->via.size);
          }
          array_tree = proto_item_add_subtree(item, ett_rbus_payload);
 
-         /* Display each array element using the already-parsed structure */
-         if (array_tree && obj->via.array.ptr) {
-            for (guint32 i = 0; i < obj->via.array.size; i++) {
-               gchar* elem_label = wmem_strdup_printf(pinfo->pool, "[%u]", i);
-               /* Use 1 byte length for nested elements since we don't track individual sizes */
-               display_msgpack_object(array_tree, tvb, pinfo, offset, 1,
-                  &obj->via.array.ptr[i], depth + 1, elem_label, ctx);
+         /* Display each array element with its exact byte range */
+         if (array_tree && depth >= ir->max_depth && obj->via.size > 0) {
+            rbus_add_depth_exceeded(array_tree, tvb, pinfo, ir, obj);
+         } else if (array_tree) {
+            guint32 elem = node + 1;
+            for (guint32 i = 0; i < obj->via.size; i++) {
+               gchar* elem_label = visible ? wmem_strdup_printf(pinfo->pool, "[%u]", i) : NULL;
+               display_msgpack_object(array_tree, tvb, pinfo, ir, elem, depth + 1, elem_label, ctx);
+               elem = rbus_cursor_node(ir, elem)->next;
             }
          }
          break;
       }
 
-      case MSGPACK_OBJECT_MAP: {
+      case RBUS_MP_MAP: {
          proto_tree* map_tree;
          if (label) {
             item = proto_tree_add_bytes_format(tree, hf_rbus_payload, tvb, offset, length,
-               NULL, "%s: Map [%u pairs]", label, obj->via.map.size);
+               NULL, "%s: Map [%u pairs]", label, obj->via.size);
          } else {
             item = proto_tree_add_bytes_format_value(tree, hf_rbus_payload, tvb, offset, length,
-               NULL, "Map [%u pairs]", obj->via.map.size);
+               NULL, "Map [%u pairs]", obj->via.size);
          }
          map_tree = proto_item_add_subtree(item, ett_rbus_payload);
 
          /* Display each key-value pair */
-         if (map_tree && obj->via.map.ptr) {
-            for (guint32 i = 0; i < obj->via.map.size; i++) {
-               msgpack_object_kv* kv = &obj->via.map.ptr[i];
+         if (map_tree && depth >= ir->max_depth && obj->via.size > 0) {
+            rbus_add_depth_exceeded(map_tree, tvb, pinfo, ir, obj);
+         } else if (map_tree) {
+            guint32 key = node + 1;
+            for (guint32 i = 0; i < obj->via.size; i++) {
+               const rbus_mp_object_t* key_obj = &rbus_cursor_node(ir, key)->obj;
+               guint32 val = rbus_cursor_node(ir, key)->next;
 
                /* Generate label from key */
                gchar* key_label = NULL;
-               if (kv->key.type == MSGPACK_OBJECT_STR) {
-                  key_label = wmem_strdup_printf(pinfo->pool, "%.*s",
-                     (int)kv->key.via.str.size,
-                     kv->key.via.str.ptr);
-               } else if (kv->key.type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-                  key_label = wmem_strdup_printf(pinfo->pool, "%" PRIu64, kv->key.via.u64);
-               } else {
-                  key_label = wmem_strdup_printf(pinfo->pool, "Key %u", i);
+               if (visible) {
+                  if (key_obj->type == RBUS_MP_STR) {
+                     key_label = rbus_mp_get_string(tvb, pinfo, key_obj);
+                  } else if (key_obj->type == RBUS_MP_UINT) {
+                     key_label = wmem_strdup_printf(pinfo->pool, "%" PRIu64, key_obj->via.u64);
+                  } else {
+                     key_label = wmem_strdup_printf(pinfo->pool, "Key %u", i);
+                  }
                }
 
                /* Display key and value */
-               display_msgpack_object(map_tree, tvb, pinfo, offset, 1,
-                  &kv->key, depth + 1, "Key", ctx);
-               display_msgpack_object(map_tree, tvb, pinfo, offset, 1,
-                  &kv->val, depth + 1, key_label, ctx);
+               display_msgpack_object(map_tree, tvb, pinfo, ir, key, depth + 1, "Key", ctx);
+               display_msgpack_object(map_tree, tvb, pinfo, ir, val, depth + 1, key_label, ctx);
+               key = rbus_cursor_node(ir, val)->next;
             }
          }
          break;
@@ -670,46 +1088,12 @@ display_msgpack_object(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo,
    }
 }
 
-static guint
-dissect_msgpack_value(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree,
-   guint offset, guint max_len, guint depth, const char* label,
-   rbus_parse_context_t* ctx) {
-   if (depth > pref_msgpack_depth_limit) {
-      proto_tree_add_expert_format(tree, pinfo, &ei_rbus_msgpack_depth_exceeded, tvb, offset, max_len,
-         "MessagePack depth limit (%u) exceeded; further nesting not displayed", pref_msgpack_depth_limit);
-      return 0; /* Prevent infinite recursion */
-   }
-
-   if (max_len < 1) {
-      return 0;
-   }
-
-   const guint8* data = tvb_get_ptr(tvb, offset, max_len);
-
-   msgpack_unpacked msg;
-   msgpack_unpacked_init(&msg);
-
-   size_t off = 0;
-   msgpack_unpack_return ret = msgpack_unpack_next(&msg, (const char*)data, max_len, &off);
-
-   if (ret != MSGPACK_UNPACK_SUCCESS) {
-      msgpack_unpacked_destroy(&msg);
-      return 0;
-   }
-
-   /* Use the helper to display the parsed object */
-   display_msgpack_object(tree, tvb, pinfo, offset, (guint)off, &msg.data, depth, label, ctx);
-
-   msgpack_unpacked_destroy(&msg);
-   return (guint)off;
-}
-
 /*
  * Check if a topic is a control message topic
  * Returns control message type or -1 if not a control topic
  */
 static gint
-get_control_message_type(const guint8* topic_str) {
+get_control_message_type(const gchar* topic_str) {
    if (!topic_str) return -1;
    
    const char* topic = (const char*)topic_str;
@@ -741,1178 +1125,2817 @@ get_control_message_type(const guint8* topic_str) {
 }
 
 /*
- * Parse control message JSON payload
- * Control messages use JSON encoding (not MessagePack)
+ * Router control JSON. Payloads are flat objects, so a single pass over the
+ * bytes finds each top-level key and dispatches on its name; nested values
+ * and unknown keys are skipped without being looked into. Fields cover the
+ * exact bytes of their value.
  */
+typedef enum {
+   RBUS_JSON_INT,
+   RBUS_JSON_UINT,
+   RBUS_JSON_STRING,
+   RBUS_JSON_STRING_ARRAY
+} rbus_json_kind_t;
+
+typedef struct {
+   const char* key;
+   int* hf;
+   rbus_json_kind_t kind;
+} rbus_control_key_t;
+
+static const rbus_control_key_t rbus_control_keys[] = {
+   { "add", &hf_rbus_control_add, RBUS_JSON_INT },
+   { "topic", &hf_rbus_control_topic, RBUS_JSON_STRING },
+   { "route_id", &hf_rbus_control_route_id, RBUS_JSON_INT },
+   { "expression", &hf_rbus_control_expression, RBUS_JSON_STRING },
+   { "result", &hf_rbus_control_result, RBUS_JSON_INT },
+   { "count", &hf_rbus_control_count, RBUS_JSON_UINT },
+   { "items", &hf_rbus_control_item, RBUS_JSON_STRING_ARRAY },
+   { "event", &hf_rbus_advisory_event, RBUS_JSON_INT },
+   { "inbox", &hf_rbus_advisory_inbox, RBUS_JSON_STRING },
+   { "_RTROUTED.INBOX.DIAG.KEY", &hf_rbus_diag_command, RBUS_JSON_STRING },
+};
+
 static guint
-parse_control_message(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree,
-   guint offset, guint payload_length, gint control_type) {
-   
-   /* Get JSON data */
-   const guint8* json_data = tvb_get_ptr(tvb, offset, payload_length);
-   gchar* json_str = (gchar*)wmem_alloc(pinfo->pool, payload_length + 1);
-   memcpy(json_str, json_data, payload_length);
-   json_str[payload_length] = '\0';
-   
-   /* Create control message subtree */
-   proto_item* ctrl_item = proto_tree_add_item(tree, hf_rbus_control_message_type, tvb, offset, 1, ENC_NA);
-   proto_item_set_text(ctrl_item, "Control Message: %s", 
-      val_to_str(pinfo->pool, control_type, rbus_control_msg_type_vals, "Unknown (%d)"));
-   proto_tree* ctrl_tree = proto_item_add_subtree(ctrl_item, ett_rbus_control);
-   
-   /* Parse common JSON fields - simple string search for key-value pairs */
-   /* This is a lightweight JSON parser for the expected control message format */
-   
-   /* Look for "add" field (subscribe/unsubscribe) */
-   const char* add_pos = strstr(json_str, "\"add\"");
-   if (add_pos) {
-      const char* colon = strchr(add_pos, ':');
-      if (colon) {
-         gint add_val = atoi(colon + 1);
-         proto_tree_add_int(ctrl_tree, hf_rbus_control_add, tvb, offset, payload_length, add_val);
-      }
+rbus_json_skip_ws(const guint8* data, guint pos, guint end) {
+   while (pos < end && (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\n' || data[pos] == '\r')) {
+      pos++;
    }
-   
-   /* Look for "topic" field */
-   const char* topic_pos = strstr(json_str, "\"topic\"");
-   if (topic_pos) {
-      const char* colon = strchr(topic_pos, ':');
-      if (colon) {
-         const char* quote_start = strchr(colon, '"');
-         if (quote_start) {
-            quote_start++;
-            const char* quote_end = strchr(quote_start, '"');
-            if (quote_end) {
-               gchar* topic_val = wmem_strndup(pinfo->pool, quote_start, quote_end - quote_start);
-               proto_tree_add_string(ctrl_tree, hf_rbus_control_topic, tvb, offset, payload_length, topic_val);
-            }
-         }
+   return pos;
+}
+
+/* pos is at an opening quote; return the position of the closing quote, or end */
+static guint
+rbus_json_string_end(const guint8* data, guint pos, guint end) {
+   for (pos++; pos < end && data[pos] != '"'; pos++) {
+      if (data[pos] == '\\') {
+         pos++;
       }
    }
-   
-   /* Look for "expression" field (discovery) */
-   const char* expr_pos = strstr(json_str, "\"expression\"");
-   if (expr_pos) {
-      const char* colon = strchr(expr_pos, ':');
-      if (colon) {
-         const char* quote_start = strchr(colon, '"');
-         if (quote_start) {
-            quote_start++;
-            const char* quote_end = strchr(quote_start, '"');
-            if (quote_end) {
-               gchar* expr_val = wmem_strndup(pinfo->pool, quote_start, quote_end - quote_start);
-               proto_tree_add_string(ctrl_tree, hf_rbus_control_expression, tvb, offset, payload_length, expr_val);
+   return MIN(pos, end);
+}
+
+/* Return the position just past the value starting at pos */
+static guint
+rbus_json_skip_value(const guint8* data, guint pos, guint end) {
+   guint depth = 0;
+
+   for (; pos < end; pos++) {
+      switch (data[pos]) {
+         case '"':
+            pos = rbus_json_string_end(data, pos, end);
+            if (depth == 0) {
+               return MIN(pos + 1, end);
             }
-         }
+            break;
+         case '{':
+         case '[':
+            depth++;
+            break;
+         case '}':
+         case ']':
+            if (depth == 0) {
+               return pos;   /* End of the enclosing container */
+            }
+            if (--depth == 0) {
+               return pos + 1;
+            }
+            break;
+         case ',':
+         case ' ':
+         case '\t':
+         case '\n':
+         case '\r':
+            if (depth == 0) {
+               return pos;
+            }
+            break;
+         default:
+            break;
       }
    }
-   
-   /* Look for "result" field */
-   const char* result_pos = strstr(json_str, "\"result\"");
-   if (result_pos) {
-      const char* colon = strchr(result_pos, ':');
-      if (colon) {
-         gint result_val = atoi(colon + 1);
-         proto_tree_add_int(ctrl_tree, hf_rbus_control_result, tvb, offset, payload_length, result_val);
-      }
+   return end;
+}
+
+/* Parse an integer at pos; returns the position past it, or pos if there is none */
+static guint
+rbus_json_parse_int(const guint8* data, guint pos, guint end, gint64* value) {
+   gboolean negative = FALSE;
+   guint start = pos;
+   gint64 v = 0;
+
+   if (pos < end && data[pos] == '-') {
+      negative = TRUE;
+      pos++;
    }
-   
-   /* Look for "count" field */
-   const char* count_pos = strstr(json_str, "\"count\"");
-   if (count_pos) {
-      const char* colon = strchr(count_pos, ':');
-      if (colon) {
-         guint32 count_val = (guint32)atoi(colon + 1);
-         proto_tree_add_uint(ctrl_tree, hf_rbus_control_count, tvb, offset, payload_length, count_val);
-      }
+   if (pos >= end || !g_ascii_isdigit(data[pos])) {
+      return start;
    }
-   
-   /* Look for "event" field (advisory) */
-   const char* event_pos = strstr(json_str, "\"event\"");
-   if (event_pos) {
-      const char* colon = strchr(event_pos, ':');
-      if (colon) {
-         gint event_val = atoi(colon + 1);
-         proto_tree_add_int(ctrl_tree, hf_rbus_advisory_event, tvb, offset, payload_length, event_val);
+   while (pos < end && g_ascii_isdigit(data[pos])) {
+      if (v < G_MAXINT64 / 10) {
+         v = v * 10 + (data[pos] - '0');
       }
+      pos++;
    }
-   
-   /* Look for "inbox" field (advisory) */
-   const char* inbox_pos = strstr(json_str, "\"inbox\"");
-   if (inbox_pos) {
-      const char* colon = strchr(inbox_pos, ':');
-      if (colon) {
-         const char* quote_start = strchr(colon, '"');
-         if (quote_start) {
-            quote_start++;
-            const char* quote_end = strchr(quote_start, '"');
-            if (quote_end) {
-               gchar* inbox_val = wmem_strndup(pinfo->pool, quote_start, quote_end - quote_start);
-               proto_tree_add_string(ctrl_tree, hf_rbus_advisory_inbox, tvb, offset, payload_length, inbox_val);
-            }
-         }
+   *value = negative ? -v : v;
+   return pos;
+}
+
+static const rbus_control_key_t*
+rbus_control_key_lookup(const guint8* key, guint key_len) {
+   for (guint i = 0; i < array_length(rbus_control_keys); i++) {
+      const char* name = rbus_control_keys[i].key;
+      if (strlen(name) == key_len && memcmp(name, key, key_len) == 0) {
+         return &rbus_control_keys[i];
       }
    }
-   
-   /* Look for diagnostic command key */
-   const char* diag_pos = strstr(json_str, "_RTROUTED.INBOX.DIAG.KEY");
-   if (diag_pos) {
-      const char* colon = strchr(diag_pos, ':');
-      if (colon) {
-         const char* quote_start = strchr(colon, '"');
-         if (quote_start) {
-            quote_start++;
-            const char* quote_end = strchr(quote_start, '"');
-            if (quote_end) {
-               gchar* diag_val = wmem_strndup(pinfo->pool, quote_start, quote_end - quote_start);
-               proto_tree_add_string(ctrl_tree, hf_rbus_diag_command, tvb, offset, payload_length, diag_val);
+   return NULL;
+}
+
+/*
+ * Add the value at pos for a known key; returns the position past the value
+ */
+static guint
+rbus_control_add_value(proto_tree* tree, tvbuff_t* tvb, guint offset, const guint8* data, guint pos, guint end,
+   const rbus_control_key_t* key) {
+   gint64 value;
+   guint value_end;
+
+   switch (key->kind) {
+      case RBUS_JSON_INT:
+      case RBUS_JSON_UINT:
+         value_end = rbus_json_parse_int(data, pos, end, &value);
+         if (value_end == pos) {
+            break;
+         }
+         if (key->kind == RBUS_JSON_INT) {
+            proto_tree_add_int(tree, *key->hf, tvb, offset + pos, value_end - pos, (gint32)value);
+         } else {
+            proto_tree_add_uint(tree, *key->hf, tvb, offset + pos, value_end - pos, (guint32)value);
+         }
+         return value_end;
+
+      case RBUS_JSON_STRING:
+         if (data[pos] != '"') {
+            break;
+         }
+         value_end = rbus_json_string_end(data, pos, end);
+         proto_tree_add_item(tree, *key->hf, tvb, offset + pos + 1, value_end - pos - 1, ENC_UTF_8 | ENC_NA);
+         return MIN(value_end + 1, end);
+
+      case RBUS_JSON_STRING_ARRAY:
+         if (data[pos] != '[') {
+            break;
+         }
+         /* One item per string element, e.g. every route of a multi-route QUERY result */
+         for (pos++; pos < end; ) {
+            pos = rbus_json_skip_ws(data, pos, end);
+            if (pos >= end || data[pos] == ']') {
+               return MIN(pos + 1, end);
+            }
+            if (data[pos] == ',') {
+               pos++;
+            } else if (data[pos] == '"') {
+               value_end = rbus_json_string_end(data, pos, end);
+               proto_tree_add_item(tree, *key->hf, tvb, offset + pos + 1, value_end - pos - 1, ENC_UTF_8 | ENC_NA);
+               pos = MIN(value_end + 1, end);
+            } else {
+               value_end = rbus_json_skip_value(data, pos, end);
+               pos = value_end > pos ? value_end : pos + 1;
             }
          }
-      }
+         return end;
    }
-   
-   /* Display raw JSON */
-   proto_tree_add_bytes_format_value(ctrl_tree, hf_rbus_payload, tvb, offset,
-      payload_length, NULL, "%s", json_str);
-   
-   return payload_length;
+
+   return rbus_json_skip_value(data, pos, end);
 }
 
 /*
- * Parse structured RBus message payload with dedicated fields
- * Returns the number of bytes consumed
+ * Parse control message JSON payload
+ * Control messages use JSON encoding (not MessagePack)
  */
 static guint
-parse_rbus_payload(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree,
-   guint offset, guint payload_length) {
+parse_control_message(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree,
+   guint offset, guint payload_length, gint control_type) {
    const guint8* data = tvb_get_ptr(tvb, offset, payload_length);
-   msgpack_unpacked msg;
-   msgpack_unpacked_init(&msg);
-
-   /* Parse all objects in the payload into an array */
-#define MAX_OBJECTS 20000
-   msgpack_object objects[MAX_OBJECTS];
-   guint32 object_count = 0;
-   size_t parse_offset = 0;
-
-   while (parse_offset < payload_length && object_count < MAX_OBJECTS) {
-      msgpack_unpack_return ret = msgpack_unpack_next(&msg, (const char*)data, payload_length, &parse_offset);
-      if (ret != MSGPACK_UNPACK_SUCCESS) {
-         break;
-      }
-      /* Copy the object (msgpack_unpacked will be reused) */
-      objects[object_count] = msg.data;
-      object_count++;
-   }
+   guint end = payload_length;
+   guint pos;
 
-   if (object_count < 4) {
-      msgpack_unpacked_destroy(&msg);
-      return 0; /* Need at least method + metadata */
-   }
+   /* Create control message subtree */
+   proto_item* ctrl_item = proto_tree_add_uint(tree, hf_rbus_control_message_type, tvb, offset, payload_length,
+      (guint32)control_type);
+   proto_item_set_text(ctrl_item, "Control Message: %s",
+      val_to_str(pinfo->pool, control_type, rbus_control_msg_type_vals, "Unknown (%d)"));
+   proto_tree* ctrl_tree = proto_item_add_subtree(ctrl_item, ett_rbus_control);
 
-   msgpack_object* array_ptr = objects;
-   guint32 array_size = object_count;
+   pos = rbus_json_skip_ws(data, 0, end);
+   if (pos < end && data[pos] == '{') {
+      pos++;
+      while (pos < end) {
+         guint key_start;
+         guint key_end;
+         const rbus_control_key_t* key;
 
-   /* Look for method name to determine message type */
-   const gchar* method = NULL;
-   gint method_idx = -1;
-   for (guint32 i = 0; i < array_size; i++) {
-      if (array_ptr[i].type == MSGPACK_OBJECT_STR) {
-         gchar* str = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[i].via.str.size,
-            array_ptr[i].via.str.ptr);
-         if (strncmp(str, "METHOD_", 7) == 0) {
-            method = str;
-            method_idx = i;
+         pos = rbus_json_skip_ws(data, pos, end);
+         if (pos >= end || data[pos] == '}') {
             break;
          }
-      }
-   }
-
-   /* If no METHOD_ found, check if this is an event publication */
-   if (!method || method_idx < 0) {
-      /* Event Publication Format: [eventName, eventType, hasEventData, [eventData...], hasFilter, [filter...], interval, duration, componentId, ...] */
-      if (object_count >= 6) {
-         guint idx = 0;
-
-         /* Event Name */
-         if (array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-            gchar* event_name = wmem_strdup_printf(pinfo->pool, "%.*s",
-               (int)array_ptr[idx].via.str.size,
-               array_ptr[idx].via.str.ptr);
-            proto_tree_add_string(tree, hf_rbus_event_name, tvb, offset, 1, event_name);
-            col_append_fstr(pinfo->cinfo, COL_INFO, " Event: %s", event_name);
-            idx++;
-         } else {
-            msgpack_unpacked_destroy(&msg);
-            return 0;
+         if (data[pos] == ',') {
+            pos++;
+            continue;
          }
-
-         /* Event Type */
-         if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            guint32 event_type = (guint32)array_ptr[idx].via.u64;
-            proto_tree_add_uint(tree, hf_rbus_event_type, tvb, offset, 1, event_type);
-            idx++;
+         if (data[pos] != '"') {
+            break;   /* Not an object member; leave the rest to the raw display */
          }
 
-         /* Has Event Data */
-         gboolean has_event_data = FALSE;
-         if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            has_event_data = (array_ptr[idx].via.u64 != 0);
-            proto_tree_add_boolean(tree, hf_rbus_has_event_data, tvb, offset, 1, has_event_data);
-            idx++;
+         key_start = pos + 1;
+         key_end = rbus_json_string_end(data, pos, end);
+         pos = rbus_json_skip_ws(data, MIN(key_end + 1, end), end);
+         if (pos >= end || data[pos] != ':') {
+            break;
+         }
+         pos = rbus_json_skip_ws(data, pos + 1, end);
+         if (pos >= end) {
+            break;
          }
 
-         /* Parse Event Data (rbusObject with properties) */
-         /* rbusObject in event publications is just a placeholder string, followed by property data */
-         if (has_event_data && idx < object_count) {
-            /* Skip the placeholder rbusObject (usually a 1-byte string) */
-            idx++;
+         key = rbus_control_key_lookup(data + key_start, key_end - key_start);
+         if (key) {
+            pos = rbus_control_add_value(ctrl_tree, tvb, offset, data, pos, end, key);
+         } else {
+            guint value_end = rbus_json_skip_value(data, pos, end);
+            pos = value_end > pos ? value_end : pos + 1;
          }
+      }
+   }
 
-         /* Has Filter */
-         if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            gboolean has_filter = (array_ptr[idx].via.u64 != 0);
-            proto_tree_add_boolean(tree, hf_rbus_has_filter, tvb, offset, 1, has_filter);
-            idx++;
+   /* Display raw JSON */
+   proto_tree_add_bytes_format_value(ctrl_tree, hf_rbus_payload, tvb, offset,
+      payload_length, NULL, "%.*s", (int)payload_length, (const char*)data);
 
-            /* Skip filter data if present (not parsing filter details yet) */
-            if (has_filter && idx < object_count) {
-               idx++; /* Skip filter object */
-            }
-         }
+   return payload_length;
+}
 
-         /* Now parse the property data: [prop_count, name, type, value, ...] */
-         if (has_event_data && idx < object_count) {
-            guint32 prop_count = 0;
-            if (array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-               prop_count = (guint32)array_ptr[idx].via.u64;
-               idx++;
-            }
+/*
+ * Capture-wide string interning. Topics and data-model names come from a small
+ * vocabulary, so each distinct byte string is copied into file scope once and
+ * given a stable id (0 means none). Lookups hash the bytes in place in the tvb,
+ * so a known name costs no allocation.
+ */
+#define RBUS_INTERN_MAX_ENTRIES 65536   /* Beyond this, new strings are copied per packet */
 
-            proto_item* data_item = proto_tree_add_item(tree, hf_rbus_event_data, tvb, offset, 1, ENC_NA);
-            proto_tree* data_tree = proto_item_add_subtree(data_item, ett_rbus_property);
-            proto_item_append_text(data_item, " (%u properties)", prop_count);
+typedef struct {
+   const guint8* data;
+   guint32 length;
+   guint32 hash;
+} rbus_intern_key_t;
 
-            /* Parse properties as triplets: name, type, value */
-            for (guint32 p = 0; p < prop_count && idx + 2 < object_count; p++) {
-               gchar* name = NULL;
-               guint32 type_id = 0;
+typedef struct {
+   rbus_intern_key_t key;
+   const gchar* str;            /* UTF-8 validated copy */
+   guint32 id;
+} rbus_intern_entry_t;
 
-               /* Property Name */
-               if (array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-                  name = wmem_strdup_printf(pinfo->pool, "%.*s",
-                     (int)array_ptr[idx].via.str.size,
-                     array_ptr[idx].via.str.ptr);
-               }
-               idx++;
+static wmem_map_t* rbus_intern_map = NULL;        /* rbus_intern_key_t -> rbus_intern_entry_t */
+static wmem_array_t* rbus_intern_strings = NULL;  /* id - 1 -> const gchar* */
 
-               /* Property Type */
-               if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-                  type_id = (guint32)array_ptr[idx].via.u64;
-               }
-               idx++;
+static guint
+rbus_intern_hash(gconstpointer k) {
+   return ((const rbus_intern_key_t*)k)->hash;
+}
 
-               /* Property Value */
-               if (idx < object_count && name) {
-                  proto_item* prop_item = proto_tree_add_item(data_tree, hf_rbus_object_property, tvb, offset, 1, ENC_NA);
-                  proto_tree* prop_tree = proto_item_add_subtree(prop_item, ett_rbus_property);
-                  proto_item_append_text(prop_item, ": %s", name);
+static gboolean
+rbus_intern_equal(gconstpointer a, gconstpointer b) {
+   const rbus_intern_key_t* ka = (const rbus_intern_key_t*)a;
+   const rbus_intern_key_t* kb = (const rbus_intern_key_t*)b;
+   return ka->length == kb->length && memcmp(ka->data, kb->data, ka->length) == 0;
+}
 
-                  proto_tree_add_string(prop_tree, hf_rbus_object_property_name, tvb, offset, 1, name);
-                  proto_tree_add_uint(prop_tree, hf_rbus_property_type, tvb, offset, 1, type_id);
+static void
+rbus_intern_init(void) {
+   rbus_intern_map = wmem_map_new(wmem_file_scope(), rbus_intern_hash, rbus_intern_equal);
+   rbus_intern_strings = wmem_array_new(wmem_file_scope(), sizeof(const gchar*));
+}
 
-                  gchar* value_str = add_typed_value(prop_tree, tvb, pinfo, offset, &array_ptr[idx], TRUE);
+/*
+ * Return the interned string for length bytes at offset, storing its id in
+ * *id if not NULL. When the table is full the string is returned in
+ * pinfo->pool with id 0.
+ */
+static const gchar*
+rbus_intern_tvb(tvbuff_t* tvb, packet_info* pinfo, guint offset, guint length, guint32* id) {
+   rbus_intern_key_t key;
+   rbus_intern_entry_t* entry;
+   guint32 hash = 2166136261u;   /* FNV-1a */
+   guint i;
+
+   key.data = tvb_get_ptr(tvb, offset, length);
+   key.length = length;
+   for (i = 0; i < length; i++) {
+      hash = (hash ^ key.data[i]) * 16777619u;
+   }
+   key.hash = hash;
 
-                  if (value_str) {
-                     gchar* namevalue = wmem_strdup_printf(pinfo->pool, "%s=%s", name, value_str);
-                     proto_tree_add_string(prop_tree, hf_rbus_object_property_namevalue, tvb, offset, 1, namevalue);
-                  }
-               }
-               idx++;
-            }
+   entry = (rbus_intern_entry_t*)wmem_map_lookup(rbus_intern_map, &key);
+   if (!entry) {
+      if (wmem_map_size(rbus_intern_map) >= RBUS_INTERN_MAX_ENTRIES) {
+         if (id) {
+            *id = 0;
          }
+         return (const gchar*)tvb_get_string_enc(pinfo->pool, tvb, offset, length, ENC_UTF_8 | ENC_NA);
+      }
 
-         /* Interval */
-         if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            proto_tree_add_uint(tree, hf_rbus_interval, tvb, offset, 1, (guint32)array_ptr[idx].via.u64);
-            idx++;
-         }
+      entry = wmem_new(wmem_file_scope(), rbus_intern_entry_t);
+      entry->key.data = (const guint8*)wmem_memdup(wmem_file_scope(), key.data, length);
+      entry->key.length = length;
+      entry->key.hash = hash;
+      entry->str = (const gchar*)tvb_get_string_enc(wmem_file_scope(), tvb, offset, length, ENC_UTF_8 | ENC_NA);
+      wmem_array_append_one(rbus_intern_strings, entry->str);
+      entry->id = wmem_array_get_count(rbus_intern_strings);
+      wmem_map_insert(rbus_intern_map, &entry->key, entry);
+   }
 
-         /* Duration */
-         if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            proto_tree_add_uint(tree, hf_rbus_duration, tvb, offset, 1, (guint32)array_ptr[idx].via.u64);
-            idx++;
-         }
+   if (id) {
+      *id = entry->id;
+   }
+   return entry->str;
+}
 
-         /* Component ID */
-         if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            proto_tree_add_int(tree, hf_rbus_component_id, tvb, offset, 1, (gint32)array_ptr[idx].via.u64);
-            idx++;
-         }
+/*
+ * Return the string for an interned id, NULL for id 0
+ */
+static const gchar*
+rbus_intern_string(guint32 id) {
+   if (id == 0) {
+      return NULL;
+   }
+   return *(const gchar**)wmem_array_index(rbus_intern_strings, id - 1);
+}
 
-         /* Event Metadata: [eventName, objectName, isRbus2, offset]
-          * This is DIFFERENT from the standard [method, ot_parent, ot_state, offset] */
-         if (idx + 3 < object_count) {
-            proto_item* meta_item = proto_tree_add_item(tree, hf_rbus_metadata, tvb, offset, 1, ENC_NA);
-            proto_tree* meta_tree = proto_item_add_subtree(meta_item, ett_rbus_event_metadata);
-            proto_item_set_text(meta_item, "Event Metadata");
-            
-            /* eventName (repeated) */
-            if (array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-               gchar* meta_event = wmem_strdup_printf(pinfo->pool, "%.*s",
-                  (int)array_ptr[idx].via.str.size,
-                  array_ptr[idx].via.str.ptr);
-               proto_tree_add_string(meta_tree, hf_rbus_event_name, tvb, offset, 1, meta_event);
-               idx++;
-            }
-            
-            /* objectName (publishing component) */
-            if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-               gchar* object_name = wmem_strdup_printf(pinfo->pool, "%.*s",
-                  (int)array_ptr[idx].via.str.size,
-                  array_ptr[idx].via.str.ptr);
-               proto_tree_add_string(meta_tree, hf_rbus_event_object_name, tvb, offset, 1, object_name);
-               idx++;
-            }
-            
-            /* isRbus2 flag */
-            if (idx < object_count && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-               proto_tree_add_uint(meta_tree, hf_rbus_event_is_rbus2, tvb, offset, 1, 
-                  (guint32)array_ptr[idx].via.u64);
-               idx++;
-            }
-            
-            /* offset (fixed 32-bit) */
-            if (idx < object_count) {
-               gint32 offset_val = 0;
-               if (array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-                  offset_val = (gint32)array_ptr[idx].via.u64;
-               } else if (array_ptr[idx].type == MSGPACK_OBJECT_NEGATIVE_INTEGER) {
-                  offset_val = (gint32)array_ptr[idx].via.i64;
-               }
-               proto_tree_add_int(meta_tree, hf_rbus_metadata_offset, tvb, offset, 1, offset_val);
-            }
+/*
+ * Helpers to add a decoded object as a typed field covering its exact bytes
+ */
+static gchar*
+add_mp_string(proto_tree* tree, int hf, tvbuff_t* tvb, packet_info* pinfo, const rbus_mp_object_t* obj) {
+   gchar* str = rbus_mp_get_string(tvb, pinfo, obj);
+   proto_tree_add_string(tree, hf, tvb, obj->offset, obj->length, str);
+   return str;
+}
+
+/* Names (components, parameters, events) are interned rather than copied */
+static const gchar*
+add_mp_name(proto_tree* tree, int hf, tvbuff_t* tvb, packet_info* pinfo, const rbus_mp_object_t* obj) {
+   const gchar* str = rbus_intern_tvb(tvb, pinfo, obj->data_offset, obj->via.size, NULL);
+   proto_tree_add_string(tree, hf, tvb, obj->offset, obj->length, str);
+   return str;
+}
+
+static guint32
+add_mp_uint(proto_tree* tree, int hf, tvbuff_t* tvb, const rbus_mp_object_t* obj) {
+   guint32 value = (guint32)obj->via.u64;
+   proto_tree_add_uint(tree, hf, tvb, obj->offset, obj->length, value);
+   return value;
+}
+
+/* Accepts either integer class; anything else adds 0 */
+static gint32
+add_mp_int(proto_tree* tree, int hf, tvbuff_t* tvb, const rbus_mp_object_t* obj) {
+   gint32 value = 0;
+   if (obj->type == RBUS_MP_UINT) {
+      value = (gint32)obj->via.u64;
+   } else if (obj->type == RBUS_MP_INT) {
+      value = (gint32)obj->via.i64;
+   }
+   proto_tree_add_int(tree, hf, tvb, obj->offset, obj->length, value);
+   return value;
+}
+
+/*
+ * Read the complete object at offset, for fields located by their offset only
+ */
+static gboolean
+rbus_mp_read_at(tvbuff_t* tvb, guint offset, guint end, rbus_mp_object_t* obj) {
+   return rbus_mp_read_object(tvb_get_ptr(tvb, 0, end), offset, end, G_MAXUINT32, obj) == RBUS_WIRE_OK;
+}
+
+/*
+ * Add a name/type/value triplet (SET parameter, response property or event data property)
+ */
+static void
+add_name_type_value(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo, const rbus_mp_object_t* name_obj,
+   const rbus_mp_object_t* type_obj, const rbus_mp_object_t* value_obj,
+   int hf_item, int hf_name, int hf_type, int hf_namevalue, gboolean is_property) {
+   proto_item* item = proto_tree_add_item(tree, hf_item, tvb, name_obj->offset,
+      value_obj->offset + value_obj->length - name_obj->offset, ENC_NA);
+   proto_tree* item_tree = proto_item_add_subtree(item, is_property ? ett_rbus_property : ett_rbus_parameter);
+
+   /* Name */
+   const gchar* name = NULL;
+   if (name_obj->type == RBUS_MP_STR) {
+      name = add_mp_name(item_tree, hf_name, tvb, pinfo, name_obj);
+      proto_item_append_text(item, ": %s", name);
+   }
+
+   /* Type */
+   if (type_obj->type == RBUS_MP_UINT) {
+      add_mp_uint(item_tree, hf_type, tvb, type_obj);
+   }
+
+   /* Value */
+   gchar* value_str = add_typed_value(item_tree, tvb, pinfo, value_obj, is_property);
+
+   /* Add synthetic namevalue field for filtering */
+   if (name && value_str) {
+      gchar* namevalue = wmem_strdup_printf(pinfo->pool, "%s=%s", name, value_str);
+      proto_tree_add_string(item_tree, hf_namevalue, tvb, name_obj->offset,
+         value_obj->offset + value_obj->length - name_obj->offset, namevalue);
+   }
+}
+
+/*
+ * What later passes need of a MessagePack payload. It is kept in file scope
+ * per PDU and sized to its content; the decoded payload it was built from is
+ * not. Method payloads are rendered from the summary alone, an event
+ * publication or unrecognized payload is decoded again when a tree is built.
+ */
+typedef enum {
+   RBUS_PAYLOAD_OTHER,          /* Shown as generic MessagePack */
+   RBUS_PAYLOAD_METHOD,         /* Request or response with a METHOD_* marker */
+   RBUS_PAYLOAD_EVENT           /* Event publication */
+} rbus_payload_kind_t;
+
+typedef struct {
+   guint32 offset;              /* Start of the field's object */
+   guint32 name_id;             /* Interned string of a STR field, else 0 */
+   guint8 id;                   /* rbus_wire_field_id_t */
+} rbus_payload_field_t;
+
+typedef struct {
+   guint start;                 /* Payload bounds and the limits it was decoded with */
+   guint end;
+   guint32 limit;
+   guint32 max_depth;
+   rbus_payload_kind_t kind;
+   rbus_method_t method;
+   gint32 method_index;         /* Top-level index of the METHOD_* marker, -1 if none */
+   guint32 meta[4];             /* Offsets of the marker, ot_parent, ot_state and offset */
+   guint32 meta_count;          /* How many of those are present */
+   guint32 event_name_id;       /* Interned name of an event publication, else 0 */
+   gint32 error_code;           /* RESPONSE, 0 if none */
+   gboolean set_request;        /* SET/COMMIT with a session ID; the next three are valid */
+   guint32 session_id;
+   guint32 param_count;
+   gboolean commit;
+   guint32 field_count;
+   rbus_payload_field_t fields[];
+} rbus_payload_summary_t;
+
+/* Start decoding a payload into pinfo->pool with the current limit preferences */
+static rbus_msgpack_cursor_t*
+rbus_new_payload_cursor(tvbuff_t* tvb, packet_info* pinfo, guint offset, guint length) {
+   rbus_msgpack_cursor_t* cursor = wmem_new(pinfo->pool, rbus_msgpack_cursor_t);
+
+   rbus_cursor_init(cursor, pinfo->pool, tvb, offset, length, pref_msgpack_object_limit, pref_msgpack_depth_limit);
+   return cursor;
+}
+
+/*
+ * Summarize a decoded payload into scope. The method fields are located by
+ * the wire library; string fields are interned so later passes need not
+ * copy them out of the tvb.
+ */
+static rbus_payload_summary_t*
+rbus_summarize_payload(wmem_allocator_t* scope, tvbuff_t* tvb, packet_info* pinfo, rbus_msgpack_cursor_t* cursor) {
+   rbus_payload_kind_t kind = RBUS_PAYLOAD_OTHER;
+   rbus_wire_method_fields_t method_fields;
+   rbus_payload_summary_t* summary;
+   guint32 event_name_id = 0;
+   gint method_idx = -1;
+
+   memset(&method_fields, 0, sizeof(method_fields));
+
+   /* Need at least method + metadata */
+   if (rbus_cursor_has(cursor, 3)) {
+      method_idx = rbus_cursor_method_index(tvb, cursor);
+      if (method_idx >= 0) {
+         rbus_mp_object_t* objects = wmem_alloc_array(pinfo->pool, rbus_mp_object_t, method_idx + 1);
+         rbus_wire_field_t* fields = wmem_alloc_array(pinfo->pool, rbus_wire_field_t, method_idx + 1);
+
+         /* A field is one object before the marker, so method_idx slots always suffice */
+         for (gint i = 0; i < method_idx; i++) {
+            objects[i] = *rbus_cursor_at(cursor, i);
          }
+         rbus_wire_method_fields(cursor->data, objects, method_idx, cursor->method, fields, &method_fields);
+         kind = RBUS_PAYLOAD_METHOD;
+      } else if (rbus_cursor_has(cursor, 5) && rbus_cursor_at(cursor, 0)->type == RBUS_MP_STR) {
+         /* Event Publication Format: [eventName, eventType, hasEventData, ...] */
+         const rbus_mp_object_t* obj = rbus_cursor_at(cursor, 0);
+         rbus_intern_tvb(tvb, pinfo, obj->data_offset, obj->via.size, &event_name_id);
+         kind = RBUS_PAYLOAD_EVENT;
+      }
+   }
 
-         msgpack_unpacked_destroy(&msg);
-         return payload_length;
+   summary = (rbus_payload_summary_t*)wmem_alloc0(scope,
+      offsetof(rbus_payload_summary_t, fields) + method_fields.field_count * sizeof(rbus_payload_field_t));
+   summary->start = cursor->start;
+   summary->end = cursor->end;
+   summary->limit = cursor->limit;
+   summary->max_depth = cursor->max_depth;
+   summary->kind = kind;
+   summary->method = cursor->method;
+   summary->method_index = method_idx;
+   summary->event_name_id = event_name_id;
+
+   if (kind != RBUS_PAYLOAD_METHOD) {
+      return summary;
+   }
+
+   while (summary->meta_count < 4 && rbus_cursor_has(cursor, method_idx + summary->meta_count)) {
+      summary->meta[summary->meta_count] = rbus_cursor_at(cursor, method_idx + summary->meta_count)->offset;
+      summary->meta_count++;
+   }
+   summary->error_code = method_fields.error_code;
+   summary->set_request = method_fields.set_request;
+   summary->session_id = method_fields.session_id;
+   summary->param_count = method_fields.param_count;
+   summary->commit = method_fields.commit;
+
+   summary->field_count = method_fields.field_count;
+   for (guint32 i = 0; i < method_fields.field_count; i++) {
+      rbus_payload_field_t* field = &summary->fields[i];
+      rbus_mp_object_t obj;
+
+      field->id = (guint8)method_fields.fields[i].id;
+      field->offset = method_fields.fields[i].offset;
+      if (rbus_mp_read_head(cursor->data, field->offset, cursor->end, &obj) && obj.type == RBUS_MP_STR) {
+         rbus_intern_tvb(tvb, pinfo, obj.data_offset, obj.via.size, &field->name_id);
       }
+   }
+   return summary;
+}
 
-      msgpack_unpacked_destroy(&msg);
-      return 0; /* No method found and not an event */
+/*
+ * Return the summary of a PDU's payload, summarizing it on first use. When
+ * that happens the decoded payload is handed back in cursor for the rest of
+ * this pass; otherwise cursor is NULL.
+ */
+static const rbus_payload_summary_t*
+rbus_get_payload_summary(tvbuff_t* tvb, packet_info* pinfo, guint32 pdu_index, guint offset, guint length,
+   rbus_msgpack_cursor_t** cursor) {
+   guint32 key = RBUS_PDU_KEY(pdu_index, RBUS_PDU_DATA_PAYLOAD);
+   rbus_payload_summary_t* summary = (rbus_payload_summary_t*)p_get_proto_data(wmem_file_scope(), pinfo, proto_rbus, key);
+
+   *cursor = NULL;
+
+   /* Summarize again if the PDU moved or a limit preference changed */
+   if (summary && (summary->start != offset || summary->end != offset + length ||
+      summary->limit != pref_msgpack_object_limit || summary->max_depth != pref_msgpack_depth_limit)) {
+      p_remove_proto_data(wmem_file_scope(), pinfo, proto_rbus, key);
+      wmem_free(wmem_file_scope(), summary);
+      summary = NULL;
    }
 
-   /* Create metadata subtree */
-   proto_item* meta_item = proto_tree_add_item(tree, hf_rbus_metadata, tvb, offset, 1, ENC_NA);
-   proto_tree* meta_tree = proto_item_add_subtree(meta_item, ett_rbus_metadata);
+   if (!summary) {
+      *cursor = rbus_new_payload_cursor(tvb, pinfo, offset, length);
+      summary = rbus_summarize_payload(wmem_file_scope(), tvb, pinfo, *cursor);
+      p_add_proto_data(wmem_file_scope(), pinfo, proto_rbus, key, summary);
+   }
+   return summary;
+}
 
-   /* Add method name */
-   proto_tree_add_string(meta_tree, hf_rbus_method_name, tvb, offset, 1, method);
+/*
+ * Method fields are identified by rbus_wire_method_fields(); this table says
+ * how each is shown.
+ */
+typedef enum {
+   RBUS_FIELD_SHOW_NAME,        /* Interned string */
+   RBUS_FIELD_SHOW_STRING,
+   RBUS_FIELD_SHOW_UINT,
+   RBUS_FIELD_SHOW_INT,         /* Either integer class; anything else shows 0 */
+   RBUS_FIELD_SHOW_COUNT,       /* Either integer class, shown unsigned */
+   RBUS_FIELD_SHOW_PARAMETER,   /* Name, type and value */
+   RBUS_FIELD_SHOW_PROPERTY
+} rbus_field_show_t;
 
-   /* Add OT fields if present */
-   if (method_idx + 1 < (gint)array_size && array_ptr[method_idx + 1].type == MSGPACK_OBJECT_STR) {
-      gchar* ot_parent = wmem_strdup_printf(pinfo->pool, "%.*s",
-         (int)array_ptr[method_idx + 1].via.str.size,
-         array_ptr[method_idx + 1].via.str.ptr);
-      proto_tree_add_string(meta_tree, hf_rbus_ot_parent, tvb, offset, 1, ot_parent);
-   }
-   if (method_idx + 2 < (gint)array_size && array_ptr[method_idx + 2].type == MSGPACK_OBJECT_STR) {
-      gchar* ot_state = wmem_strdup_printf(pinfo->pool, "%.*s",
-         (int)array_ptr[method_idx + 2].via.str.size,
-         array_ptr[method_idx + 2].via.str.ptr);
-      proto_tree_add_string(meta_tree, hf_rbus_ot_state, tvb, offset, 1, ot_state);
+typedef struct {
+   int* hf;
+   rbus_field_show_t show;
+} rbus_field_display_t;
+
+static const rbus_field_display_t rbus_field_display[RBUS_FIELD_COUNT] = {
+   [RBUS_FIELD_COMPONENT_NAME] = { &hf_rbus_component_name, RBUS_FIELD_SHOW_NAME },
+   [RBUS_FIELD_PARAM_COUNT] = { &hf_rbus_param_count, RBUS_FIELD_SHOW_UINT },
+   [RBUS_FIELD_PARAMETER_NAME] = { &hf_rbus_parameter_name, RBUS_FIELD_SHOW_NAME },
+   [RBUS_FIELD_EVENT_NAME] = { &hf_rbus_event_name, RBUS_FIELD_SHOW_NAME },
+   [RBUS_FIELD_REPLY_TOPIC] = { &hf_rbus_reply_topic_payload, RBUS_FIELD_SHOW_STRING },
+   [RBUS_FIELD_SESSION_ID] = { &hf_rbus_session_id, RBUS_FIELD_SHOW_UINT },
+   [RBUS_FIELD_INVOKE_METHOD_NAME] = { &hf_rbus_invoke_method_name, RBUS_FIELD_SHOW_NAME },
+   [RBUS_FIELD_HAS_PARAMS] = { &hf_rbus_has_params, RBUS_FIELD_SHOW_INT },
+   [RBUS_FIELD_DISCOVERY_DEPTH] = { &hf_rbus_discovery_depth, RBUS_FIELD_SHOW_INT },
+   [RBUS_FIELD_ROW_NAMES_ONLY] = { &hf_rbus_discovery_row_names_only, RBUS_FIELD_SHOW_UINT },
+   [RBUS_FIELD_TABLE_ALIAS] = { &hf_rbus_table_alias, RBUS_FIELD_SHOW_NAME },
+   [RBUS_FIELD_ROLLBACK] = { &hf_rbus_rollback, RBUS_FIELD_SHOW_UINT },
+   [RBUS_FIELD_PARAMETER] = { &hf_rbus_parameter, RBUS_FIELD_SHOW_PARAMETER },
+   [RBUS_FIELD_COMMIT] = { &hf_rbus_commit, RBUS_FIELD_SHOW_STRING },
+   [RBUS_FIELD_ERROR_CODE] = { &hf_rbus_error_code, RBUS_FIELD_SHOW_INT },
+   [RBUS_FIELD_FAILED_ELEMENT] = { &hf_rbus_failed_element, RBUS_FIELD_SHOW_STRING },
+   [RBUS_FIELD_PROPERTY_COUNT] = { &hf_rbus_property_count, RBUS_FIELD_SHOW_COUNT },
+   [RBUS_FIELD_PROPERTY] = { &hf_rbus_property, RBUS_FIELD_SHOW_PROPERTY },
+};
+
+/*
+ * Add one method field of a payload summary. Only its offset is kept; the
+ * object is read again from the payload ending at end.
+ */
+static void
+rbus_add_method_field(proto_tree* tree, tvbuff_t* tvb, packet_info* pinfo, guint end, const rbus_payload_field_t* field) {
+   const rbus_field_display_t* display = &rbus_field_display[field->id];
+   rbus_mp_object_t obj;
+   rbus_mp_object_t type_obj;
+   rbus_mp_object_t value_obj;
+
+   if (!rbus_mp_read_at(tvb, field->offset, end, &obj)) {
+      return;
    }
-   /* Add offset field if present */
-   if (method_idx + 3 < (gint)array_size) {
-      gint32 offset_val = 0;
-      if (array_ptr[method_idx + 3].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         offset_val = (gint32)array_ptr[method_idx + 3].via.u64;
-      } else if (array_ptr[method_idx + 3].type == MSGPACK_OBJECT_NEGATIVE_INTEGER) {
-         offset_val = (gint32)array_ptr[method_idx + 3].via.i64;
-      }
-      proto_tree_add_int(meta_tree, hf_rbus_metadata_offset, tvb, offset, 1, offset_val);
-   }
-
-   /* Parse based on method type */
-   if (strcmp(method, "METHOD_GETPARAMETERVALUES") == 0) {
-      /* GET Request: [componentName, paramCount, parameterName, ...] */
-      if (array_size >= 3) {
-         if (array_ptr[0].type == MSGPACK_OBJECT_STR) {
-            gchar* comp = wmem_strdup_printf(pinfo->pool, "%.*s",
-               (int)array_ptr[0].via.str.size,
-               array_ptr[0].via.str.ptr);
-            proto_tree_add_string(tree, hf_rbus_component_name, tvb, offset, 1, comp);
+
+   switch (display->show) {
+      case RBUS_FIELD_SHOW_NAME:
+      case RBUS_FIELD_SHOW_STRING:
+         if (field->name_id) {
+            proto_tree_add_string(tree, *display->hf, tvb, obj.offset, obj.length, rbus_intern_string(field->name_id));
+         } else {
+            add_mp_string(tree, *display->hf, tvb, pinfo, &obj);
          }
-         if (array_ptr[1].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            proto_tree_add_uint(tree, hf_rbus_param_count, tvb, offset, 1,
-               (guint32)array_ptr[1].via.u64);
+         break;
+      case RBUS_FIELD_SHOW_UINT:
+         add_mp_uint(tree, *display->hf, tvb, &obj);
+         break;
+      case RBUS_FIELD_SHOW_INT:
+         add_mp_int(tree, *display->hf, tvb, &obj);
+         break;
+      case RBUS_FIELD_SHOW_COUNT:
+         proto_tree_add_uint(tree, *display->hf, tvb, obj.offset, obj.length,
+            obj.type == RBUS_MP_UINT ? (guint32)obj.via.u64 : (guint32)obj.via.i64);
+         break;
+      case RBUS_FIELD_SHOW_PARAMETER:
+      case RBUS_FIELD_SHOW_PROPERTY:
+         if (!rbus_mp_read_at(tvb, obj.offset + obj.length, end, &type_obj) ||
+            !rbus_mp_read_at(tvb, type_obj.offset + type_obj.length, end, &value_obj)) {
+            break;
          }
-         /* Add parameter names */
-         for (guint32 i = 2; i < (guint32)method_idx; i++) {
-            if (array_ptr[i].type == MSGPACK_OBJECT_STR) {
-               gchar* param = wmem_strdup_printf(pinfo->pool, "%.*s",
-                  (int)array_ptr[i].via.str.size,
-                  array_ptr[i].via.str.ptr);
-               proto_tree_add_string(tree, hf_rbus_parameter_name, tvb, offset, 1, param);
-            }
+         if (display->show == RBUS_FIELD_SHOW_PARAMETER) {
+            add_name_type_value(tree, tvb, pinfo, &obj, &type_obj, &value_obj, hf_rbus_parameter,
+               hf_rbus_parameter_name, hf_rbus_parameter_type, hf_rbus_parameter_namevalue, FALSE);
+         } else {
+            add_name_type_value(tree, tvb, pinfo, &obj, &type_obj, &value_obj, hf_rbus_property,
+               hf_rbus_property_name, hf_rbus_property_type, hf_rbus_property_namevalue, TRUE);
          }
-      }
-   } else if (strcmp(method, "METHOD_SUBSCRIBE") == 0) {
-      /* SUBSCRIBE Request: [event_name, reply_topic, has_payload, payload, publishOnSubscribe, rawData, ...] */
-      guint idx = 0;
+         break;
+   }
+}
 
-      /* Event name */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* event = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_event_name, tvb, offset, 1, event);
-         idx++;
-      }
+/*
+ * Parse structured RBus message payload with dedicated fields. Method payloads
+ * are rendered from their summary; an event publication shown in a tree also
+ * needs its decoded payload in cursor.
+ * Returns the number of bytes consumed
+ */
+static guint
+parse_rbus_payload(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree,
+   const rbus_payload_summary_t* summary, rbus_msgpack_cursor_t* cursor, guint payload_length) {
+   const rbus_mp_object_t* obj;
 
-      /* Reply topic */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* reply = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_reply_topic_payload, tvb, offset, 1, reply);
-         idx++;
-      }
+   if (summary->kind == RBUS_PAYLOAD_OTHER) {
+      return 0; /* No method found and not an event */
+   }
 
-      /* Remaining fields: has_payload, payload (optional), publishOnSubscribe, rawData */
-      /* We can skip detailed parsing of these for now */
-   } else if (strcmp(method, "METHOD_UNSUBSCRIBE") == 0) {
-      /* UNSUBSCRIBE Request: Same structure as SUBSCRIBE */
+   /* Event Publication Format: [eventName, eventType, hasEventData, [eventData...], hasFilter, [filter...], interval, duration, componentId, ...] */
+   if (summary->kind == RBUS_PAYLOAD_EVENT) {
+      const gchar* event_name = rbus_intern_string(summary->event_name_id);
       guint idx = 0;
 
-      /* Event name */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* event = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_event_name, tvb, offset, 1, event);
-         idx++;
-      }
+      col_append_fstr(pinfo->cinfo, COL_INFO, " Event: %s", event_name);
 
-      /* Reply topic */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* reply = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_reply_topic_payload, tvb, offset, 1, reply);
-         idx++;
+      /* The event name is all the Info column needs */
+      if (!tree) {
+         return payload_length;
       }
-   } else if (strcmp(method, "METHOD_RPC") == 0) {
-      /* RPC/Invoke Request: [sessionId, methodName, hasParams, params (optional)] */
-      guint idx = 0;
 
-      /* Session ID */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         proto_tree_add_uint(tree, hf_rbus_session_id, tvb, offset, 1,
-            (guint32)array_ptr[idx].via.u64);
-         idx++;
-      }
+      /* Event Name */
+      obj = rbus_cursor_at(cursor, idx);
+      proto_tree_add_string(tree, hf_rbus_event_name, tvb, obj->offset, obj->length, event_name);
+      idx++;
 
-      /* Method name */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* method_name = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_invoke_method_name, tvb, offset, 1, method_name);
+      /* Event Type */
+      obj = rbus_cursor_at(cursor, idx);
+      if (obj->type == RBUS_MP_UINT) {
+         add_mp_uint(tree, hf_rbus_event_type, tvb, obj);
          idx++;
       }
 
-      /* Has params flag */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         gint32 has_params = (gint32)array_ptr[idx].via.u64;
-         proto_tree_add_int(tree, hf_rbus_has_params, tvb, offset, 1, has_params);
+      /* Has Event Data */
+      gboolean has_event_data = FALSE;
+      obj = rbus_cursor_at(cursor, idx);
+      if (obj->type == RBUS_MP_UINT) {
+         has_event_data = (obj->via.u64 != 0);
+         proto_tree_add_boolean(tree, hf_rbus_has_event_data, tvb, obj->offset, obj->length, has_event_data);
          idx++;
       }
 
-      /* Params would be an RBusObject - we can add detailed parsing later if needed */
-   } else if (strcmp(method, "METHOD_COMMIT") == 0) {
-      /* COMMIT Request: [sessionId, componentName, paramCount] */
-      guint idx = 0;
-
-      /* Session ID */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         proto_tree_add_uint(tree, hf_rbus_session_id, tvb, offset, 1,
-            (guint32)array_ptr[idx].via.u64);
+      /* Parse Event Data (rbusObject with properties) */
+      /* rbusObject in event publications is just a placeholder string, followed by property data */
+      if (has_event_data && rbus_cursor_has(cursor, idx)) {
+         /* Skip the placeholder rbusObject (usually a 1-byte string) */
          idx++;
       }
 
-      /* Component name */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* comp = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_component_name, tvb, offset, 1, comp);
+      /* Has Filter */
+      obj = rbus_cursor_at(cursor, idx);
+      if (obj->type == RBUS_MP_UINT) {
+         gboolean has_filter = (obj->via.u64 != 0);
+         proto_tree_add_boolean(tree, hf_rbus_has_filter, tvb, obj->offset, obj->length, has_filter);
          idx++;
-      }
 
-      /* Param count */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         proto_tree_add_uint(tree, hf_rbus_param_count, tvb, offset, 1,
-            (guint32)array_ptr[idx].via.u64);
-         idx++;
+         /* Skip filter data if present (not parsing filter details yet) */
+         if (has_filter && rbus_cursor_has(cursor, idx)) {
+            idx++; /* Skip filter object */
+         }
       }
-   } else if (strcmp(method, "METHOD_GETPARAMETERNAMES") == 0) {
-      /* GETPARAMETERNAMES/Discovery Request: [objectName, depth, getRowNamesOnly, method, ...] */
-      guint idx = 0;
 
-      /* Object name (root for discovery) */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* obj_name = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_parameter_name, tvb, offset, 1, obj_name);
-         idx++;
-      }
+      /* Now parse the property data: [prop_count, name, type, value, ...] */
+      if (has_event_data && rbus_cursor_has(cursor, idx)) {
+         guint32 prop_count = 0;
+         guint data_start = rbus_cursor_at(cursor, idx)->offset;
+         guint data_idx = idx;
 
-      /* Discovery depth (0=single level, -1=unlimited) */
-      if (idx < (guint)method_idx) {
-         gint32 depth = 0;
-         if (array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            depth = (gint32)array_ptr[idx].via.u64;
-         } else if (array_ptr[idx].type == MSGPACK_OBJECT_NEGATIVE_INTEGER) {
-            depth = (gint32)array_ptr[idx].via.i64;
+         obj = rbus_cursor_at(cursor, idx);
+         if (obj->type == RBUS_MP_UINT) {
+            prop_count = (guint32)obj->via.u64;
+            idx++;
          }
-         proto_tree_add_int(tree, hf_rbus_discovery_depth, tvb, offset, 1, depth);
-         idx++;
-      }
 
-      /* Get row names only flag (1=table rows only, 0=all elements) */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         proto_tree_add_uint(tree, hf_rbus_discovery_row_names_only, tvb, offset, 1,
-            (guint32)array_ptr[idx].via.u64);
-         idx++;
-      }
-   } else if (strcmp(method, "METHOD_SETPARAMETERATTRIBUTES") == 0 ||
-      strcmp(method, "METHOD_GETPARAMETERATTRIBUTES") == 0) {
-      /* Attributes requests - basic parsing */
-      guint idx = 0;
+         proto_item* data_item = proto_tree_add_item(tree, hf_rbus_event_data, tvb, data_start, 0, ENC_NA);
+         proto_tree* data_tree = proto_item_add_subtree(data_item, ett_rbus_property);
+         proto_item_append_text(data_item, " (%u properties)", prop_count);
 
-      /* Component name */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* comp = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_component_name, tvb, offset, 1, comp);
-         idx++;
-      }
+         /* Parse properties as triplets: name, type, value */
+         for (guint32 p = 0; p < prop_count && rbus_cursor_has(cursor, idx + 2); p++) {
+            add_name_type_value(data_tree, tvb, pinfo, rbus_cursor_at(cursor, idx), rbus_cursor_at(cursor, idx + 1),
+               rbus_cursor_at(cursor, idx + 2), hf_rbus_object_property, hf_rbus_object_property_name,
+               hf_rbus_property_type, hf_rbus_object_property_namevalue, TRUE);
+            idx += 3;
+         }
 
-      /* Show remaining fields generically */
-      while (idx < (guint)method_idx) {
-         if (array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-            gchar* str = wmem_strdup_printf(pinfo->pool, "%.*s",
-               (int)array_ptr[idx].via.str.size,
-               array_ptr[idx].via.str.ptr);
-            proto_tree_add_string(tree, hf_rbus_parameter_name, tvb, offset, 1, str);
-         } else if (array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            proto_tree_add_uint(tree, hf_rbus_param_count, tvb, offset, 1,
-               (guint32)array_ptr[idx].via.u64);
+         if (idx > data_idx) {
+            obj = rbus_cursor_at(cursor, idx - 1);
+            proto_item_set_len(data_item, obj->offset + obj->length - data_start);
          }
-         idx++;
       }
-   } else if (strcmp(method, "METHOD_ADDTBLROW") == 0) {
-      /* Add Table Row: [sessionId, tableName, aliasName, method, ...] */
-      guint idx = 0;
 
-      /* Session ID */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         proto_tree_add_uint(tree, hf_rbus_session_id, tvb, offset, 1,
-            (guint32)array_ptr[idx].via.u64);
+      /* Interval */
+      obj = rbus_cursor_at(cursor, idx);
+      if (obj->type == RBUS_MP_UINT) {
+         add_mp_uint(tree, hf_rbus_interval, tvb, obj);
          idx++;
       }
 
-      /* Table name (must end with period) */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* table = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_parameter_name, tvb, offset, 1, table);
+      /* Duration */
+      obj = rbus_cursor_at(cursor, idx);
+      if (obj->type == RBUS_MP_UINT) {
+         add_mp_uint(tree, hf_rbus_duration, tvb, obj);
          idx++;
       }
 
-      /* Alias Name (optional, can be empty string) */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* alias = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_table_alias, tvb, offset, 1, alias);
+      /* Component ID */
+      obj = rbus_cursor_at(cursor, idx);
+      if (obj->type == RBUS_MP_UINT) {
+         add_mp_int(tree, hf_rbus_component_id, tvb, obj);
          idx++;
       }
-   } else if (strcmp(method, "METHOD_DELETETBLROW") == 0) {
-      /* Delete Table Row: [sessionId, rowName, method, ...] */
-      guint idx = 0;
 
-      /* Session ID */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         proto_tree_add_uint(tree, hf_rbus_session_id, tvb, offset, 1,
-            (guint32)array_ptr[idx].via.u64);
-         idx++;
-      }
+      /* Event Metadata: [eventName, objectName, isRbus2, offset]
+       * This is DIFFERENT from the standard [method, ot_parent, ot_state, offset] */
+      if (rbus_cursor_has(cursor, idx + 3)) {
+         const rbus_mp_object_t* meta_first = rbus_cursor_at(cursor, idx);
+         const rbus_mp_object_t* meta_last = rbus_cursor_at(cursor, idx + 3);
+         proto_item* meta_item = proto_tree_add_item(tree, hf_rbus_metadata, tvb, meta_first->offset,
+            meta_last->offset + meta_last->length - meta_first->offset, ENC_NA);
+         proto_tree* meta_tree = proto_item_add_subtree(meta_item, ett_rbus_event_metadata);
+         proto_item_set_text(meta_item, "Event Metadata");
+
+         /* eventName (repeated) */
+         obj = rbus_cursor_at(cursor, idx);
+         if (obj->type == RBUS_MP_STR) {
+            add_mp_name(meta_tree, hf_rbus_event_name, tvb, pinfo, obj);
+            idx++;
+         }
 
-      /* Row name (e.g., "Device.WiFi.AccessPoint.1" or "[alias]") */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* row = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_parameter_name, tvb, offset, 1, row);
-         idx++;
-      }
-   } else if (strcmp(method, "METHOD_OPENDIRECT_CONN") == 0 ||
-      strcmp(method, "METHOD_CLOSEDIRECT_CONN") == 0) {
-      /* Direct connection methods - show any string fields */
-      guint idx = 0;
+         /* objectName (publishing component) */
+         obj = rbus_cursor_at(cursor, idx);
+         if (obj->type == RBUS_MP_STR) {
+            add_mp_name(meta_tree, hf_rbus_event_object_name, tvb, pinfo, obj);
+            idx++;
+         }
 
-      while (idx < (guint)method_idx) {
-         if (array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-            gchar* str = wmem_strdup_printf(pinfo->pool, "%.*s",
-               (int)array_ptr[idx].via.str.size,
-               array_ptr[idx].via.str.ptr);
-            proto_tree_add_string(tree, hf_rbus_component_name, tvb, offset, 1, str);
+         /* isRbus2 flag */
+         obj = rbus_cursor_at(cursor, idx);
+         if (obj->type == RBUS_MP_UINT) {
+            add_mp_uint(meta_tree, hf_rbus_event_is_rbus2, tvb, obj);
+            idx++;
+         }
+
+         /* offset (fixed 32-bit) */
+         if (rbus_cursor_has(cursor, idx)) {
+            add_mp_int(meta_tree, hf_rbus_metadata_offset, tvb, rbus_cursor_at(cursor, idx));
          }
-         idx++;
-      }
-   } else if (strcmp(method, "METHOD_SETPARAMETERVALUES") == 0) {
-      /* SET Request: [sessionId, componentName, rollback, paramCount, params..., commit] */
-      guint idx = 0;
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         proto_tree_add_uint(tree, hf_rbus_session_id, tvb, offset, 1,
-            (guint32)array_ptr[idx].via.u64);
-         idx++;
-      }
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* comp = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_component_name, tvb, offset, 1, comp);
-         idx++;
-      }
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         proto_tree_add_uint(tree, hf_rbus_rollback, tvb, offset, 1,
-            (guint32)array_ptr[idx].via.u64);
-         idx++;
-      }
-      guint32 param_count = 0;
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-         param_count = (guint32)array_ptr[idx].via.u64;
-         proto_tree_add_uint(tree, hf_rbus_param_count, tvb, offset, 1, param_count);
-         idx++;
       }
 
-      /* Parse parameters (triplets: name, type, value) */
-      for (guint32 p = 0; p < param_count && idx + 2 <= (guint)method_idx; p++) {
-         proto_item* param_item = proto_tree_add_item(tree, hf_rbus_parameter, tvb, offset, 1, ENC_NA);
-         proto_tree* param_tree = proto_item_add_subtree(param_item, ett_rbus_parameter);
+      return payload_length;
+   }
 
-         /* Name */
-         gchar* name = NULL;
-         if (array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-            name = wmem_strdup_printf(pinfo->pool, "%.*s",
-               (int)array_ptr[idx].via.str.size,
-               array_ptr[idx].via.str.ptr);
-            proto_tree_add_string(param_tree, hf_rbus_parameter_name, tvb, offset, 1, name);
-            proto_item_append_text(param_item, ": %s", name);
-         }
-         idx++;
+   /* Requests and responses add nothing to the Info column */
+   if (!tree) {
+      return payload_length;
+   }
 
-         /* Type */
-         guint32 type_id = 0;
-         if (array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            type_id = (guint32)array_ptr[idx].via.u64;
-            proto_tree_add_uint(param_tree, hf_rbus_parameter_type, tvb, offset, 1, type_id);
-         }
-         idx++;
+   /* Create metadata subtree covering [method, ot_parent, ot_state, offset] */
+   rbus_mp_object_t meta[4];
+   guint32 meta_count = 0;
+   while (meta_count < summary->meta_count &&
+      rbus_mp_read_at(tvb, summary->meta[meta_count], summary->end, &meta[meta_count])) {
+      meta_count++;
+   }
+   if (meta_count == 0) {
+      return payload_length;
+   }
+   const rbus_mp_object_t* method_obj = &meta[0];
+   const rbus_mp_object_t* meta_last = &meta[meta_count - 1];
+   proto_item* meta_item = proto_tree_add_item(tree, hf_rbus_metadata, tvb, method_obj->offset,
+      meta_last->offset + meta_last->length - method_obj->offset, ENC_NA);
+   proto_tree* meta_tree = proto_item_add_subtree(meta_item, ett_rbus_metadata);
 
-         /* Value */
-         gchar* value_str = NULL;
-         if (idx < (guint)method_idx) {
-            value_str = add_typed_value(param_tree, tvb, pinfo, offset, &array_ptr[idx], FALSE);
+   /* Add method name */
+   proto_tree_add_string(meta_tree, hf_rbus_method_name, tvb, method_obj->offset, method_obj->length,
+      rbus_mp_get_string(tvb, pinfo, method_obj));
 
-            /* Add synthetic namevalue field for filtering */
-            if (name && value_str) {
-               gchar* namevalue = wmem_strdup_printf(pinfo->pool, "%s=%s", name, value_str);
-               proto_tree_add_string(param_tree, hf_rbus_parameter_namevalue, tvb, offset, 1, namevalue);
-            }
-         }
-         idx++;
-      }
+   /* Add OT fields if present */
+   if (meta_count > 1 && meta[1].type == RBUS_MP_STR) {
+      add_mp_string(meta_tree, hf_rbus_ot_parent, tvb, pinfo, &meta[1]);
+   }
+   if (meta_count > 2 && meta[2].type == RBUS_MP_STR) {
+      add_mp_string(meta_tree, hf_rbus_ot_state, tvb, pinfo, &meta[2]);
+   }
+   /* Add offset field if present */
+   if (meta_count > 3) {
+      add_mp_int(meta_tree, hf_rbus_metadata_offset, tvb, &meta[3]);
+   }
 
-      /* Commit flag */
-      if (idx < (guint)method_idx && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-         gchar* commit = wmem_strdup_printf(pinfo->pool, "%.*s",
-            (int)array_ptr[idx].via.str.size,
-            array_ptr[idx].via.str.ptr);
-         proto_tree_add_string(tree, hf_rbus_commit, tvb, offset, 1, commit);
-      }
-   } else if (strcmp(method, "METHOD_RESPONSE") == 0) {
-      /* Response: [errorCode, propertyCount, properties..., method, ot_parent, ot_state, offset] */
-      guint idx = 0;
+   /* Method-specific fields */
+   for (guint32 i = 0; i < summary->field_count; i++) {
+      rbus_add_method_field(tree, tvb, pinfo, summary->end, &summary->fields[i]);
+   }
 
-      /* Error Code (first field in response) */
-      gint32 error_code = 0;
-      if (idx < (guint)method_idx) {
-         if (array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-            error_code = (gint32)array_ptr[idx].via.u64;
-         } else if (array_ptr[idx].type == MSGPACK_OBJECT_NEGATIVE_INTEGER) {
-            error_code = (gint32)array_ptr[idx].via.i64;
-         }
-         proto_tree_add_int(tree, hf_rbus_error_code, tvb, offset, 1, error_code);
-         idx++;
-      }
+   return payload_length;
+}
 
-      /* Try to find and parse properties regardless of error code.
-       * Some responses may include property data even with non-zero error codes. */
-      if (idx < (guint)method_idx) {
-         /* First, check if next field is a failed element name string (for simple error responses) */
-         gboolean is_simple_error = FALSE;
-         if (error_code != 0 && array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-            /* Check if this looks like a failed element name by seeing if the string after is METHOD_ */
-            if (idx + 1 < (guint)method_idx && array_ptr[idx + 1].type == MSGPACK_OBJECT_STR) {
-               gchar* next_str = wmem_strdup_printf(pinfo->pool, "%.*s",
-                  (int)array_ptr[idx + 1].via.str.size,
-                  array_ptr[idx + 1].via.str.ptr);
-               if (strncmp(next_str, "METHOD_", 7) == 0) {
-                  /* This is a simple error response with just a failed element name */
-                  is_simple_error = TRUE;
-                  gchar* failed = wmem_strdup_printf(pinfo->pool, "%.*s",
-                     (int)array_ptr[idx].via.str.size,
-                     array_ptr[idx].via.str.ptr);
-                  proto_tree_add_string(tree, hf_rbus_failed_element, tvb, offset, 1, failed);
-                  idx++;
-               }
-            }
-         }
+/*
+ * Hops of the MSG_ROUNDTRIP_TIME timestamps. Each hop is the difference of
+ * two consecutive timestamps; it is only known when both were filled in.
+ * rtmessage stamps T1-T5 with time(NULL), so deltas are whole seconds and a
+ * delta of 1 may be any delay that crossed a second boundary.
+ */
+typedef enum {
+   RBUS_HOP_CLIENT_TO_ROUTER,      /* T2 - T1 */
+   RBUS_HOP_ROUTER_TO_PROVIDER,    /* T3 - T2 */
+   RBUS_HOP_PROVIDER,              /* T4 - T3 */
+   RBUS_HOP_RETURN,                /* T5 - T4 */
+   RBUS_HOP_COUNT
+} rbus_hop_t;
+
+static const char* const rbus_hop_names[RBUS_HOP_COUNT] = {
+   [RBUS_HOP_CLIENT_TO_ROUTER] = "Client to router",
+   [RBUS_HOP_ROUTER_TO_PROVIDER] = "Router to provider",
+   [RBUS_HOP_PROVIDER] = "Provider processing",
+   [RBUS_HOP_RETURN] = "Return path",
+};
 
-         /* If not a simple error response, look for property count */
-         if (!is_simple_error) {
-            /* Look for property count: an integer that's followed by the expected structure
-             * This handles new protocol fields between error code and property count */
-            guint32 prop_count = 0;
-            gboolean found_prop_count = FALSE;
-            
-            while (idx < (guint)method_idx && !found_prop_count) {
-               if ((array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER || 
-                    array_ptr[idx].type == MSGPACK_OBJECT_NEGATIVE_INTEGER)) {
-                  guint32 potential_count = (array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) ? 
-                                            (guint32)array_ptr[idx].via.u64 : 
-                                            (guint32)array_ptr[idx].via.i64;
-                  
-                  /* Verify this looks like a property count by checking if next field matches expectations:
-                   * - If count > 0: next field should be a string (property name)
-                   * - If count == 0: should be near the METHOD_ field */
-                  if (potential_count > 0 && idx + 1 < (guint)method_idx && 
-                      array_ptr[idx + 1].type == MSGPACK_OBJECT_STR) {
-                     /* Non-zero count followed by string - this is the property count */
-                     prop_count = potential_count;
-                     found_prop_count = TRUE;
-                     proto_tree_add_uint(tree, hf_rbus_property_count, tvb, offset, 1, prop_count);
-                     idx++;
-                     break;
-                  } else if (potential_count == 0 && idx + 1 < (guint)method_idx && 
-                             array_ptr[idx + 1].type != MSGPACK_OBJECT_POSITIVE_INTEGER &&
-                             array_ptr[idx + 1].type != MSGPACK_OBJECT_NEGATIVE_INTEGER) {
-                     /* Zero count not followed by another integer - likely the property count */
-                     prop_count = 0;
-                     found_prop_count = TRUE;
-                     proto_tree_add_uint(tree, hf_rbus_property_count, tvb, offset, 1, prop_count);
-                     idx++;
-                     break;
-                  }
-               }
-               idx++;
-            }
+static int* const rbus_hop_fields[RBUS_HOP_COUNT] = {
+   [RBUS_HOP_CLIENT_TO_ROUTER] = &hf_rbus_roundtrip_client_to_router,
+   [RBUS_HOP_ROUTER_TO_PROVIDER] = &hf_rbus_roundtrip_router_to_provider,
+   [RBUS_HOP_PROVIDER] = &hf_rbus_roundtrip_provider,
+   [RBUS_HOP_RETURN] = &hf_rbus_roundtrip_return,
+};
 
-            /* Parse properties (triplets: name, type, value) */
-            for (guint32 p = 0; p < prop_count && idx + 2 <= (guint)method_idx; p++) {
-               proto_item* prop_item = proto_tree_add_item(tree, hf_rbus_property, tvb, offset, 1, ENC_NA);
-               proto_tree* prop_tree = proto_item_add_subtree(prop_item, ett_rbus_property);
-
-               /* Name */
-               gchar* name = NULL;
-               if (array_ptr[idx].type == MSGPACK_OBJECT_STR) {
-                  name = wmem_strdup_printf(pinfo->pool, "%.*s",
-                     (int)array_ptr[idx].via.str.size,
-                     array_ptr[idx].via.str.ptr);
-                  proto_tree_add_string(prop_tree, hf_rbus_property_name, tvb, offset, 1, name);
-                  proto_item_append_text(prop_item, ": %s", name);
-               }
-               idx++;
+typedef struct {
+   guint8 valid;                   /* Bit per rbus_hop_t with a known delta */
+   gint32 delta[RBUS_HOP_COUNT];   /* Seconds */
+} rbus_roundtrip_t;
 
-               /* Type */
-               guint32 type_id = 0;
-               if (array_ptr[idx].type == MSGPACK_OBJECT_POSITIVE_INTEGER) {
-                  type_id = (guint32)array_ptr[idx].via.u64;
-                  proto_tree_add_uint(prop_tree, hf_rbus_property_type, tvb, offset, 1, type_id);
-               }
-               idx++;
+/*
+ * Compute the hop deltas from T1-T5, add them as generated fields and flag
+ * hops slower than the configured threshold.
+ */
+static void
+rbus_add_roundtrip_hops(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, guint offset,
+   const guint32 t[5], rbus_roundtrip_t* rt) {
+   int hop;
 
-               /* Value */
-               gchar* value_str = NULL;
-               if (idx < (guint)method_idx) {
-                  value_str = add_typed_value(prop_tree, tvb, pinfo, offset, &array_ptr[idx], TRUE);
+   for (hop = 0; hop < RBUS_HOP_COUNT; hop++) {
+      proto_item* it;
 
-                  /* Add synthetic namevalue field for filtering */
-                  if (name && value_str) {
-                     gchar* namevalue = wmem_strdup_printf(pinfo->pool, "%s=%s", name, value_str);
-                     proto_tree_add_string(prop_tree, hf_rbus_property_namevalue, tvb, offset, 1, namevalue);
-                  }
-               }
-               idx++;
-            }
-         }
+      if (t[hop] == 0 || t[hop + 1] == 0) {
+         continue;
       }
-   }
 
-   msgpack_unpacked_destroy(&msg);
-   return payload_length;
+      /* Signed difference so a wrapped counter still gives the right delta */
+      rt->delta[hop] = (gint32)(t[hop + 1] - t[hop]);
+      rt->valid |= 1 << hop;
+
+      it = proto_tree_add_int(tree, *rbus_hop_fields[hop], tvb, offset + hop * 4, 8, rt->delta[hop]);
+      proto_item_set_generated(it);
+
+      if (pref_hop_threshold && rt->delta[hop] > 0 && (guint32)rt->delta[hop] > pref_hop_threshold) {
+         expert_add_info_format(pinfo, it, &ei_rbus_slow_hop, "%s took %d s (threshold %u s)",
+            rbus_hop_names[hop], rt->delta[hop], pref_hop_threshold);
+      }
+   }
 }
 
 /*
- * Dissect the RBus protocol
+ * SET transactions. SETs sharing a session ID, the commit and the responses
+ * to all of them are grouped into one record; a SET outside a session (ID 0)
+ * is a transaction of its own.
  */
-static int
-dissect_rbus(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void* data _U_) {
-   proto_item* ti;
-   proto_tree* rbus_tree;
-   proto_tree* header_tree;
-   guint offset = 0;
-   guint32 header_length;
+typedef enum {
+   RBUS_SET_OPEN,               /* No commit seen yet */
+   RBUS_SET_COMMITTING,         /* Committed, responses outstanding */
+   RBUS_SET_SUCCEEDED,
+   RBUS_SET_FAILED
+} rbus_set_outcome_t;
+
+typedef struct {
+   guint32 id;                  /* 1 for the first transaction in the capture */
+   guint32 session_id;
+   guint32 first_frame;         /* Frame of the first SET */
+   nstime_t first_time;
+   guint32 commit_frame;        /* Frame of the committing SET or COMMIT, 0 if none seen */
+   guint32 complete_frame;      /* Frame of the last response, 0 while outstanding */
+   guint32 complete_pdu;        /* PDU within complete_frame */
+   nstime_t duration;           /* First SET to last response */
+   guint32 messages;            /* SET and COMMIT requests */
+   guint32 params;              /* Parameters over all SETs */
+   guint32 pending;             /* Requests awaiting their response */
+   gint32 error_code;           /* First non-zero response error code */
+   rbus_set_outcome_t outcome;
+} rbus_set_transaction_t;
+
+/*
+ * Request/response pairing. A response carries its request's sequence number
+ * back over the same connection, so requests wait in a per-conversation map
+ * keyed by sequence number until the response arrives. The pairing found on
+ * the first pass is stored per PDU and simply read back on later passes.
+ */
+typedef struct {
+   guint32 req_frame;           /* Frame carrying the request */
+   guint32 rep_frame;           /* Frame carrying the response, 0 if none seen */
+   guint32 dup_frame;           /* Pending request this one reused the sequence number of, 0 if none */
+   nstime_t req_time;           /* Request timestamp */
+   nstime_t rep_time;           /* Response timestamp */
+   rbus_method_t method;        /* Method of the request */
+   guint32 topic_id;            /* Interned topic of the request */
+   rbus_set_transaction_t* set_txn;   /* SET transaction of a SET or COMMIT request, NULL if none */
+} rbus_transaction_t;
+
+/*
+ * Event publication statistics. Publications are grouped by event name and
+ * connection, since rtrouted forwards each one from the provider's connection
+ * to every subscriber's and a capture may hold all of the copies. On the
+ * first pass each one gets its number within the group, the time since the
+ * previous publication, the smoothed inter-arrival jitter and the rate over
+ * the latest publications. The result is stored per PDU.
+ */
+#define RBUS_EVENT_RATE_WINDOW 16    /* Publications the rate is measured over */
+
+typedef struct {
+   guint32 name_id;             /* Interned event name */
+   guint32 publication;         /* 1 for the first publication of this event */
+   guint32 prev_frame;          /* Frame of the previous publication, 0 if none */
+   nstime_t interarrival;       /* Time since the previous publication */
+   guint32 jitter;              /* Smoothed inter-arrival jitter in microseconds, from the third publication */
+   gdouble rate;                /* Publications per second over the window, 0 if unknown */
+   guint32 subscribers;         /* Inboxes subscribed to the event name when it was published,
+                                   RBUS_SUBSCRIBERS_UNKNOWN if no subscription to it was seen */
    guint32 payload_length;
-   guint32 topic_length;
-   guint32 reply_topic_length;
+} rbus_event_record_t;
+
+/*
+ * Discovery traffic. QUERY, enumerate, trace-origin and registered-components
+ * requests are grouped by the inbox they ask to be answered on; on the first
+ * pass each request and response is added to the inbox's sliding window and
+ * the request count, bytes and rate over the window are stored per PDU.
+ */
+typedef struct {
+   guint32 inbox_id;            /* Interned requesting inbox */
+   gint control_type;           /* Discovery kind, as get_control_message_type() */
+   gboolean response;
+   guint32 request;             /* 1 for the first discovery request of this inbox, 0 for responses */
+   guint32 prev_frame;          /* Frame of the inbox's previous discovery request, 0 if none */
+   nstime_t interval;           /* Time since that request */
+   guint32 window_requests;     /* Requests within the window, this one included */
+   guint32 window_bytes;        /* Request and response bytes within the window */
+   gdouble rate;                /* Requests per second over the window */
+   guint32 fanout;              /* Components or elements the response lists */
+   gboolean has_fanout;
+   guint32 message_length;
+} rbus_discovery_record_t;
+
+/*
+ * Per-message data handed to tap listeners
+ */
+typedef struct {
+   guint32 seq;
    guint64 flags;
-   guint32 control_data;
-   const guint8* topic_str = NULL;
-   const guint8* reply_topic_str = NULL;
+   rbus_method_t method;
+   const gchar* topic;                  /* Topic from the header, NULL if absent */
+   guint32 topic_id;                    /* Interned topic, 0 if absent */
+   guint32 message_length;              /* Header plus payload */
+   const rbus_transaction_t* trans;     /* Request/response pairing, NULL if none */
+   rbus_roundtrip_t roundtrip;          /* Hop deltas, if the header carries T1-T5 */
+   const rbus_event_record_t* event;    /* Event publication statistics, NULL if not an event */
+   const rbus_set_transaction_t* set_txn;   /* SET transaction this PDU completes, NULL if none */
+   const rbus_discovery_record_t* discovery;   /* Discovery request or response, NULL if neither */
+} rbus_tap_info_t;
+
+typedef struct {
+   wmem_map_t* pending;         /* Sequence number -> rbus_transaction_t awaiting its response */
+   wmem_map_t* event_streams;   /* Interned event name id -> rbus_event_stream_t of this connection */
+   wmem_map_t* set_sessions;    /* Session ID -> uncommitted rbus_set_transaction_t of this connection */
+   guint32 heur_miss_bytes;     /* Bytes since the last segment holding a plausible header */
+   gboolean heur_rejected;      /* Stream is not RBus; the heuristic no longer looks at it */
+} rbus_conv_info_t;
+
+static nstime_t rbus_last_time;    /* Latest RBus PDU seen on the first pass */
 
-   /* Check if we have enough data for minimal header (marker + version + header_length) */
-   guint available = tvb_captured_length(tvb);
-   if (available < 6) {
-      /* Need more data for TCP desegmentation */
-      pinfo->desegment_offset = 0;
-      pinfo->desegment_len = DESEGMENT_ONE_MORE_SEGMENT;
-      return -((gint)available);
+static void
+rbus_transactions_init(void) {
+   nstime_set_zero(&rbus_last_time);
+}
+
+static gint64
+rbus_nstime_to_us(const nstime_t* t) {
+   return (gint64)t->secs * 1000000 + t->nsecs / 1000;
+}
+
+static rbus_conv_info_t*
+rbus_get_conv_info(packet_info* pinfo) {
+   conversation_t* conversation = find_or_create_conversation(pinfo);
+   rbus_conv_info_t* conv_info = (rbus_conv_info_t*)conversation_get_proto_data(conversation, proto_rbus);
+
+   if (!conv_info) {
+      conv_info = wmem_new0(wmem_file_scope(), rbus_conv_info_t);
+      conversation_add_proto_data(conversation, proto_rbus, conv_info);
+   }
+   return conv_info;
+}
+
+/*
+ * Return the transaction this PDU belongs to, or NULL for messages that are
+ * neither requests nor responses and for responses with no request seen.
+ */
+static rbus_transaction_t*
+rbus_match_transaction(packet_info* pinfo, guint32 pdu_index, guint32 seq,
+   guint64 flags, rbus_method_t method, guint32 topic_id) {
+   guint32 key = RBUS_PDU_KEY(pdu_index, RBUS_PDU_DATA_TRANSACTION);
+   rbus_transaction_t* trans;
+
+   if (PINFO_FD_VISITED(pinfo)) {
+      return (rbus_transaction_t*)p_get_proto_data(wmem_file_scope(), pinfo, proto_rbus, key);
+   }
+
+   rbus_conv_info_t* conv_info = rbus_get_conv_info(pinfo);
+
+   if (!conv_info->pending) {
+      conv_info->pending = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+   }
+
+   /* How far the capture goes, to tell a timed out request from one cut off by the end of the capture */
+   if (nstime_cmp(&pinfo->abs_ts, &rbus_last_time) > 0) {
+      rbus_last_time = pinfo->abs_ts;
+   }
+
+   if (flags & RTMSG_FLAG_REQUEST) {
+      /* A reused sequence number replaces the older request */
+      rbus_transaction_t* prev = (rbus_transaction_t*)wmem_map_lookup(conv_info->pending, GUINT_TO_POINTER(seq));
+
+      trans = wmem_new0(wmem_file_scope(), rbus_transaction_t);
+      trans->req_frame = pinfo->num;
+      trans->dup_frame = prev ? prev->req_frame : 0;
+      trans->req_time = pinfo->abs_ts;
+      trans->method = method;
+      trans->topic_id = topic_id;
+      wmem_map_insert(conv_info->pending, GUINT_TO_POINTER(seq), trans);
+   } else if (flags & RTMSG_FLAG_RESPONSE) {
+      trans = (rbus_transaction_t*)wmem_map_remove(conv_info->pending, GUINT_TO_POINTER(seq));
+      if (!trans) {
+         return NULL;
+      }
+      trans->rep_frame = pinfo->num;
+      trans->rep_time = pinfo->abs_ts;
+   } else {
+      return NULL;
+   }
+
+   p_add_proto_data(wmem_file_scope(), pinfo, proto_rbus, key, trans);
+   return trans;
+}
+
+/*
+ * Add the generated request/response link fields, and flag requests left
+ * without a response within the timeout, late or slow responses and reused
+ * sequence numbers
+ */
+static void
+rbus_add_transaction_items(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, proto_item* rbus_item,
+   guint32 seq, const rbus_transaction_t* trans) {
+   gint64 timeout_us = (gint64)pref_response_timeout * 1000;
+   proto_item* it;
+   nstime_t delta;
+
+   /* Request and response both carry the request's method, which the SRT method table filters on */
+   it = proto_tree_add_uint(tree, hf_rbus_method_id, tvb, 0, 0, trans->method);
+   proto_item_set_generated(it);
+
+   if (trans->req_frame == pinfo->num) {
+      if (trans->dup_frame) {
+         it = proto_tree_add_uint(tree, hf_rbus_duplicate_of, tvb, 0, 0, trans->dup_frame);
+         proto_item_set_generated(it);
+         expert_add_info_format(pinfo, it, &ei_rbus_duplicate_sequence,
+            "Sequence number %u reused while the request in frame %u awaits its response", seq, trans->dup_frame);
+      }
+
+      if (trans->rep_frame) {
+         it = proto_tree_add_uint(tree, hf_rbus_response_in, tvb, 0, 0, trans->rep_frame);
+         proto_item_set_generated(it);
+
+         nstime_delta(&delta, &trans->rep_time, &trans->req_time);
+         if (pref_response_timeout && rbus_nstime_to_us(&delta) > timeout_us) {
+            expert_add_info_format(pinfo, it, &ei_rbus_response_timeout,
+               "Response came after %.3f s, past the %u ms timeout", nstime_to_sec(&delta), pref_response_timeout);
+         }
+      } else if (PINFO_FD_VISITED(pinfo)) {
+         /* Only known once the whole capture has been seen */
+         nstime_delta(&delta, &rbus_last_time, &trans->req_time);
+         if (pref_response_timeout && rbus_nstime_to_us(&delta) > timeout_us) {
+            expert_add_info_format(pinfo, rbus_item, &ei_rbus_response_timeout,
+               "No response within the %u ms timeout", pref_response_timeout);
+         } else {
+            expert_add_info(pinfo, rbus_item, &ei_rbus_no_response);
+         }
+      }
+   } else {
+      gint64 delta_us;
+
+      it = proto_tree_add_uint(tree, hf_rbus_response_to, tvb, 0, 0, trans->req_frame);
+      proto_item_set_generated(it);
+
+      nstime_delta(&delta, &pinfo->abs_ts, &trans->req_time);
+      it = proto_tree_add_time(tree, hf_rbus_response_time, tvb, 0, 0, &delta);
+      proto_item_set_generated(it);
+
+      /* The client has given up on a response past the timeout; below it, the SLA applies */
+      delta_us = rbus_nstime_to_us(&delta);
+      if (pref_response_timeout && delta_us > timeout_us) {
+         expert_add_info_format(pinfo, it, &ei_rbus_response_timeout,
+            "Response came after %.3f s, past the %u ms timeout", nstime_to_sec(&delta), pref_response_timeout);
+      } else if (pref_response_sla && delta_us > (gint64)pref_response_sla * 1000) {
+         expert_add_info_format(pinfo, it, &ei_rbus_slow_response,
+            "Response took %.3f ms (SLA %u ms)", delta_us / 1000.0, pref_response_sla);
+      }
+   }
+}
+
+/*
+ * What a SET or COMMIT request contributes to its SET transaction
+ */
+typedef struct {
+   guint32 session_id;          /* 0 outside a session */
+   guint32 params;
+   gboolean commit;
+} rbus_set_request_t;
+
+static guint32 rbus_set_transaction_count = 0;
+
+static void
+rbus_set_transactions_init(void) {
+   rbus_set_transaction_count = 0;
+}
+
+/*
+ * SET Request: [sessionId, componentName, rollback, paramCount, params..., commit, method, ...]
+ * COMMIT Request: [sessionId, componentName, paramCount, method, ...]
+ */
+static gboolean
+rbus_set_request_from_payload(const rbus_payload_summary_t* summary, rbus_set_request_t* req) {
+   if (!summary->set_request) {
+      return FALSE;
+   }
+   req->session_id = summary->session_id;
+   req->params = summary->param_count;
+   req->commit = summary->commit;
+   return TRUE;
+}
+
+/*
+ * Add a SET or COMMIT request (req set) or the response to one (req NULL) to
+ * its SET transaction, and return the transaction. A transaction completes
+ * when every request has its response, once it is committed or a response
+ * has failed.
+ */
+static const rbus_set_transaction_t*
+rbus_track_set_transaction(packet_info* pinfo, guint32 pdu_index, rbus_transaction_t* trans,
+   const rbus_set_request_t* req, gint32 error_code) {
+   guint32 key = RBUS_PDU_KEY(pdu_index, RBUS_PDU_DATA_SET_TRANSACTION);
+   rbus_conv_info_t* conv_info;
+   rbus_set_transaction_t* txn;
+
+   if (PINFO_FD_VISITED(pinfo)) {
+      return (const rbus_set_transaction_t*)p_get_proto_data(wmem_file_scope(), pinfo, proto_rbus, key);
+   }
+
+   if (!trans) {
+      return NULL;
+   }
+
+   /* Session IDs are only unique per client, so sessions are looked up on this connection */
+   conv_info = rbus_get_conv_info(pinfo);
+   if (!conv_info->set_sessions) {
+      conv_info->set_sessions = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+   }
+
+   if (req) {
+      txn = req->session_id ?
+         (rbus_set_transaction_t*)wmem_map_lookup(conv_info->set_sessions, GUINT_TO_POINTER(req->session_id)) : NULL;
+      if (!txn) {
+         txn = wmem_new0(wmem_file_scope(), rbus_set_transaction_t);
+         txn->id = ++rbus_set_transaction_count;
+         txn->session_id = req->session_id;
+         txn->first_frame = pinfo->num;
+         txn->first_time = pinfo->abs_ts;
+         if (req->session_id) {
+            wmem_map_insert(conv_info->set_sessions, GUINT_TO_POINTER(req->session_id), txn);
+         }
+      }
+
+      txn->messages++;
+      txn->params += req->params;
+      txn->pending++;
+      if (req->commit && !txn->commit_frame) {
+         txn->commit_frame = pinfo->num;
+         txn->outcome = RBUS_SET_COMMITTING;
+      }
+      trans->set_txn = txn;
+   } else if (trans->set_txn && trans->rep_frame == pinfo->num) {
+      txn = trans->set_txn;
+      if (!txn->complete_frame) {
+         txn->pending--;
+         if (error_code && !txn->error_code) {
+            txn->error_code = error_code;
+         }
+         if (!txn->pending && (txn->commit_frame || txn->error_code)) {
+            txn->complete_frame = pinfo->num;
+            txn->complete_pdu = pdu_index;
+            nstime_delta(&txn->duration, &pinfo->abs_ts, &txn->first_time);
+            txn->outcome = txn->error_code ? RBUS_SET_FAILED : RBUS_SET_SUCCEEDED;
+         }
+      }
+   } else {
+      return NULL;
+   }
+
+   /* Later SETs in the session start a new transaction */
+   if (txn->session_id && txn->outcome != RBUS_SET_OPEN &&
+      wmem_map_lookup(conv_info->set_sessions, GUINT_TO_POINTER(txn->session_id)) == txn) {
+      wmem_map_remove(conv_info->set_sessions, GUINT_TO_POINTER(txn->session_id));
+   }
+
+   p_add_proto_data(wmem_file_scope(), pinfo, proto_rbus, key, txn);
+   return txn;
+}
+
+/*
+ * Add the generated SET transaction fields
+ */
+static void
+rbus_add_set_transaction_items(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree,
+   const rbus_set_transaction_t* txn) {
+   proto_tree* txn_tree;
+   proto_item* it;
+
+   it = proto_tree_add_item(tree, hf_rbus_set_txn, tvb, 0, 0, ENC_NA);
+   proto_item_append_text(it, " %u: %s", txn->id,
+      val_to_str(pinfo->pool, txn->outcome, rbus_set_outcome_vals, "Unknown (%u)"));
+   proto_item_set_generated(it);
+   txn_tree = proto_item_add_subtree(it, ett_rbus_set_txn);
+
+   it = proto_tree_add_uint(txn_tree, hf_rbus_set_txn_id, tvb, 0, 0, txn->id);
+   proto_item_set_generated(it);
+   it = proto_tree_add_uint(txn_tree, hf_rbus_set_txn_first, tvb, 0, 0, txn->first_frame);
+   proto_item_set_generated(it);
+   if (txn->commit_frame) {
+      it = proto_tree_add_uint(txn_tree, hf_rbus_set_txn_commit, tvb, 0, 0, txn->commit_frame);
+      proto_item_set_generated(it);
+   }
+   if (txn->complete_frame) {
+      it = proto_tree_add_uint(txn_tree, hf_rbus_set_txn_complete, tvb, 0, 0, txn->complete_frame);
+      proto_item_set_generated(it);
+   }
+   it = proto_tree_add_uint(txn_tree, hf_rbus_set_txn_messages, tvb, 0, 0, txn->messages);
+   proto_item_set_generated(it);
+   it = proto_tree_add_uint(txn_tree, hf_rbus_set_txn_params, tvb, 0, 0, txn->params);
+   proto_item_set_generated(it);
+   if (txn->complete_frame) {
+      it = proto_tree_add_time(txn_tree, hf_rbus_set_txn_duration, tvb, 0, 0, &txn->duration);
+      proto_item_set_generated(it);
+   }
+   it = proto_tree_add_uint(txn_tree, hf_rbus_set_txn_outcome, tvb, 0, 0, txn->outcome);
+   proto_item_set_generated(it);
+   if (txn->error_code) {
+      it = proto_tree_add_int(txn_tree, hf_rbus_set_txn_error_code, tvb, 0, 0, txn->error_code);
+      proto_item_set_generated(it);
+   }
+}
+
+/*
+ * Capture-wide subscription table. METHOD_SUBSCRIBE/METHOD_UNSUBSCRIBE requests
+ * and router SUBSCRIBE control messages are replayed in frame order on the
+ * first pass, so at every frame the table holds the inboxes subscribed to each
+ * event name. Subscriptions made before the capture started are not known.
+ */
+typedef struct {
+   guint32 name_id;             /* Interned event name */
+   guint32 inbox_id;            /* Interned subscriber inbox */
+   gboolean add;                /* Subscribe, or unsubscribe */
+   guint32 subscribers;         /* Inboxes subscribed to the event name after this message */
+   guint32 subscribed_in;       /* Frame the inbox subscribed in, if it already was; 0 if not */
+} rbus_subscription_record_t;
+
+static wmem_map_t* rbus_subscriptions = NULL;   /* Interned event name id -> wmem_map_t of inbox id -> frame */
+
+/* Subscriber count of an event name with no subscription traffic in the capture so far */
+#define RBUS_SUBSCRIBERS_UNKNOWN G_MAXUINT32
+
+static void
+rbus_subscriptions_init(void) {
+   rbus_subscriptions = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+}
+
+/*
+ * Inboxes subscribed to an event name. Without a subscribe or unsubscribe for
+ * it in the capture the event may still have subscribers from before the
+ * capture started, so the count is unknown rather than 0.
+ */
+static guint32
+rbus_subscriber_count(guint32 name_id) {
+   wmem_map_t* inboxes = (wmem_map_t*)wmem_map_lookup(rbus_subscriptions, GUINT_TO_POINTER(name_id));
+
+   return inboxes ? wmem_map_size(inboxes) : RBUS_SUBSCRIBERS_UNKNOWN;
+}
+
+/*
+ * Read the event name and subscriber inbox of a METHOD_SUBSCRIBE or
+ * METHOD_UNSUBSCRIBE request: [event_name, reply_topic, ...]
+ */
+static gboolean
+rbus_subscription_from_payload(const rbus_payload_summary_t* summary, guint32* name_id, guint32* inbox_id) {
+   if (summary->field_count < 2 || summary->fields[0].id != RBUS_FIELD_EVENT_NAME ||
+      summary->fields[1].id != RBUS_FIELD_REPLY_TOPIC) {
+      return FALSE;
+   }
+
+   *name_id = summary->fields[0].name_id;
+   *inbox_id = summary->fields[1].name_id;
+   return *name_id && *inbox_id;
+}
+
+/*
+ * Read "add" and "topic" from router SUBSCRIBE control JSON, e.g.
+ * {"add":1,"topic":"Device.Foo!","route_id":1}. A missing "add" means subscribe.
+ */
+static gboolean
+rbus_subscription_from_control(tvbuff_t* tvb, packet_info* pinfo, guint offset, guint payload_length,
+   gboolean* add, guint32* name_id) {
+   const guint8* data = tvb_get_ptr(tvb, offset, payload_length);
+   guint end = payload_length;
+   guint pos = rbus_json_skip_ws(data, 0, end);
+
+   *add = TRUE;
+   *name_id = 0;
+
+   if (pos >= end || data[pos] != '{') {
+      return FALSE;
+   }
+   for (pos++; pos < end; ) {
+      guint key_start;
+      guint key_end;
+
+      pos = rbus_json_skip_ws(data, pos, end);
+      if (pos >= end || data[pos] == '}') {
+         break;
+      }
+      if (data[pos] == ',') {
+         pos++;
+         continue;
+      }
+      if (data[pos] != '"') {
+         break;
+      }
+
+      key_start = pos + 1;
+      key_end = rbus_json_string_end(data, pos, end);
+      pos = rbus_json_skip_ws(data, MIN(key_end + 1, end), end);
+      if (pos >= end || data[pos] != ':') {
+         break;
+      }
+      pos = rbus_json_skip_ws(data, pos + 1, end);
+      if (pos >= end) {
+         break;
+      }
+
+      if (key_end - key_start == 3 && memcmp(data + key_start, "add", 3) == 0) {
+         gint64 value;
+         if (rbus_json_parse_int(data, pos, end, &value) > pos) {
+            *add = value != 0;
+         }
+      } else if (key_end - key_start == 5 && memcmp(data + key_start, "topic", 5) == 0 && data[pos] == '"') {
+         guint value_end = rbus_json_string_end(data, pos, end);
+         if (value_end > pos + 1) {
+            rbus_intern_tvb(tvb, pinfo, offset + pos + 1, value_end - pos - 1, name_id);
+         }
+      }
+
+      key_end = rbus_json_skip_value(data, pos, end);
+      pos = key_end > pos ? key_end : pos + 1;
+   }
+
+   return *name_id != 0;
+}
+
+/*
+ * Apply a subscribe or unsubscribe to the table and return the resulting
+ * state for this PDU
+ */
+static const rbus_subscription_record_t*
+rbus_track_subscription(packet_info* pinfo, guint32 pdu_index, guint32 name_id, guint32 inbox_id, gboolean add) {
+   guint32 key = RBUS_PDU_KEY(pdu_index, RBUS_PDU_DATA_SUBSCRIPTION);
+   rbus_subscription_record_t* record;
+   wmem_map_t* inboxes;
+
+   if (PINFO_FD_VISITED(pinfo)) {
+      return (const rbus_subscription_record_t*)p_get_proto_data(wmem_file_scope(), pinfo, proto_rbus, key);
+   }
+
+   inboxes = (wmem_map_t*)wmem_map_lookup(rbus_subscriptions, GUINT_TO_POINTER(name_id));
+   if (!inboxes) {
+      inboxes = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+      wmem_map_insert(rbus_subscriptions, GUINT_TO_POINTER(name_id), inboxes);
+   }
+
+   record = wmem_new0(wmem_file_scope(), rbus_subscription_record_t);
+   record->name_id = name_id;
+   record->inbox_id = inbox_id;
+   record->add = add;
+
+   /* A repeated subscribe keeps the original frame */
+   if (add) {
+      record->subscribed_in = GPOINTER_TO_UINT(wmem_map_lookup(inboxes, GUINT_TO_POINTER(inbox_id)));
+      if (!record->subscribed_in) {
+         wmem_map_insert(inboxes, GUINT_TO_POINTER(inbox_id), GUINT_TO_POINTER(pinfo->num));
+      }
+   } else {
+      record->subscribed_in = GPOINTER_TO_UINT(wmem_map_remove(inboxes, GUINT_TO_POINTER(inbox_id)));
+   }
+   record->subscribers = wmem_map_size(inboxes);
+
+   p_add_proto_data(wmem_file_scope(), pinfo, proto_rbus, key, record);
+   return record;
+}
+
+/*
+ * Add the generated subscription state fields
+ */
+static void
+rbus_add_subscription_items(tvbuff_t* tvb, proto_tree* tree, const rbus_subscription_record_t* sub) {
+   proto_tree* sub_tree;
+   proto_item* it;
+
+   it = proto_tree_add_item(tree, hf_rbus_subscription, tvb, 0, 0, ENC_NA);
+   proto_item_append_text(it, ": %s", sub->add ? "Subscribe" : "Unsubscribe");
+   proto_item_set_generated(it);
+   sub_tree = proto_item_add_subtree(it, ett_rbus_subscription);
+
+   it = proto_tree_add_string(sub_tree, hf_rbus_subscription_event, tvb, 0, 0, rbus_intern_string(sub->name_id));
+   proto_item_set_generated(it);
+   it = proto_tree_add_string(sub_tree, hf_rbus_subscription_inbox, tvb, 0, 0, rbus_intern_string(sub->inbox_id));
+   proto_item_set_generated(it);
+   it = proto_tree_add_uint(sub_tree, hf_rbus_subscription_subscribers, tvb, 0, 0, sub->subscribers);
+   proto_item_set_generated(it);
+   if (sub->subscribed_in) {
+      it = proto_tree_add_uint(sub_tree, hf_rbus_subscription_subscribed_in, tvb, 0, 0, sub->subscribed_in);
+      proto_item_set_generated(it);
+   }
+}
+
+typedef struct {
+   guint32 count;               /* Publications so far */
+   guint32 last_frame;
+   nstime_t times[RBUS_EVENT_RATE_WINDOW];   /* Latest publication times, publication n at (n - 1) % window */
+   gint64 last_interarrival;    /* Microseconds, -1 before the second publication */
+   gdouble jitter;              /* Microseconds */
+} rbus_event_stream_t;
+
+/*
+ * Return the statistics of the event publication in this PDU
+ */
+static const rbus_event_record_t*
+rbus_track_event(packet_info* pinfo, guint32 pdu_index, guint32 name_id, guint32 payload_length) {
+   guint32 key = RBUS_PDU_KEY(pdu_index, RBUS_PDU_DATA_EVENT);
+   rbus_conv_info_t* conv_info;
+   rbus_event_stream_t* stream;
+   rbus_event_record_t* record;
+
+   if (PINFO_FD_VISITED(pinfo)) {
+      return (const rbus_event_record_t*)p_get_proto_data(wmem_file_scope(), pinfo, proto_rbus, key);
+   }
+
+   conv_info = rbus_get_conv_info(pinfo);
+   if (!conv_info->event_streams) {
+      conv_info->event_streams = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+   }
+   stream = (rbus_event_stream_t*)wmem_map_lookup(conv_info->event_streams, GUINT_TO_POINTER(name_id));
+   if (!stream) {
+      stream = wmem_new0(wmem_file_scope(), rbus_event_stream_t);
+      stream->last_interarrival = -1;
+      wmem_map_insert(conv_info->event_streams, GUINT_TO_POINTER(name_id), stream);
+   }
+
+   record = wmem_new0(wmem_file_scope(), rbus_event_record_t);
+   record->name_id = name_id;
+   record->publication = ++stream->count;
+   record->subscribers = rbus_subscriber_count(name_id);
+   record->payload_length = payload_length;
+
+   if (stream->count > 1) {
+      guint32 window = MIN(stream->count, RBUS_EVENT_RATE_WINDOW);
+      nstime_t elapsed;
+      gint64 interarrival;
+
+      record->prev_frame = stream->last_frame;
+      nstime_delta(&record->interarrival, &pinfo->abs_ts,
+         &stream->times[(stream->count - 2) % RBUS_EVENT_RATE_WINDOW]);
+      interarrival = rbus_nstime_to_us(&record->interarrival);
+
+      /* RFC 3550 estimator, J += (|D| - J) / 16, D being the change in inter-arrival time */
+      if (stream->last_interarrival >= 0) {
+         gint64 change = interarrival - stream->last_interarrival;
+         stream->jitter += ((gdouble)(change < 0 ? -change : change) - stream->jitter) / 16;
+         record->jitter = (guint32)stream->jitter;
+      }
+      stream->last_interarrival = interarrival;
+
+      /* The oldest publication in the window is still in the ring until this one is stored */
+      nstime_delta(&elapsed, &pinfo->abs_ts, &stream->times[(stream->count - window) % RBUS_EVENT_RATE_WINDOW]);
+      if (rbus_nstime_to_us(&elapsed) > 0) {
+         record->rate = (window - 1) * 1000000.0 / rbus_nstime_to_us(&elapsed);
+      }
+   }
+
+   stream->times[(stream->count - 1) % RBUS_EVENT_RATE_WINDOW] = pinfo->abs_ts;
+   stream->last_frame = pinfo->num;
+
+   p_add_proto_data(wmem_file_scope(), pinfo, proto_rbus, key, record);
+   return record;
+}
+
+/*
+ * Add the generated event statistics fields
+ */
+static void
+rbus_add_event_items(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, const rbus_event_record_t* event) {
+   proto_tree* event_tree;
+   proto_item* event_item;
+   proto_item* it;
+
+   event_item = proto_tree_add_item(tree, hf_rbus_event_stats, tvb, 0, 0, ENC_NA);
+   proto_item_set_generated(event_item);
+   event_tree = proto_item_add_subtree(event_item, ett_rbus_event_stats);
+
+   it = proto_tree_add_uint(event_tree, hf_rbus_event_publication, tvb, 0, 0, event->publication);
+   proto_item_set_generated(it);
+   if (event->subscribers == RBUS_SUBSCRIBERS_UNKNOWN) {
+      proto_item_append_text(event_item, ", subscribers unknown");
+   } else {
+      it = proto_tree_add_uint(event_tree, hf_rbus_event_subscribers, tvb, 0, 0, event->subscribers);
+      proto_item_set_generated(it);
+      if (!event->subscribers) {
+         expert_add_info_format(pinfo, it, &ei_rbus_no_subscribers, "No inbox is subscribed to %s",
+            rbus_intern_string(event->name_id));
+      }
+   }
+
+   if (!event->prev_frame) {
+      return;
+   }
+
+   it = proto_tree_add_uint(event_tree, hf_rbus_event_previous, tvb, 0, 0, event->prev_frame);
+   proto_item_set_generated(it);
+   it = proto_tree_add_time(event_tree, hf_rbus_event_interarrival, tvb, 0, 0, &event->interarrival);
+   proto_item_set_generated(it);
+   if (event->publication > 2) {
+      it = proto_tree_add_uint(event_tree, hf_rbus_event_jitter, tvb, 0, 0, event->jitter);
+      proto_item_set_generated(it);
+   }
+   if (event->rate > 0) {
+      it = proto_tree_add_double(event_tree, hf_rbus_event_rate, tvb, 0, 0, event->rate);
+      proto_item_set_generated(it);
+   }
+}
+
+/*
+ * Discovery requests and responses of one inbox still within the window
+ */
+typedef struct {
+   nstime_t time;
+   guint32 bytes;
+   gboolean request;
+} rbus_discovery_sample_t;
+
+typedef struct {
+   rbus_discovery_sample_t* samples;   /* Oldest at first, newest at count - 1 */
+   guint32 first;
+   guint32 count;
+   guint32 capacity;
+   guint32 window_requests;
+   guint32 window_bytes;
+   guint32 requests;            /* All discovery requests so far */
+   guint32 last_frame;          /* Frame of the latest request */
+   nstime_t last_time;
+} rbus_discovery_inbox_t;
+
+static wmem_map_t* rbus_discovery_inboxes = NULL;   /* Interned inbox id -> rbus_discovery_inbox_t */
+
+static void
+rbus_discovery_init(void) {
+   rbus_discovery_inboxes = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
+}
+
+static gboolean
+rbus_is_discovery(gint control_type) {
+   return control_type >= 2 && control_type <= 5;   /* QUERY through REGISTERED_COMPONENTS */
+}
+
+/* Discovery kind of a request topic, or -1; every discovery topic starts with an underscore */
+static gint
+rbus_discovery_type(const gchar* topic) {
+   gint control_type;
+
+   if (!topic || topic[0] != '_') {
+      return -1;
+   }
+   control_type = get_control_message_type(topic);
+   return rbus_is_discovery(control_type) ? control_type : -1;
+}
+
+/*
+ * Fan-out of a discovery response: its "count", else the number of "items"
+ */
+static gboolean
+rbus_discovery_fanout(tvbuff_t* tvb, guint offset, guint payload_length, guint32* fanout) {
+   const guint8* data = tvb_get_ptr(tvb, offset, payload_length);
+   guint end = payload_length;
+   guint pos = rbus_json_skip_ws(data, 0, end);
+   gboolean found = FALSE;
+
+   if (pos >= end || data[pos] != '{') {
+      return FALSE;
+   }
+   for (pos++; pos < end; ) {
+      guint key_start;
+      guint key_end;
+      guint value_end;
+
+      pos = rbus_json_skip_ws(data, pos, end);
+      if (pos >= end || data[pos] == '}') {
+         break;
+      }
+      if (data[pos] == ',') {
+         pos++;
+         continue;
+      }
+      if (data[pos] != '"') {
+         break;
+      }
+
+      key_start = pos + 1;
+      key_end = rbus_json_string_end(data, pos, end);
+      pos = rbus_json_skip_ws(data, MIN(key_end + 1, end), end);
+      if (pos >= end || data[pos] != ':') {
+         break;
+      }
+      pos = rbus_json_skip_ws(data, pos + 1, end);
+      if (pos >= end) {
+         break;
+      }
+
+      if (key_end - key_start == 5 && memcmp(data + key_start, "count", 5) == 0) {
+         gint64 value;
+         if (rbus_json_parse_int(data, pos, end, &value) > pos && value >= 0) {
+            *fanout = (guint32)MIN(value, G_MAXUINT32);
+            return TRUE;
+         }
+      } else if (key_end - key_start == 5 && memcmp(data + key_start, "items", 5) == 0 && data[pos] == '[') {
+         /* Count the elements, in case no "count" follows */
+         *fanout = 0;
+         found = TRUE;
+         for (pos++; pos < end; ) {
+            pos = rbus_json_skip_ws(data, pos, end);
+            if (pos >= end || data[pos] == ']') {
+               pos = MIN(pos + 1, end);
+               break;
+            }
+            if (data[pos] == ',') {
+               pos++;
+               continue;
+            }
+            (*fanout)++;
+            value_end = rbus_json_skip_value(data, pos, end);
+            pos = value_end > pos ? value_end : pos + 1;
+         }
+         continue;
+      }
+      value_end = rbus_json_skip_value(data, pos, end);
+      pos = value_end > pos ? value_end : pos + 1;
+   }
+   return found;
+}
+
+/*
+ * Return the discovery statistics of this request or response. Only
+ * requests count towards the rate; both count towards the bytes.
+ */
+static const rbus_discovery_record_t*
+rbus_track_discovery(packet_info* pinfo, guint32 pdu_index, guint32 inbox_id, gint control_type,
+   gboolean response, guint32 message_length, const guint32* fanout) {
+   guint32 key = RBUS_PDU_KEY(pdu_index, RBUS_PDU_DATA_DISCOVERY);
+   gint64 window_us = (gint64)MAX(pref_discovery_window, 1) * 1000000;
+   rbus_discovery_inbox_t* inbox;
+   rbus_discovery_record_t* record;
+   rbus_discovery_sample_t* sample;
+
+   if (PINFO_FD_VISITED(pinfo)) {
+      return (const rbus_discovery_record_t*)p_get_proto_data(wmem_file_scope(), pinfo, proto_rbus, key);
+   }
+
+   inbox = (rbus_discovery_inbox_t*)wmem_map_lookup(rbus_discovery_inboxes, GUINT_TO_POINTER(inbox_id));
+   if (!inbox) {
+      inbox = wmem_new0(wmem_file_scope(), rbus_discovery_inbox_t);
+      wmem_map_insert(rbus_discovery_inboxes, GUINT_TO_POINTER(inbox_id), inbox);
+   }
+
+   /* Slide the window up to this message */
+   while (inbox->first < inbox->count) {
+      nstime_t age;
+
+      sample = &inbox->samples[inbox->first];
+      nstime_delta(&age, &pinfo->abs_ts, &sample->time);
+      if (rbus_nstime_to_us(&age) < window_us) {
+         break;
+      }
+      inbox->window_bytes -= sample->bytes;
+      inbox->window_requests -= sample->request ? 1 : 0;
+      inbox->first++;
+   }
+
+   /* Reuse the space of samples that left the window before growing */
+   if (inbox->count == inbox->capacity) {
+      if (inbox->first > 0) {
+         memmove(inbox->samples, inbox->samples + inbox->first,
+            (inbox->count - inbox->first) * sizeof(rbus_discovery_sample_t));
+         inbox->count -= inbox->first;
+         inbox->first = 0;
+      } else {
+         inbox->capacity = inbox->capacity ? inbox->capacity * 2 : 16;
+         inbox->samples = (rbus_discovery_sample_t*)wmem_realloc(wmem_file_scope(), inbox->samples,
+            inbox->capacity * sizeof(rbus_discovery_sample_t));
+      }
+   }
+   sample = &inbox->samples[inbox->count++];
+   sample->time = pinfo->abs_ts;
+   sample->bytes = message_length;
+   sample->request = !response;
+   inbox->window_bytes += message_length;
+
+   record = wmem_new0(wmem_file_scope(), rbus_discovery_record_t);
+   record->inbox_id = inbox_id;
+   record->control_type = control_type;
+   record->response = response;
+   record->message_length = message_length;
+
+   if (response) {
+      if (fanout) {
+         record->fanout = *fanout;
+         record->has_fanout = TRUE;
+      }
+   } else {
+      inbox->window_requests++;
+      record->request = ++inbox->requests;
+      if (inbox->last_frame) {
+         record->prev_frame = inbox->last_frame;
+         nstime_delta(&record->interval, &pinfo->abs_ts, &inbox->last_time);
+      }
+      inbox->last_frame = pinfo->num;
+      inbox->last_time = pinfo->abs_ts;
+      record->rate = inbox->window_requests * 1000000.0 / window_us;
+   }
+   record->window_requests = inbox->window_requests;
+   record->window_bytes = inbox->window_bytes;
+
+   p_add_proto_data(wmem_file_scope(), pinfo, proto_rbus, key, record);
+   return record;
+}
+
+/*
+ * Add the generated discovery statistics fields
+ */
+static void
+rbus_add_discovery_items(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree,
+   const rbus_discovery_record_t* discovery) {
+   proto_tree* discovery_tree;
+   proto_item* it;
+
+   it = proto_tree_add_item(tree, hf_rbus_discovery, tvb, 0, 0, ENC_NA);
+   proto_item_set_generated(it);
+   discovery_tree = proto_item_add_subtree(it, ett_rbus_discovery);
+
+   it = proto_tree_add_string(discovery_tree, hf_rbus_discovery_inbox, tvb, 0, 0,
+      rbus_intern_string(discovery->inbox_id));
+   proto_item_set_generated(it);
+
+   if (discovery->response) {
+      if (discovery->has_fanout) {
+         it = proto_tree_add_uint(discovery_tree, hf_rbus_discovery_fanout, tvb, 0, 0, discovery->fanout);
+         proto_item_set_generated(it);
+      }
+      it = proto_tree_add_uint(discovery_tree, hf_rbus_discovery_window_bytes, tvb, 0, 0, discovery->window_bytes);
+      proto_item_set_generated(it);
+      return;
+   }
+
+   it = proto_tree_add_uint(discovery_tree, hf_rbus_discovery_request, tvb, 0, 0, discovery->request);
+   proto_item_set_generated(it);
+   if (discovery->prev_frame) {
+      it = proto_tree_add_uint(discovery_tree, hf_rbus_discovery_previous, tvb, 0, 0, discovery->prev_frame);
+      proto_item_set_generated(it);
+      it = proto_tree_add_time(discovery_tree, hf_rbus_discovery_interval, tvb, 0, 0, &discovery->interval);
+      proto_item_set_generated(it);
+   }
+   it = proto_tree_add_uint(discovery_tree, hf_rbus_discovery_window_bytes, tvb, 0, 0, discovery->window_bytes);
+   proto_item_set_generated(it);
+   it = proto_tree_add_double(discovery_tree, hf_rbus_discovery_rate, tvb, 0, 0, discovery->rate);
+   proto_item_set_generated(it);
+   it = proto_tree_add_uint(discovery_tree, hf_rbus_discovery_window_requests, tvb, 0, 0,
+      discovery->window_requests);
+   proto_item_set_generated(it);
+
+   if (pref_discovery_threshold && discovery->window_requests > pref_discovery_threshold) {
+      expert_add_info_format(pinfo, it, &ei_rbus_discovery_storm,
+         "%s sent %u discovery requests within %u s (threshold %u)", rbus_intern_string(discovery->inbox_id),
+         discovery->window_requests, MAX(pref_discovery_window, 1), pref_discovery_threshold);
+   }
+}
+
+/*
+ * Check whether a plausible RBus header starts at offset
+ */
+static gboolean
+rbus_looks_like_header(tvbuff_t* tvb, guint offset) {
+   guint remaining = tvb_captured_length_remaining(tvb, offset);
+
+   return rbus_wire_header_plausible(tvb_get_ptr(tvb, offset, remaining), remaining);
+}
+
+/*
+ * Return the offset of the next plausible RBus header at or after offset, or -1
+ */
+static gint
+rbus_find_header(tvbuff_t* tvb, guint offset) {
+   guint remaining = tvb_captured_length_remaining(tvb, offset);
+   long next = rbus_wire_find_header(tvb_get_ptr(tvb, offset, remaining), remaining);
+
+   return next < 0 ? -1 : (gint)(offset + next);
+}
+
+/*
+ * Return the total length of the RBus message starting at offset.
+ * Called by tcp_dissect_pdus once RBUS_FRAME_HEADER_LENGTH bytes are available.
+ */
+static unsigned
+get_rbus_message_len(packet_info* pinfo _U_, tvbuff_t* tvb, int offset, void* data _U_) {
+   /*
+    * Not at a message boundary, e.g. the capture started in the middle of a
+    * long-lived connection: everything up to the next plausible header is one
+    * unsynchronized chunk, and framing resumes at that header.
+    */
+   if (!rbus_looks_like_header(tvb, offset)) {
+      gint next = rbus_find_header(tvb, offset + 1);
+      return next > 0 ? (unsigned)(next - offset) : (unsigned)tvb_captured_length_remaining(tvb, offset);
+   }
+
+   /* Total message = header_length + payload_length */
+   return (unsigned)rbus_wire_message_length(tvb_get_ptr(tvb, offset, RBUS_FRAME_HEADER_LENGTH), RBUS_FRAME_HEADER_LENGTH);
+}
+
+/*
+ * Dissect a single, complete RBus message
+ */
+static int
+dissect_rbus_message(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void* data _U_) {
+   proto_item* rbus_item;
+   proto_item* ti;
+   proto_tree* rbus_tree;
+   proto_tree* header_tree;
+   guint offset = 0;
+   guint32 header_length;
+   guint32 payload_length;
+   guint32 topic_length;
+   guint32 reply_topic_length;
+   guint32 seq;
+   guint64 flags;
+   guint32 control_data;
+   const gchar* topic_str = NULL;
+   const gchar* reply_topic_str = NULL;
+   guint32 topic_id = 0;
+   guint32 pdu_index = rbus_next_pdu_index(pinfo);
+   rbus_method_t method = RBUS_METHOD_NONE;
+   guint32 event_name_id = 0;
+   const rbus_event_record_t* event = NULL;
+   guint32 reply_topic_id = 0;
+   guint32 sub_name_id = 0;
+   guint32 sub_inbox_id = 0;
+   gboolean sub_add = TRUE;
+   rbus_set_request_t set_req;
+   gboolean is_set_request = FALSE;
+   gint32 error_code = 0;
+   const rbus_set_transaction_t* set_txn = NULL;
+   const rbus_discovery_record_t* discovery = NULL;
+   guint payload_offset;
+   rbus_roundtrip_t roundtrip = {0};
+   rbus_wire_header_t header;
+   rbus_wire_status_t header_status;
+
+   /* Bytes skipped while resynchronizing on the next header */
+   if (!rbus_looks_like_header(tvb, 0)) {
+      col_append_sep_str(pinfo->cinfo, COL_INFO, " | ", "[Unsynchronized data]");
+      ti = proto_tree_add_item(tree, hf_rbus_unsynchronized, tvb, 0, -1, ENC_NA);
+      expert_add_info(pinfo, ti, &ei_rbus_resync);
+      return tvb_captured_length(tvb);
+   }
+
+   /* Create protocol tree */
+   rbus_item = proto_tree_add_item(tree, proto_rbus, tvb, 0, -1, ENC_NA);
+   rbus_tree = proto_item_add_subtree(rbus_item, ett_rbus);
+
+   /* Create header subtree */
+   header_tree = proto_tree_add_subtree(rbus_tree, tvb, offset, 0,
+      ett_rbus_header, &ti, "RBus Message Header");
+
+   /* Parse header fields - wire format has opening marker at offset 0 */
+   proto_tree_add_item(header_tree, hf_rbus_opening_marker, tvb, offset, 2, ENC_BIG_ENDIAN);
+   offset += 2;
+
+   proto_tree_add_item(header_tree, hf_rbus_version, tvb, offset, 2, ENC_BIG_ENDIAN);
+   offset += 2;
+
+   proto_tree_add_item_ret_uint(header_tree, hf_rbus_header_length, tvb, offset, 2,
+      ENC_BIG_ENDIAN, &header_length);
+   offset += 2;
+
+   proto_tree_add_item_ret_uint(header_tree, hf_rbus_sequence_number, tvb, offset, 4, ENC_BIG_ENDIAN, &seq);
+   offset += 4;
+
+   /* Flags field with bit breakdown */
+   static int* const flags_bits[] = {
+       &hf_rbus_flags_request,
+       &hf_rbus_flags_response,
+       &hf_rbus_flags_undeliverable,
+       &hf_rbus_flags_tainted,
+       &hf_rbus_flags_raw_binary,
+       &hf_rbus_flags_encrypted,
+       NULL
+   };
+   proto_tree_add_bitmask_ret_uint64(header_tree, tvb, offset, hf_rbus_flags,
+      ett_rbus_flags, flags_bits, ENC_BIG_ENDIAN, &flags);
+   offset += 4;
+
+   proto_tree_add_item_ret_uint(header_tree, hf_rbus_control_data, tvb, offset, 4, ENC_BIG_ENDIAN, &control_data);
+   offset += 4;
+
+   proto_tree_add_item_ret_uint(header_tree, hf_rbus_payload_length, tvb, offset, 4,
+      ENC_BIG_ENDIAN, &payload_length);
+   offset += 4;
+
+   /* Validate lengths; the topics, T1-T5 and closing marker are all within header_length */
+   header_status = rbus_wire_parse_header(tvb_get_ptr(tvb, 0, MIN(header_length, tvb_captured_length(tvb))),
+      MIN(header_length, tvb_captured_length(tvb)), &header);
+   if (header_status == RBUS_WIRE_NEED_MORE || payload_length > RBUS_MAX_PAYLOAD_SIZE) {
+      expert_add_info(pinfo, ti, &ei_rbus_invalid_length);
+      return tvb_captured_length(tvb);
+   }
+   proto_item_set_len(ti, header_length);
+
+   /* Topic and reply topic lengths that do not add up to the header length */
+   if (header_status != RBUS_WIRE_OK) {
+      proto_tree_add_item(header_tree, hf_rbus_topic_length, tvb, offset, 4, ENC_BIG_ENDIAN);
+      proto_tree_add_item(header_tree, hf_rbus_closing_marker, tvb, header_length - 2, 2, ENC_BIG_ENDIAN);
+      expert_add_info(pinfo, ti, &ei_rbus_malformed_header);
+   } else {
+      /* Topic length and string */
+      topic_length = header.topic_length;
+      proto_tree_add_item(header_tree, hf_rbus_topic_length, tvb, header.topic_offset - 4, 4, ENC_BIG_ENDIAN);
+
+      if (topic_length > 0 && topic_length < RBUS_MAX_TOPIC_LENGTH) {
+         topic_str = rbus_intern_tvb(tvb, pinfo, header.topic_offset, topic_length, &topic_id);
+         proto_tree_add_string(header_tree, hf_rbus_topic, tvb, header.topic_offset, topic_length, topic_str);
+
+         /* Build info column with message type and topic */
+         const char* msg_type = "Message";
+
+         if (flags & 0x01) {
+            /* Request flag set */
+            if (control_data == 0) {
+               msg_type = "Request";
+            } else {
+               msg_type = "Request (forwarded)";
+            }
+         } else if (flags & 0x02) {
+            /* Response flag set */
+            if (control_data == 0) {
+               msg_type = "Response";
+            } else {
+               msg_type = "Response (forwarded)";
+            }
+         }
+
+         /* Several messages can share one segment, so append rather than overwrite */
+         if (topic_str) {
+            col_append_sep_fstr(pinfo->cinfo, COL_INFO, " | ", "%s: %s", msg_type, topic_str);
+         } else {
+            col_append_sep_str(pinfo->cinfo, COL_INFO, " | ", msg_type);
+         }
+      }
+
+      /* Reply topic length and string */
+      reply_topic_length = header.reply_topic_length;
+      proto_tree_add_item(header_tree, hf_rbus_reply_topic_length, tvb, header.reply_topic_offset - 4, 4,
+         ENC_BIG_ENDIAN);
+
+      if (reply_topic_length > 0 && reply_topic_length < RBUS_MAX_TOPIC_LENGTH) {
+         reply_topic_str = rbus_intern_tvb(tvb, pinfo, header.reply_topic_offset, reply_topic_length,
+            &reply_topic_id);
+         proto_tree_add_string(header_tree, hf_rbus_reply_topic, tvb, header.reply_topic_offset,
+            reply_topic_length, reply_topic_str);
+      }
+
+      /* Optional MSG_ROUNDTRIP_TIME fields (T1-T5) between the reply topic and the closing marker */
+      if (header.has_roundtrip) {
+         guint roundtrip_offset = header.reply_topic_offset + reply_topic_length;
+
+         proto_tree_add_uint(header_tree, hf_rbus_roundtrip_t1, tvb, roundtrip_offset, 4, header.roundtrip[0]);
+         proto_tree_add_uint(header_tree, hf_rbus_roundtrip_t2, tvb, roundtrip_offset + 4, 4, header.roundtrip[1]);
+         proto_tree_add_uint(header_tree, hf_rbus_roundtrip_t3, tvb, roundtrip_offset + 8, 4, header.roundtrip[2]);
+         proto_tree_add_uint(header_tree, hf_rbus_roundtrip_t4, tvb, roundtrip_offset + 12, 4, header.roundtrip[3]);
+         proto_tree_add_uint(header_tree, hf_rbus_roundtrip_t5, tvb, roundtrip_offset + 16, 4, header.roundtrip[4]);
+
+         /* Per-hop latency breakdown */
+         rbus_add_roundtrip_hops(tvb, pinfo, header_tree, roundtrip_offset, header.roundtrip, &roundtrip);
+      }
+
+      /* Closing marker (0xAAAA), checked by rbus_wire_parse_header */
+      proto_tree_add_item(header_tree, hf_rbus_closing_marker, tvb, header_length - 2, 2, ENC_BIG_ENDIAN);
+   }
+
+   /* The payload follows the header, wherever the parse above stopped */
+   payload_offset = header_length;
+   offset = payload_offset;
+
+   /* Payload - decode MessagePack */
+   if (payload_length > 0) {
+      /* Verify we have enough data in the TVB for the payload */
+      guint remaining = tvb_captured_length_remaining(tvb, offset);
+      guint actual_payload_length = payload_length;
+
+      if (remaining < payload_length) {
+         /* This shouldn't happen after desegmentation, but handle it gracefully */
+         expert_add_info(pinfo, ti, &ei_rbus_truncated_packet);
+         actual_payload_length = remaining;
+      }
+
+      if (actual_payload_length > 0) {
+         proto_tree* payload_tree;
+         proto_item* payload_item;
+
+         /* Only try to add the item with the length we actually have */
+         payload_item = proto_tree_add_item(rbus_tree, hf_rbus_payload, tvb, offset,
+            actual_payload_length, ENC_NA);
+         payload_tree = proto_item_add_subtree(payload_item, ett_rbus_payload);
+
+         /* Check if payload is JSON (starts with '{' or '[') */
+         guint8 first_byte = tvb_get_uint8(tvb, offset);
+         if ((first_byte == '{' || first_byte == '[') && actual_payload_length > 1) {
+            /* This is likely JSON - check if it's a control message */
+            gint control_type = get_control_message_type(topic_str);
+            
+            if (control_type >= 0) {
+               /* Parse as control message with structured fields */
+               if (tree) {
+                  parse_control_message(tvb, pinfo, payload_tree, offset, actual_payload_length, control_type);
+                  proto_item_append_text(payload_item, " [Control Message - JSON]");
+               }
+               col_append_str(pinfo->cinfo, COL_INFO, " (Control)");
+
+               /* Router subscriptions route the topic to the requester's inbox */
+               if (control_type == 0 && reply_topic_id &&
+                  rbus_subscription_from_control(tvb, pinfo, offset, actual_payload_length, &sub_add, &sub_name_id)) {
+                  sub_inbox_id = reply_topic_id;
+               }
+            } else if (tree) {
+               /* Regular JSON payload - display as string */
+               const guint8* json_data = tvb_get_ptr(tvb, offset, actual_payload_length);
+               gchar* json_str = (gchar*)wmem_alloc(pinfo->pool, actual_payload_length + 1);
+               memcpy(json_str, json_data, actual_payload_length);
+               json_str[actual_payload_length] = '\0';
+
+               proto_tree_add_bytes_format_value(payload_tree, hf_rbus_payload, tvb, offset,
+                  actual_payload_length, NULL, "%s", json_str);
+               proto_item_append_text(payload_item, " [JSON]");
+            }
+         } else {
+            /* Summarized once; a pass that needs more than the summary decodes into pinfo->pool */
+            rbus_msgpack_cursor_t* cursor;
+            const rbus_payload_summary_t* summary = rbus_get_payload_summary(tvb, pinfo, pdu_index,
+               offset, actual_payload_length, &cursor);
+            if (!cursor && tree && summary->kind != RBUS_PAYLOAD_METHOD) {
+               cursor = rbus_new_payload_cursor(tvb, pinfo, offset, actual_payload_length);
+            }
+
+            /* Try structured RBus message parsing first */
+            guint consumed = parse_rbus_payload(tvb, pinfo, payload_tree, summary, cursor, actual_payload_length);
+            method = summary->method;
+            event_name_id = summary->event_name_id;
+
+            if ((method == RBUS_METHOD_SUBSCRIBE || method == RBUS_METHOD_UNSUBSCRIBE) &&
+               (flags & RTMSG_FLAG_REQUEST) &&
+               rbus_subscription_from_payload(summary, &sub_name_id, &sub_inbox_id)) {
+               sub_add = method == RBUS_METHOD_SUBSCRIBE;
+            }
+
+            if (method == RBUS_METHOD_SETPARAMETERVALUES || method == RBUS_METHOD_COMMIT) {
+               /* rtrouted's copy to the provider carries control data; only the client's leg counts */
+               is_set_request = (flags & RTMSG_FLAG_REQUEST) && control_data == 0 &&
+                  rbus_set_request_from_payload(summary, &set_req);
+            } else if (method == RBUS_METHOD_RESPONSE) {
+               error_code = summary->error_code;
+            }
+
+            if (consumed == 0 && tree) {
+               /* Fall back to generic MessagePack rendering of the objects decoded so far and the rest */
+               guint end_offset = offset + actual_payload_length;
+               guint32 object_count = 0;
+
+               /* Initialize parsing context to track meta information fields */
+               rbus_parse_context_t parse_ctx = {0, FALSE, 0, RBUS_METHOD_NONE, 0, 0};
+
+               while (rbus_cursor_has(cursor, object_count)) {
+                  parse_ctx.object_index = object_count;
+                  display_msgpack_object(payload_tree, tvb, pinfo, cursor, rbus_cursor_top(cursor, object_count),
+                     0, NULL, &parse_ctx);
+                  object_count++;
+               }
+
+               if (cursor->limit_reached) {
+                  proto_tree_add_expert_format(payload_tree, pinfo, &ei_rbus_msgpack_depth_exceeded, tvb,
+                     cursor->parse_offset, end_offset - cursor->parse_offset,
+                     "MessagePack object limit (%u) reached; remaining %u bytes not decoded",
+                     pref_msgpack_object_limit, end_offset - cursor->parse_offset);
+               } else if (cursor->nodes_exhausted) {
+                  proto_tree_add_expert_format(payload_tree, pinfo, &ei_rbus_msgpack_depth_exceeded, tvb,
+                     cursor->parse_offset, end_offset - cursor->parse_offset,
+                     "MessagePack node limit (%u) reached; remaining %u bytes not decoded",
+                     RBUS_IR_MAX_NODES, end_offset - cursor->parse_offset);
+               } else if (cursor->parse_offset < end_offset) {
+                  /* Failed to decode, show remaining as raw */
+                  proto_tree_add_item(payload_tree, hf_rbus_payload, tvb,
+                     cursor->parse_offset, end_offset - cursor->parse_offset, ENC_NA);
+               }
+
+               if (object_count > 0) {
+                  proto_item_append_text(payload_item, " [%u MessagePack object%s]",
+                     object_count, object_count == 1 ? "" : "s");
+               } else {
+                  proto_item_append_text(payload_item, " [Not valid MessagePack]");
+               }
+            } else if (consumed > 0) {
+               proto_item_append_text(payload_item, " [Structured RBus Message]");
+            }
+         }
+
+         offset += payload_length;
+      }
+   }
+
+   /* Link requests and responses */
+   rbus_transaction_t* trans = rbus_match_transaction(pinfo, pdu_index, seq, flags, method, topic_id);
+   if (trans) {
+      rbus_add_transaction_items(tvb, pinfo, rbus_tree, rbus_item, seq, trans);
+   } else if (flags & RTMSG_FLAG_RESPONSE) {
+      expert_add_info_format(pinfo, rbus_item, &ei_rbus_unmatched_response,
+         "No request with sequence number %u awaits a response", seq);
+   }
+
+   /* Group SETs, their commit and the responses into SET transactions */
+   if (is_set_request || method == RBUS_METHOD_RESPONSE) {
+      set_txn = rbus_track_set_transaction(pinfo, pdu_index, trans, is_set_request ? &set_req : NULL, error_code);
+      if (set_txn) {
+         rbus_add_set_transaction_items(tvb, pinfo, rbus_tree, set_txn);
+      }
+   }
+
+   /* Subscription table, and the subscribers each publication reaches */
+   if (sub_name_id && sub_inbox_id) {
+      const rbus_subscription_record_t* sub = rbus_track_subscription(pinfo, pdu_index, sub_name_id, sub_inbox_id,
+         sub_add);
+      if (sub) {
+         rbus_add_subscription_items(tvb, rbus_tree, sub);
+      }
+   }
+
+   /* Per event name publication statistics */
+   if (event_name_id && !(flags & (RTMSG_FLAG_REQUEST | RTMSG_FLAG_RESPONSE))) {
+      event = rbus_track_event(pinfo, pdu_index, event_name_id, payload_length);
+      if (event) {
+         rbus_add_event_items(tvb, pinfo, rbus_tree, event);
+      }
+   }
+
+   /* Discovery traffic per requesting inbox; the response goes back to that inbox */
+   if ((flags & RTMSG_FLAG_REQUEST) && reply_topic_id) {
+      gint discovery_type = rbus_discovery_type(topic_str);
+
+      if (discovery_type >= 0) {
+         discovery = rbus_track_discovery(pinfo, pdu_index, reply_topic_id, discovery_type, FALSE, offset, NULL);
+      }
+   } else if ((flags & RTMSG_FLAG_RESPONSE) && trans && topic_id) {
+      gint discovery_type = rbus_discovery_type(rbus_intern_string(trans->topic_id));
+
+      if (discovery_type >= 0) {
+         guint fanout_length = MIN(payload_length, (guint)tvb_captured_length_remaining(tvb, payload_offset));
+         guint32 fanout = 0;
+         gboolean has_fanout = fanout_length > 0 &&
+            rbus_discovery_fanout(tvb, payload_offset, fanout_length, &fanout);
+
+         discovery = rbus_track_discovery(pinfo, pdu_index, topic_id, discovery_type, TRUE, offset,
+            has_fanout ? &fanout : NULL);
+      }
+   }
+   if (discovery) {
+      rbus_add_discovery_items(tvb, pinfo, rbus_tree, discovery);
+   }
+
+   if (have_tap_listener(rbus_tap)) {
+      rbus_tap_info_t* tap_info = wmem_new0(pinfo->pool, rbus_tap_info_t);
+
+      tap_info->seq = seq;
+      tap_info->flags = flags;
+      tap_info->method = method;
+      tap_info->topic = topic_str;
+      tap_info->topic_id = topic_id;
+      tap_info->message_length = offset;
+      tap_info->trans = trans;
+      tap_info->roundtrip = roundtrip;
+      tap_info->event = event;
+      tap_info->discovery = discovery;
+      if (set_txn && set_txn->complete_frame == pinfo->num && set_txn->complete_pdu == pdu_index) {
+         tap_info->set_txn = set_txn;
+      }
+      tap_queue_packet(rbus_tap, pinfo, tap_info);
+   }
+
+   return offset;
+}
+
+/*
+ * Dissect the RBus protocol over a TCP stream.
+ * tcp_dissect_pdus handles reassembly and walks every back-to-back message in the segment.
+ */
+static int
+dissect_rbus(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void* data) {
+   /* Set protocol column */
+   col_set_str(pinfo->cinfo, COL_PROTOCOL, RBUS_PROTOCOL_SHORT_NAME);
+   col_clear(pinfo->cinfo, COL_INFO);
+
+   tcp_dissect_pdus(tvb, pinfo, tree, pref_desegment, RBUS_FRAME_HEADER_LENGTH,
+      get_rbus_message_len, dissect_rbus_message, data);
+
+   return tvb_captured_length(tvb);
+}
+
+/* Bytes without a plausible header, more than the largest message, before a stream is no longer RBus */
+#define RBUS_HEUR_MAX_MISS_BYTES (RBUS_MAX_PAYLOAD_SIZE + RBUS_WIRE_MAX_HEADER_LENGTH)
+
+/*
+ * Heuristic dissector to auto-detect RBus protocol. The verdict is pinned to
+ * the conversation: an RBus stream gets rbus as its conversation dissector, so
+ * TCP hands it later segments directly, and a stream that goes longer than
+ * the largest message without a plausible header is rejected without looking
+ * at its data again.
+ */
+static bool
+dissect_rbus_heur(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void* data) {
+   conversation_t* conversation = find_or_create_conversation(pinfo);
+   rbus_conv_info_t* conv_info = (rbus_conv_info_t*)conversation_get_proto_data(conversation, proto_rbus);
+
+   if (conv_info && conv_info->heur_rejected) {
+      return false;
+   }
+
+   /*
+    * A capture that starts mid-stream, or a segment that begins with the tail
+    * of an earlier message, has its first header further in; framing skips the
+    * bytes before it.
+    */
+   if (!rbus_looks_like_header(tvb, 0)) {
+      gint next = rbus_find_header(tvb, 1);
+
+      if (next < 0 || !rbus_looks_like_header(tvb, next)) {
+         /* One long payload can span many segments; only give up once it could not be one */
+         if (!PINFO_FD_VISITED(pinfo)) {
+            conv_info = rbus_get_conv_info(pinfo);
+            conv_info->heur_miss_bytes += tvb_captured_length(tvb);
+            if (conv_info->heur_miss_bytes > RBUS_HEUR_MAX_MISS_BYTES) {
+               conv_info->heur_rejected = TRUE;
+            }
+         }
+         return false;
+      }
+   }
+
+   /* Looks like RBus: pin the stream from this frame on, then dissect it */
+   if (conv_info) {
+      conv_info->heur_miss_bytes = 0;
+   }
+   conversation_set_dissector_from_frame_number(conversation, pinfo->num, rbus_handle);
+   dissect_rbus(tvb, pinfo, tree, data);
+   return true;
+}
+
+/*
+ * Service response time statistics (-z srt,rbus). Responses are counted
+ * against the method and topic of the request they answer.
+ */
+#define RBUS_SRT_TABLE_METHOD 0
+#define RBUS_SRT_TABLE_TOPIC 1
+#define RBUS_SRT_TOPIC_COMPONENTS 2   /* Topic prefix depth, e.g. "Device.WiFi" */
+#define RBUS_SRT_MAX_TOPIC_ROWS 256   /* Further prefixes are counted under "Other" */
+
+static void
+rbus_srt_init(struct register_srt* srt _U_, GArray* srt_array) {
+   srt_stat_table* method_table;
+   int i;
+
+   /* Rows are numbered by rbus_method_t, so a row filters as rbus.method_id==<row> */
+   method_table = init_srt_table("RBus Methods", "Methods", srt_array, RBUS_METHOD_COUNT,
+      "Method", "rbus.method_id", NULL);
+   for (i = 0; i < RBUS_METHOD_COUNT; i++) {
+      init_srt_table_row(method_table, i, try_val_to_str(i, rbus_method_vals));
+   }
+
+   /* Topic prefixes are not known up front; rows are added as they are seen. Their
+    * numbers mean nothing to rbus.header.topic, so the table has no filter. */
+   init_srt_table("RBus Topic Prefixes", "Topics", srt_array, 0,
+      "Topic Prefix", NULL, NULL);
+}
+
+/*
+ * Return the row of the topic table for the prefix of topic, adding it if new
+ */
+static int
+rbus_srt_topic_row(srt_stat_table* table, const gchar* topic) {
+   gchar prefix[RBUS_MAX_TOPIC_LENGTH];
+   const gchar* name = "Unknown";
+   int i;
+
+   if (topic && *topic) {
+      const gchar* end = topic;
+      guint components = 0;
+
+      while (*end) {
+         if (*end == '.' && ++components == RBUS_SRT_TOPIC_COMPONENTS) {
+            break;
+         }
+         end++;
+      }
+      g_strlcpy(prefix, topic, MIN((gsize)(end - topic) + 1, sizeof(prefix)));
+      name = prefix;
+   }
+
+   for (i = 0; i < table->num_procs; i++) {
+      if (strcmp(table->procedures[i].procedure, name) == 0) {
+         return i;
+      }
    }
 
-   /* Read header_length to calculate total message size */
-   guint16 header_len = tvb_get_ntohs(tvb, 4);
-
-   /* Total message = header_length + payload_length
-    * We need to read up to the payload_length field (offset 18) to calculate total */
-   if (available < 22) {
-      pinfo->desegment_offset = 0;
-      pinfo->desegment_len = DESEGMENT_ONE_MORE_SEGMENT;
-      return -((gint)available);
+   if (table->num_procs >= RBUS_SRT_MAX_TOPIC_ROWS) {
+      name = "Other";
+      for (i = RBUS_SRT_MAX_TOPIC_ROWS; i < table->num_procs; i++) {
+         if (strcmp(table->procedures[i].procedure, name) == 0) {
+            return i;
+         }
+      }
    }
 
-   /* Read payload_length - offset 18 after marker(2) + version(2) + header_len(2) + seq(4) + flags(4) + control(4) */
-   guint32 payload_len = tvb_get_ntohl(tvb, 18);
+   i = table->num_procs;
+   init_srt_table_row(table, i, name);
+   return i;
+}
 
-   /* Calculate total message length: header_length + payload_length */
-   guint32 total_len = header_len + payload_len;
+static tap_packet_status
+rbus_srt_packet(void* pss, packet_info* pinfo, epan_dissect_t* edt _U_, const void* prv, tap_flags_t flags _U_) {
+   srt_data_t* data = (srt_data_t*)pss;
+   const rbus_tap_info_t* tap_info = (const rbus_tap_info_t*)prv;
+   const rbus_transaction_t* trans = tap_info->trans;
+   srt_stat_table* table;
 
-   /* Check if we have the complete message */
-   if (available < total_len) {
-      /* Need more data - request exactly what we need */
-      pinfo->desegment_offset = 0;
-      pinfo->desegment_len = total_len - available;
-      return -((gint)available);
+   /* Only responses with a matching request carry a response time */
+   if (!trans || trans->req_frame == pinfo->num) {
+      return TAP_PACKET_DONT_REDRAW;
    }
 
-   /* Set protocol column */
-   col_set_str(pinfo->cinfo, COL_PROTOCOL, RBUS_PROTOCOL_SHORT_NAME);
-   col_clear(pinfo->cinfo, COL_INFO);
-
-   /* Create protocol tree */
-   ti = proto_tree_add_item(tree, proto_rbus, tvb, 0, -1, ENC_NA);
-   rbus_tree = proto_item_add_subtree(ti, ett_rbus);
+   table = g_array_index(data->srt_array, srt_stat_table*, RBUS_SRT_TABLE_METHOD);
+   add_srt_table_data(table, trans->method, &trans->req_time, pinfo);
 
-   /* Create header subtree */
-   header_tree = proto_tree_add_subtree(rbus_tree, tvb, offset, 0,
-      ett_rbus_header, &ti, "RBus Message Header");
+   table = g_array_index(data->srt_array, srt_stat_table*, RBUS_SRT_TABLE_TOPIC);
+   add_srt_table_data(table, rbus_srt_topic_row(table, rbus_intern_string(trans->topic_id)), &trans->req_time, pinfo);
 
-   /* Parse header fields - wire format has opening marker at offset 0 */
-   proto_tree_add_item(header_tree, hf_rbus_opening_marker, tvb, offset, 2, ENC_BIG_ENDIAN);
-   offset += 2;
+   return TAP_PACKET_REDRAW;
+}
 
-   proto_tree_add_item(header_tree, hf_rbus_version, tvb, offset, 2, ENC_BIG_ENDIAN);
-   offset += 2;
+/*
+ * Hop latency statistics (-z rbus,hops): average, min and max of each hop
+ * per topic. Responses are filed under the topic of their request.
+ */
+static const char* st_str_rbus_hops = "Hop Latency by Topic (s)";
+static int st_node_rbus_hops = -1;
 
-   proto_tree_add_item_ret_uint(header_tree, hf_rbus_header_length, tvb, offset, 2,
-      ENC_BIG_ENDIAN, &header_length);
-   offset += 2;
+static void
+rbus_hops_stats_tree_init(stats_tree* st) {
+   st_node_rbus_hops = stats_tree_create_node(st, st_str_rbus_hops, 0, STAT_DT_INT, TRUE);
+}
 
-   proto_tree_add_item(header_tree, hf_rbus_sequence_number, tvb, offset, 4, ENC_BIG_ENDIAN);
-   offset += 4;
+static tap_packet_status
+rbus_hops_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p,
+   tap_flags_t flags _U_) {
+   const rbus_tap_info_t* tap_info = (const rbus_tap_info_t*)p;
+   const gchar* topic = tap_info->topic;
+   int topic_node;
+   int hop;
 
-   /* Flags field with bit breakdown */
-   static int* const flags_bits[] = {
-       &hf_rbus_flags_request,
-       &hf_rbus_flags_response,
-       &hf_rbus_flags_undeliverable,
-       &hf_rbus_flags_tainted,
-       &hf_rbus_flags_raw_binary,
-       &hf_rbus_flags_encrypted,
-       NULL
-   };
-   proto_tree_add_bitmask_ret_uint64(header_tree, tvb, offset, hf_rbus_flags,
-      ett_rbus_flags, flags_bits, ENC_BIG_ENDIAN, &flags);
-   offset += 4;
+   if (!tap_info->roundtrip.valid) {
+      return TAP_PACKET_DONT_REDRAW;
+   }
 
-   proto_tree_add_item_ret_uint(header_tree, hf_rbus_control_data, tvb, offset, 4, ENC_BIG_ENDIAN, &control_data);
-   offset += 4;
+   if (tap_info->trans && tap_info->trans->topic_id) {
+      topic = rbus_intern_string(tap_info->trans->topic_id);
+   }
 
-   proto_tree_add_item_ret_uint(header_tree, hf_rbus_payload_length, tvb, offset, 4,
-      ENC_BIG_ENDIAN, &payload_length);
-   offset += 4;
+   tick_stat_node(st, st_str_rbus_hops, 0, TRUE);
+   topic_node = tick_stat_node(st, topic ? topic : "Unknown", st_node_rbus_hops, TRUE);
 
-   /* Validate lengths */
-   if (header_length > tvb_captured_length(tvb) ||
-      payload_length > RBUS_MAX_PAYLOAD_SIZE) {
-      expert_add_info(pinfo, ti, &ei_rbus_invalid_length);
-      return tvb_captured_length(tvb);
+   for (hop = 0; hop < RBUS_HOP_COUNT; hop++) {
+      if (tap_info->roundtrip.valid & (1 << hop)) {
+         avg_stat_node_add_value_int(st, rbus_hop_names[hop], topic_node, FALSE,
+            tap_info->roundtrip.delta[hop]);
+      }
    }
 
-   /* Topic length and string */
-   proto_tree_add_item_ret_uint(header_tree, hf_rbus_topic_length, tvb, offset, 4,
-      ENC_BIG_ENDIAN, &topic_length);
-   offset += 4;
+   return TAP_PACKET_REDRAW;
+}
 
-   if (topic_length > 0 && topic_length < RBUS_MAX_TOPIC_LENGTH) {
-      proto_tree_add_item_ret_string(header_tree, hf_rbus_topic, tvb, offset,
-         topic_length, ENC_UTF_8 | ENC_NA,
-         pinfo->pool, &topic_str);
-      offset += topic_length;
+/*
+ * Topic hierarchy statistics (-z rbus,tree): messages and bytes per dotted
+ * topic component, split into requests, responses and events. Responses are
+ * filed under the topic of their request.
+ *
+ * Topics are split once into a prefix tree whose nodes are keyed by their
+ * full prefix ("Device", "Device.WiFi", ...), so a packet costs one lookup of
+ * its topic and a walk up the parents; no per-packet string splitting.
+ */
+#define RBUS_ST_TOPIC_MAX_DEPTH 32    /* Deeper components stay in the last level */
+
+typedef enum {
+   RBUS_ST_KIND_REQUEST,
+   RBUS_ST_KIND_RESPONSE,
+   RBUS_ST_KIND_EVENT,
+   RBUS_ST_KIND_COUNT
+} rbus_st_kind_t;
+
+static const char* const rbus_st_kind_names[RBUS_ST_KIND_COUNT] = {
+   [RBUS_ST_KIND_REQUEST] = "Requests",
+   [RBUS_ST_KIND_RESPONSE] = "Responses",
+   [RBUS_ST_KIND_EVENT] = "Events",
+};
 
-      /* Build info column with message type and topic */
-      const char* msg_type = "Message";
+typedef struct _rbus_topic_node_t {
+   struct _rbus_topic_node_t* parent;
+   const gchar* name;                   /* Last component, points into the prefix key */
+   guint depth;
+} rbus_topic_node_t;
 
-      if (flags & 0x01) {
-         /* Request flag set */
-         if (control_data == 0) {
-            msg_type = "Request";
-         } else {
-            msg_type = "Request (forwarded)";
-         }
-      } else if (flags & 0x02) {
-         /* Response flag set */
-         if (control_data == 0) {
-            msg_type = "Response";
-         } else {
-            msg_type = "Response (forwarded)";
-         }
-      }
+static const char* st_str_rbus_messages = "Messages by Topic";
+static const char* st_str_rbus_bytes = "Bytes by Topic";
+static int st_node_rbus_messages = -1;
+static int st_node_rbus_bytes = -1;
 
-      if (topic_str) {
-         col_add_fstr(pinfo->cinfo, COL_INFO, "%s: %s", msg_type, topic_str);
-      } else {
-         col_add_str(pinfo->cinfo, COL_INFO, msg_type);
+/* Several rbus,tree instances can be open at once; each has its own prefix tree */
+static GHashTable* rbus_topic_tries = NULL;  /* stats_tree -> GHashTable of prefix -> rbus_topic_node_t */
+
+/*
+ * Return the prefix tree node for topic[0..length), inserting it and any
+ * missing ancestors. Only used on a miss; known topics are a single lookup.
+ */
+static rbus_topic_node_t*
+rbus_topic_trie_insert(GHashTable* trie, const gchar* topic, gsize length) {
+   gchar* key = g_strndup(topic, length);
+   rbus_topic_node_t* node = (rbus_topic_node_t*)g_hash_table_lookup(trie, key);
+   const gchar* sep = NULL;
+   const gchar* p;
+   guint dots = 0;
+
+   if (node) {
+      g_free(key);
+      return node;
+   }
+
+   /* The parent prefix ends at the last separator, or at the one closing the deepest level */
+   for (p = key; p < key + length; p++) {
+      if (*p == '.' && dots++ < RBUS_ST_TOPIC_MAX_DEPTH - 1) {
+         sep = p;
       }
    }
 
-   /* Reply topic length and string */
-   proto_tree_add_item_ret_uint(header_tree, hf_rbus_reply_topic_length, tvb, offset, 4,
-      ENC_BIG_ENDIAN, &reply_topic_length);
-   offset += 4;
+   node = g_new0(rbus_topic_node_t, 1);
+   node->name = key;
+   if (sep) {
+      node->parent = rbus_topic_trie_insert(trie, key, sep - key);
+      node->name = sep + 1;
+      node->depth = node->parent->depth + 1;
+   }
 
-   if (reply_topic_length > 0 && reply_topic_length < RBUS_MAX_TOPIC_LENGTH) {
-      proto_tree_add_item_ret_string(header_tree, hf_rbus_reply_topic, tvb, offset,
-         reply_topic_length, ENC_UTF_8 | ENC_NA,
-         pinfo->pool, &reply_topic_str);
-      offset += reply_topic_length;
+   g_hash_table_insert(trie, key, node);
+   return node;
+}
+
+static void
+rbus_topics_stats_tree_init(stats_tree* st) {
+   int kind;
+
+   st_node_rbus_messages = stats_tree_create_node(st, st_str_rbus_messages, 0, STAT_DT_INT, TRUE);
+   st_node_rbus_bytes = stats_tree_create_node(st, st_str_rbus_bytes, 0, STAT_DT_INT, TRUE);
+   for (kind = 0; kind < RBUS_ST_KIND_COUNT; kind++) {
+      stats_tree_create_node(st, rbus_st_kind_names[kind], st_node_rbus_messages, STAT_DT_INT, TRUE);
+      stats_tree_create_node(st, rbus_st_kind_names[kind], st_node_rbus_bytes, STAT_DT_INT, TRUE);
    }
 
-   /* Optional MSG_ROUNDTRIP_TIME fields - check if there's room for timestamps + closing marker */
-   guint remaining_header = tvb_captured_length_remaining(tvb, offset);
+   if (!rbus_topic_tries) {
+      rbus_topic_tries = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+         (GDestroyNotify)g_hash_table_destroy);
+   }
+   g_hash_table_insert(rbus_topic_tries, st, g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free));
+}
 
-   /* If there are 22+ bytes remaining (20 for timestamps + 2 for closing marker), check for roundtrip */
-   if (remaining_header >= 22) {
-      /* Peek ahead to see if closing marker is at offset+20 (after 5 timestamps) */
-      guint16 potential_marker = tvb_get_ntohs(tvb, offset + 20);
-      if (potential_marker == 0xAAAA) {
-         /* Parse the 5 roundtrip timestamp fields (T1-T5) */
-         proto_tree_add_item(header_tree, hf_rbus_roundtrip_t1, tvb, offset, 4, ENC_BIG_ENDIAN);
-         offset += 4;
-         proto_tree_add_item(header_tree, hf_rbus_roundtrip_t2, tvb, offset, 4, ENC_BIG_ENDIAN);
-         offset += 4;
-         proto_tree_add_item(header_tree, hf_rbus_roundtrip_t3, tvb, offset, 4, ENC_BIG_ENDIAN);
-         offset += 4;
-         proto_tree_add_item(header_tree, hf_rbus_roundtrip_t4, tvb, offset, 4, ENC_BIG_ENDIAN);
-         offset += 4;
-         proto_tree_add_item(header_tree, hf_rbus_roundtrip_t5, tvb, offset, 4, ENC_BIG_ENDIAN);
-         offset += 4;
+static void
+rbus_topics_stats_tree_cleanup(stats_tree* st) {
+   if (rbus_topic_tries) {
+      g_hash_table_remove(rbus_topic_tries, st);
+      if (g_hash_table_size(rbus_topic_tries) == 0) {
+         g_hash_table_destroy(rbus_topic_tries);
+         rbus_topic_tries = NULL;
       }
    }
+}
 
-   /* Closing marker (0xAAAA) - always present after reply_topic (or after roundtrip fields if present) */
-   if (remaining_header >= 2) {
-      guint16 closing_marker = tvb_get_ntohs(tvb, offset);
-      proto_tree_add_item(header_tree, hf_rbus_closing_marker, tvb, offset, 2, ENC_BIG_ENDIAN);
-      offset += 2;
-
-      if (closing_marker != 0xAAAA) {
-         expert_add_info(pinfo, ti, &ei_rbus_malformed_header);
+static tap_packet_status
+rbus_topics_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p,
+   tap_flags_t flags _U_) {
+   const rbus_tap_info_t* tap_info = (const rbus_tap_info_t*)p;
+   const rbus_topic_node_t* path[RBUS_ST_TOPIC_MAX_DEPTH];
+   const rbus_topic_node_t* node;
+   const gchar* topic = tap_info->topic;
+   const gchar* kind_name;
+   GHashTable* trie = (GHashTable*)g_hash_table_lookup(rbus_topic_tries, st);
+   int messages_node;
+   int bytes_node;
+   guint depth;
+   guint i;
+
+   if (tap_info->flags & RTMSG_FLAG_REQUEST) {
+      kind_name = rbus_st_kind_names[RBUS_ST_KIND_REQUEST];
+   } else if (tap_info->flags & RTMSG_FLAG_RESPONSE) {
+      kind_name = rbus_st_kind_names[RBUS_ST_KIND_RESPONSE];
+      if (tap_info->trans && tap_info->trans->topic_id) {
+         topic = rbus_intern_string(tap_info->trans->topic_id);
       }
+   } else {
+      kind_name = rbus_st_kind_names[RBUS_ST_KIND_EVENT];
    }
 
-   /* Update header tree length */
-   proto_item_set_len(ti, offset);
+   if (!topic || !*topic) {
+      topic = "Unknown";
+   }
 
-   /* Payload - decode MessagePack */
-   if (payload_length > 0) {
-      /* Verify we have enough data in the TVB for the payload */
-      guint remaining = tvb_captured_length_remaining(tvb, offset);
-      guint actual_payload_length = payload_length;
+   node = (const rbus_topic_node_t*)g_hash_table_lookup(trie, topic);
+   if (!node) {
+      node = rbus_topic_trie_insert(trie, topic, strlen(topic));
+   }
 
-      if (remaining < payload_length) {
-         /* This shouldn't happen after desegmentation, but handle it gracefully */
-         expert_add_info(pinfo, ti, &ei_rbus_truncated_packet);
-         actual_payload_length = remaining;
-      }
+   depth = node->depth + 1;
+   for (; node; node = node->parent) {
+      path[node->depth] = node;
+   }
 
-      if (actual_payload_length > 0) {
-         proto_tree* payload_tree;
-         proto_item* payload_item;
+   avg_stat_node_add_value_int(st, st_str_rbus_messages, 0, TRUE, tap_info->message_length);
+   messages_node = avg_stat_node_add_value_int(st, kind_name, st_node_rbus_messages, TRUE,
+      tap_info->message_length);
+   increase_stat_node(st, st_str_rbus_bytes, 0, TRUE, tap_info->message_length);
+   bytes_node = increase_stat_node(st, kind_name, st_node_rbus_bytes, TRUE, tap_info->message_length);
 
-         /* Only try to add the item with the length we actually have */
-         payload_item = proto_tree_add_item(rbus_tree, hf_rbus_payload, tvb, offset,
-            actual_payload_length, ENC_NA);
-         payload_tree = proto_item_add_subtree(payload_item, ett_rbus_payload);
+   for (i = 0; i < depth; i++) {
+      messages_node = avg_stat_node_add_value_int(st, path[i]->name, messages_node, TRUE,
+         tap_info->message_length);
+      bytes_node = increase_stat_node(st, path[i]->name, bytes_node, TRUE, tap_info->message_length);
+   }
 
-         /* Check if payload is JSON (starts with '{' or '[') */
-         guint8 first_byte = tvb_get_uint8(tvb, offset);
-         if ((first_byte == '{' || first_byte == '[') && actual_payload_length > 1) {
-            /* This is likely JSON - check if it's a control message */
-            gint control_type = get_control_message_type(topic_str);
-            
-            if (control_type >= 0) {
-               /* Parse as control message with structured fields */
-               parse_control_message(tvb, pinfo, payload_tree, offset, actual_payload_length, control_type);
-               proto_item_append_text(payload_item, " [Control Message - JSON]");
-               col_append_str(pinfo->cinfo, COL_INFO, " (Control)");
-            } else {
-               /* Regular JSON payload - display as string */
-               const guint8* json_data = tvb_get_ptr(tvb, offset, actual_payload_length);
-               gchar* json_str = (gchar*)wmem_alloc(pinfo->pool, actual_payload_length + 1);
-               memcpy(json_str, json_data, actual_payload_length);
-               json_str[actual_payload_length] = '\0';
+   return TAP_PACKET_REDRAW;
+}
 
-               proto_tree_add_bytes_format_value(payload_tree, hf_rbus_payload, tvb, offset,
-                  actual_payload_length, NULL, "%s", json_str);
-               proto_item_append_text(payload_item, " [JSON]");
-            }
-         } else {
-            /* Try structured RBus message parsing first */
-            guint consumed = parse_rbus_payload(tvb, pinfo, payload_tree, offset, actual_payload_length);
+/*
+ * Event publication statistics (-z rbus,events): per event name, the number
+ * of publications with their rate and burst rate, payload size and total
+ * payload bytes. Every copy rtrouted forwards is counted; under each name the
+ * copies are split by connection, given by its ports, with the inter-arrival
+ * time and jitter within that connection.
+ */
+static const char* st_str_rbus_events = "Event Publications";
+static const char* st_str_rbus_event_bytes = "Payload Bytes";
+static const char* st_str_rbus_event_interarrival = "Inter-arrival (us)";
+static const char* st_str_rbus_event_jitter = "Jitter (us)";
+static int st_node_rbus_events = -1;
 
-            if (consumed == 0) {
-               /* Fall back to generic MessagePack parsing */
-               guint payload_offset = offset;
-               guint end_offset = offset + actual_payload_length;
-               guint object_count = 0;
-               guint total_consumed = 0;
+static void
+rbus_events_stats_tree_init(stats_tree* st) {
+   st_node_rbus_events = stats_tree_create_node(st, st_str_rbus_events, 0, STAT_DT_INT, TRUE);
+}
 
-               /* Initialize parsing context to track meta information fields */
-               rbus_parse_context_t parse_ctx = {0, FALSE, 0, NULL, 0, 0};
+static tap_packet_status
+rbus_events_stats_tree_packet(stats_tree* st, packet_info* pinfo, epan_dissect_t* edt _U_, const void* p,
+   tap_flags_t flags _U_) {
+   const rbus_tap_info_t* tap_info = (const rbus_tap_info_t*)p;
+   const rbus_event_record_t* event = tap_info->event;
+   const gchar* connection;
+   int event_node;
+   int connection_node;
+
+   if (!event) {
+      return TAP_PACKET_DONT_REDRAW;
+   }
 
-               while (payload_offset < end_offset) {
-                  /* Make sure we don't go beyond what's available */
-                  guint available = tvb_captured_length_remaining(tvb, payload_offset);
-                  if (available == 0) {
-                     break;
-                  }
+   avg_stat_node_add_value_int(st, st_str_rbus_events, 0, TRUE, event->payload_length);
+   event_node = avg_stat_node_add_value_int(st, rbus_intern_string(event->name_id), st_node_rbus_events, TRUE,
+      event->payload_length);
+   increase_stat_node(st, st_str_rbus_event_bytes, event_node, FALSE, event->payload_length);
 
-                  guint max_len = (end_offset - payload_offset < available) ?
-                     end_offset - payload_offset : available;
+   connection = wmem_strdup_printf(pinfo->pool, "Port %u to %u", pinfo->srcport, pinfo->destport);
+   connection_node = avg_stat_node_add_value_int(st, connection, event_node, TRUE, event->payload_length);
+   if (event->prev_frame) {
+      avg_stat_node_add_value_int(st, st_str_rbus_event_interarrival, connection_node, FALSE,
+         (int)MIN(rbus_nstime_to_us(&event->interarrival), G_MAXINT32));
+   }
+   if (event->publication > 2) {
+      avg_stat_node_add_value_int(st, st_str_rbus_event_jitter, connection_node, FALSE, event->jitter);
+   }
 
-                  parse_ctx.object_index = object_count;
-                  guint consumed_bytes = dissect_msgpack_value(tvb, pinfo, payload_tree,
-                     payload_offset,
-                     max_len,
-                     0, NULL, &parse_ctx);
+   return TAP_PACKET_REDRAW;
+}
 
-                  if (consumed_bytes == 0) {
-                     /* Failed to decode, show remaining as raw */
-                     if (payload_offset < end_offset) {
-                        proto_tree_add_item(payload_tree, hf_rbus_payload, tvb,
-                           payload_offset, end_offset - payload_offset, ENC_NA);
-                     }
-                     break;
-                  }
+/*
+ * SET transaction tree: completed transactions with their average/min/max
+ * duration, by outcome and by parameter count.
+ */
+static const char* st_str_rbus_set = "SET Transactions (us)";
+static const char* st_str_rbus_set_params = "Duration by Parameter Count (us)";
+static int st_node_rbus_set = -1;
+static int st_node_rbus_set_params = -1;
+
+static const struct {
+   guint32 max_params;
+   const char* name;
+} rbus_set_param_buckets[] = {
+   { 1, "0-1" },
+   { 4, "2-4" },
+   { 16, "5-16" },
+   { 64, "17-64" },
+   { G_MAXUINT32, "65+" },
+};
 
-                  payload_offset += consumed_bytes;
-                  total_consumed += consumed_bytes;
-                  object_count++;
+static void
+rbus_set_stats_tree_init(stats_tree* st) {
+   st_node_rbus_set = stats_tree_create_node(st, st_str_rbus_set, 0, STAT_DT_INT, TRUE);
+   st_node_rbus_set_params = stats_tree_create_node(st, st_str_rbus_set_params, 0, STAT_DT_INT, TRUE);
+}
 
-                  /* Safety limit to prevent infinite loops */
-                  if (object_count >= pref_msgpack_object_limit) {
-                     proto_tree_add_expert_format(payload_tree, pinfo, &ei_rbus_msgpack_depth_exceeded, tvb,
-                        payload_offset, end_offset - payload_offset,
-                        "MessagePack object limit (%u) reached; remaining %u bytes not decoded",
-                        pref_msgpack_object_limit, end_offset - payload_offset);
-                     break;
-                  }
-               }
+static tap_packet_status
+rbus_set_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p,
+   tap_flags_t flags _U_) {
+   const rbus_tap_info_t* tap_info = (const rbus_tap_info_t*)p;
+   const rbus_set_transaction_t* txn = tap_info->set_txn;
+   const char* bucket = NULL;
+   int duration;
 
-               if (total_consumed > 0) {
-                  proto_item_append_text(payload_item, " [%u MessagePack object%s]",
-                     object_count, object_count == 1 ? "" : "s");
-               } else {
-                  proto_item_append_text(payload_item, " [Not valid MessagePack]");
-               }
-            } else {
-               proto_item_append_text(payload_item, " [Structured RBus Message]");
-            }
-         }
+   if (!txn) {
+      return TAP_PACKET_DONT_REDRAW;
+   }
 
-         offset += payload_length;
+   duration = (int)MIN(rbus_nstime_to_us(&txn->duration), G_MAXINT32);
+   for (guint i = 0; i < array_length(rbus_set_param_buckets) && !bucket; i++) {
+      if (txn->params <= rbus_set_param_buckets[i].max_params) {
+         bucket = rbus_set_param_buckets[i].name;
       }
    }
 
-   return offset;
+   avg_stat_node_add_value_int(st, st_str_rbus_set, 0, TRUE, duration);
+   avg_stat_node_add_value_int(st, txn->outcome == RBUS_SET_FAILED ? "Failed" : "Succeeded", st_node_rbus_set,
+      FALSE, duration);
+   avg_stat_node_add_value_int(st, st_str_rbus_set_params, 0, TRUE, duration);
+   avg_stat_node_add_value_int(st, bucket, st_node_rbus_set_params, FALSE, duration);
+
+   return TAP_PACKET_REDRAW;
 }
 
 /*
- * Heuristic dissector to auto-detect RBus protocol
+ * Discovery tree (-z rbus,discovery): per requesting inbox, discovery
+ * requests with their rate and burst rate, split by kind, the request and
+ * response bytes, the requests within the window and the fan-out of the
+ * responses.
  */
-static bool
-dissect_rbus_heur(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, void* data) {
-   /* Need at least 22 bytes for basic header check (up to payload_length field) */
-   if (tvb_captured_length(tvb) < 22) {
-      return false;
-   }
+static const char* st_str_rbus_discovery = "Discovery Requests";
+static const char* st_str_rbus_discovery_bytes = "Bytes";
+static const char* st_str_rbus_discovery_window = "Requests in Window";
+static const char* st_str_rbus_discovery_fanout = "Fan-out";
+static int st_node_rbus_discovery = -1;
 
-   /* Check for RBus marker (0xAAAA) */
-   guint16 marker = tvb_get_ntohs(tvb, 0);
-   if (marker != 0xAAAA) {
-      return false;
-   }
+static void
+rbus_discovery_stats_tree_init(stats_tree* st) {
+   st_node_rbus_discovery = stats_tree_create_node(st, st_str_rbus_discovery, 0, STAT_DT_INT, TRUE);
+}
 
-   /* Check for reasonable version field (currently version 2) */
-   guint16 version = tvb_get_ntohs(tvb, 2);
-   if (version != 2) {
-      return false;
-   }
+static tap_packet_status
+rbus_discovery_stats_tree_packet(stats_tree* st, packet_info* pinfo _U_, epan_dissect_t* edt _U_, const void* p,
+   tap_flags_t flags _U_) {
+   const rbus_tap_info_t* tap_info = (const rbus_tap_info_t*)p;
+   const rbus_discovery_record_t* discovery = tap_info->discovery;
+   const char* inbox;
+   int inbox_node;
 
-   /* Check header length is reasonable */
-   guint16 header_length = tvb_get_ntohs(tvb, 4);
-   if (header_length < 32 || header_length > 4096) {
-      return false;
+   if (!discovery) {
+      return TAP_PACKET_DONT_REDRAW;
    }
 
-   /* Check payload length is reasonable (now at offset 18: 2+2+2+4+4+4=18) */
-   guint32 payload_length = tvb_get_ntohl(tvb, 18);
-   if (payload_length > RBUS_MAX_PAYLOAD_SIZE) {
-      return false;
+   inbox = rbus_intern_string(discovery->inbox_id);
+   if (discovery->response) {
+      /* Find the inbox node without counting a request */
+      inbox_node = increase_stat_node(st, inbox, st_node_rbus_discovery, TRUE, 0);
+      if (discovery->has_fanout) {
+         avg_stat_node_add_value_int(st, st_str_rbus_discovery_fanout, inbox_node, FALSE,
+            (int)MIN(discovery->fanout, G_MAXINT32));
+      }
+   } else {
+      tick_stat_node(st, st_str_rbus_discovery, 0, TRUE);
+      inbox_node = tick_stat_node(st, inbox, st_node_rbus_discovery, TRUE);
+      tick_stat_node(st, try_val_to_str(discovery->control_type, rbus_control_msg_type_vals), inbox_node, FALSE);
+      avg_stat_node_add_value_int(st, st_str_rbus_discovery_window, inbox_node, FALSE,
+         (int)discovery->window_requests);
    }
+   increase_stat_node(st, st_str_rbus_discovery_bytes, inbox_node, FALSE, (int)discovery->message_length);
 
-   /* Looks like RBus, dissect it */
-   dissect_rbus(tvb, pinfo, tree, data);
-   return true;
+   return TAP_PACKET_REDRAW;
 }
 
 /*
@@ -1979,27 +4002,47 @@ proto_register_rbus(void) {
        { &hf_rbus_roundtrip_t1,
          { "Roundtrip T1", "rbus.header.roundtrip.t1",
            FT_UINT32, BASE_DEC, NULL, 0x0,
-           "Time at which consumer sends the request to daemon", HFILL }
+           "Time at which consumer sends the request to daemon, in Unix epoch seconds", HFILL }
        },
        { &hf_rbus_roundtrip_t2,
          { "Roundtrip T2", "rbus.header.roundtrip.t2",
            FT_UINT32, BASE_DEC, NULL, 0x0,
-           "Time at which daemon receives the message from consumer", HFILL }
+           "Time at which daemon receives the message from consumer, in Unix epoch seconds", HFILL }
        },
        { &hf_rbus_roundtrip_t3,
          { "Roundtrip T3", "rbus.header.roundtrip.t3",
            FT_UINT32, BASE_DEC, NULL, 0x0,
-           "Time at which daemon writes to provider socket", HFILL }
+           "Time at which daemon writes to provider socket, in Unix epoch seconds", HFILL }
        },
        { &hf_rbus_roundtrip_t4,
          { "Roundtrip T4", "rbus.header.roundtrip.t4",
            FT_UINT32, BASE_DEC, NULL, 0x0,
-           "Time at which provider sends back the response", HFILL }
+           "Time at which provider sends back the response, in Unix epoch seconds", HFILL }
        },
        { &hf_rbus_roundtrip_t5,
          { "Roundtrip T5", "rbus.header.roundtrip.t5",
            FT_UINT32, BASE_DEC, NULL, 0x0,
-           "Time at which daemon received the response", HFILL }
+           "Time at which daemon received the response, in Unix epoch seconds", HFILL }
+       },
+       { &hf_rbus_roundtrip_client_to_router,
+         { "Client to Router", "rbus.header.roundtrip.client_to_router",
+           FT_INT32, BASE_DEC, NULL, 0x0,
+           "T2 - T1: consumer to daemon, in seconds", HFILL }
+       },
+       { &hf_rbus_roundtrip_router_to_provider,
+         { "Router to Provider", "rbus.header.roundtrip.router_to_provider",
+           FT_INT32, BASE_DEC, NULL, 0x0,
+           "T3 - T2: time spent in the daemon before writing to the provider, in seconds", HFILL }
+       },
+       { &hf_rbus_roundtrip_provider,
+         { "Provider Processing", "rbus.header.roundtrip.provider",
+           FT_INT32, BASE_DEC, NULL, 0x0,
+           "T4 - T3: provider processing time, in seconds", HFILL }
+       },
+       { &hf_rbus_roundtrip_return,
+         { "Return Path", "rbus.header.roundtrip.return",
+           FT_INT32, BASE_DEC, NULL, 0x0,
+           "T5 - T4: provider response back to the daemon, in seconds", HFILL }
        },
        { &hf_rbus_closing_marker,
          { "Closing Marker", "rbus.header.closing_marker",
@@ -2046,6 +4089,11 @@ proto_register_rbus(void) {
            FT_BYTES, BASE_NONE, NULL, 0x0,
            "MessagePack encoded payload", HFILL }
        },
+       { &hf_rbus_unsynchronized,
+         { "Unsynchronized Data", "rbus.unsynchronized",
+           FT_BYTES, BASE_NONE, NULL, 0x0,
+           "Bytes before the next RBus header, e.g. the rest of a message the capture started in", HFILL }
+       },
        { &hf_rbus_payload_string,
          { "Payload", "rbus.payload.string",
            FT_STRING, BASE_NONE, NULL, 0x0,
@@ -2426,6 +4474,194 @@ proto_register_rbus(void) {
           FT_STRING, BASE_NONE, NULL, 0x0,
           "Table row alias name", HFILL }
       },
+      /* Request/response tracking fields */
+      { &hf_rbus_response_in,
+        { "Response In", "rbus.response_in",
+          FT_FRAMENUM, BASE_NONE, FRAMENUM_TYPE(FT_FRAMENUM_RESPONSE), 0x0,
+          "The response to this request is in this frame", HFILL }
+      },
+      { &hf_rbus_response_to,
+        { "Request In", "rbus.response_to",
+          FT_FRAMENUM, BASE_NONE, FRAMENUM_TYPE(FT_FRAMENUM_REQUEST), 0x0,
+          "This is a response to the request in this frame", HFILL }
+      },
+      { &hf_rbus_response_time,
+        { "Response Time", "rbus.response_time",
+          FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+          "Time between the request and this response", HFILL }
+      },
+      { &hf_rbus_duplicate_of,
+        { "Duplicate Sequence Number Of", "rbus.duplicate_of",
+          FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "Earlier request with the same sequence number, still awaiting its response", HFILL }
+      },
+      { &hf_rbus_method_id,
+        { "Request Method", "rbus.method_id",
+          FT_UINT32, BASE_DEC, VALS(rbus_method_vals), 0x0,
+          "Method of the request in this request/response pair", HFILL }
+      },
+      /* Event publication statistics fields */
+      { &hf_rbus_event_stats,
+        { "Event Statistics", "rbus.event",
+          FT_NONE, BASE_NONE, NULL, 0x0,
+          "Statistics of the publications of this event name", HFILL }
+      },
+      { &hf_rbus_event_publication,
+        { "Publication Number", "rbus.event.publication",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Number of this publication among those of the same event name on this connection", HFILL }
+      },
+      { &hf_rbus_event_previous,
+        { "Previous Publication In", "rbus.event.previous",
+          FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "The previous publication of this event name on this connection is in this frame", HFILL }
+      },
+      { &hf_rbus_event_interarrival,
+        { "Inter-arrival Time", "rbus.event.interarrival",
+          FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+          "Time since the previous publication of this event name on this connection", HFILL }
+      },
+      { &hf_rbus_event_jitter,
+        { "Jitter", "rbus.event.jitter",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Smoothed variation of the inter-arrival time (RFC 3550 estimator), in microseconds", HFILL }
+      },
+      { &hf_rbus_event_rate,
+        { "Rate", "rbus.event.rate",
+          FT_DOUBLE, BASE_NONE, NULL, 0x0,
+          "Publications of this event name on this connection per second over the last 16", HFILL }
+      },
+      { &hf_rbus_event_subscribers,
+        { "Subscribers", "rbus.event.subscribers",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Inboxes subscribed to this event name when it was published", HFILL }
+      },
+
+      /* Subscription state */
+      { &hf_rbus_subscription,
+        { "Subscription State", "rbus.subscription",
+          FT_NONE, BASE_NONE, NULL, 0x0,
+          "Subscription table after this subscribe or unsubscribe", HFILL }
+      },
+      { &hf_rbus_subscription_event,
+        { "Event Name", "rbus.subscription.event",
+          FT_STRING, BASE_NONE, NULL, 0x0,
+          NULL, HFILL }
+      },
+      { &hf_rbus_subscription_inbox,
+        { "Subscriber Inbox", "rbus.subscription.inbox",
+          FT_STRING, BASE_NONE, NULL, 0x0,
+          NULL, HFILL }
+      },
+      { &hf_rbus_subscription_subscribers,
+        { "Subscribers", "rbus.subscription.subscribers",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Inboxes subscribed to this event name after this message", HFILL }
+      },
+      { &hf_rbus_subscription_subscribed_in,
+        { "Subscribed In", "rbus.subscription.subscribed_in",
+          FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "Frame the inbox subscribed to this event name in", HFILL }
+      },
+
+      /* SET transactions */
+      { &hf_rbus_set_txn,
+        { "SET Transaction", "rbus.set_transaction",
+          FT_NONE, BASE_NONE, NULL, 0x0,
+          "SETs sharing a session, their commit and the responses", HFILL }
+      },
+      { &hf_rbus_set_txn_id,
+        { "Transaction", "rbus.set_transaction.id",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Number of the SET transaction within the capture", HFILL }
+      },
+      { &hf_rbus_set_txn_first,
+        { "First SET In", "rbus.set_transaction.first",
+          FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          NULL, HFILL }
+      },
+      { &hf_rbus_set_txn_commit,
+        { "Commit In", "rbus.set_transaction.commit",
+          FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "Frame of the committing SET or COMMIT", HFILL }
+      },
+      { &hf_rbus_set_txn_complete,
+        { "Completed In", "rbus.set_transaction.complete",
+          FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "Frame of the last response", HFILL }
+      },
+      { &hf_rbus_set_txn_messages,
+        { "Requests", "rbus.set_transaction.messages",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "SET and COMMIT requests in the transaction", HFILL }
+      },
+      { &hf_rbus_set_txn_params,
+        { "Parameters", "rbus.set_transaction.params",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Parameters set over all SETs in the transaction", HFILL }
+      },
+      { &hf_rbus_set_txn_duration,
+        { "Duration", "rbus.set_transaction.duration",
+          FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+          "Time from the first SET to the last response", HFILL }
+      },
+      { &hf_rbus_set_txn_outcome,
+        { "Outcome", "rbus.set_transaction.outcome",
+          FT_UINT32, BASE_DEC, VALS(rbus_set_outcome_vals), 0x0,
+          NULL, HFILL }
+      },
+      { &hf_rbus_set_txn_error_code,
+        { "Error Code", "rbus.set_transaction.error_code",
+          FT_INT32, BASE_DEC, NULL, 0x0,
+          "First non-zero error code among the responses", HFILL }
+      },
+
+      /* Discovery traffic */
+      { &hf_rbus_discovery,
+        { "Discovery Statistics", "rbus.discovery",
+          FT_NONE, BASE_NONE, NULL, 0x0,
+          "Discovery traffic of the requesting inbox", HFILL }
+      },
+      { &hf_rbus_discovery_inbox,
+        { "Requesting Inbox", "rbus.discovery.inbox",
+          FT_STRING, BASE_NONE, NULL, 0x0,
+          "Inbox the discovery request asks to be answered on", HFILL }
+      },
+      { &hf_rbus_discovery_request,
+        { "Request Number", "rbus.discovery.request",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Number of this request among the discovery requests of the inbox", HFILL }
+      },
+      { &hf_rbus_discovery_previous,
+        { "Previous Request In", "rbus.discovery.previous",
+          FT_FRAMENUM, BASE_NONE, NULL, 0x0,
+          "The previous discovery request of the inbox is in this frame", HFILL }
+      },
+      { &hf_rbus_discovery_interval,
+        { "Time Since Previous Request", "rbus.discovery.interval",
+          FT_RELATIVE_TIME, BASE_NONE, NULL, 0x0,
+          "Time since the previous discovery request of the inbox", HFILL }
+      },
+      { &hf_rbus_discovery_window_requests,
+        { "Requests in Window", "rbus.discovery.window_requests",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Discovery requests of the inbox within the discovery window, this one included", HFILL }
+      },
+      { &hf_rbus_discovery_window_bytes,
+        { "Bytes in Window", "rbus.discovery.window_bytes",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Discovery request and response bytes of the inbox within the discovery window", HFILL }
+      },
+      { &hf_rbus_discovery_rate,
+        { "Rate", "rbus.discovery.rate",
+          FT_DOUBLE, BASE_NONE, NULL, 0x0,
+          "Discovery requests of the inbox per second over the discovery window", HFILL }
+      },
+      { &hf_rbus_discovery_fanout,
+        { "Fan-out", "rbus.discovery.fanout",
+          FT_UINT32, BASE_DEC, NULL, 0x0,
+          "Components or elements listed in the discovery response", HFILL }
+      },
    };
 
    static gint* ett[] = {
@@ -2438,6 +4674,10 @@ proto_register_rbus(void) {
        &ett_rbus_metadata,
        &ett_rbus_control,
        &ett_rbus_event_metadata,
+       &ett_rbus_event_stats,
+       &ett_rbus_subscription,
+       &ett_rbus_set_txn,
+       &ett_rbus_discovery,
    };
 
    static ei_register_info ei[] = {
@@ -2457,6 +4697,42 @@ proto_register_rbus(void) {
                { "rbus.msgpack_depth_exceeded", PI_MALFORMED, PI_WARN,
                    "MessagePack depth limit exceeded", EXPFILL }
            },
+           { &ei_rbus_no_response,
+               { "rbus.no_response", PI_SEQUENCE, PI_NOTE,
+                   "No response seen to this request", EXPFILL }
+           },
+           { &ei_rbus_response_timeout,
+               { "rbus.response_timeout", PI_SEQUENCE, PI_WARN,
+                   "No response within the timeout", EXPFILL }
+           },
+           { &ei_rbus_slow_response,
+               { "rbus.slow_response", PI_SEQUENCE, PI_WARN,
+                   "Response time exceeds the SLA threshold", EXPFILL }
+           },
+           { &ei_rbus_unmatched_response,
+               { "rbus.unmatched_response", PI_SEQUENCE, PI_NOTE,
+                   "Response to no request seen", EXPFILL }
+           },
+           { &ei_rbus_duplicate_sequence,
+               { "rbus.duplicate_sequence", PI_SEQUENCE, PI_WARN,
+                   "Sequence number reused by a pending request", EXPFILL }
+           },
+           { &ei_rbus_discovery_storm,
+               { "rbus.discovery.storm", PI_SEQUENCE, PI_WARN,
+                   "Discovery requests in a tight loop", EXPFILL }
+           },
+           { &ei_rbus_resync,
+               { "rbus.resync", PI_SEQUENCE, PI_NOTE,
+                   "Not at a message boundary; skipped to the next RBus header", EXPFILL }
+           },
+           { &ei_rbus_slow_hop,
+               { "rbus.slow_hop", PI_SEQUENCE, PI_WARN,
+                   "Roundtrip hop exceeds the latency threshold", EXPFILL }
+           },
+           { &ei_rbus_no_subscribers,
+               { "rbus.event.no_subscribers", PI_SEQUENCE, PI_NOTE,
+                   "Event published with no subscribers", EXPFILL }
+           },
    };
 
    expert_module_t* expert_rbus;
@@ -2469,6 +4745,9 @@ proto_register_rbus(void) {
       RBUS_PROTOCOL_NAME          /* Filter name */
    );
 
+   /* Register by name so exported PDUs (e.g. from rbus-uds-capture) reach the dissector */
+   rbus_handle = register_dissector(RBUS_PROTOCOL_NAME, dissect_rbus, proto_rbus);
+
    /* Register fields and subtrees */
    proto_register_field_array(proto_rbus, hf, array_length(hf));
    proto_register_subtree_array(ett, array_length(ett));
@@ -2477,6 +4756,27 @@ proto_register_rbus(void) {
    expert_rbus = expert_register_protocol(proto_rbus);
    expert_register_field_array(expert_rbus, ei, array_length(ei));
 
+   /* Per-capture state */
+   register_init_routine(rbus_intern_init);
+   register_init_routine(rbus_transactions_init);
+   register_init_routine(rbus_subscriptions_init);
+   register_init_routine(rbus_set_transactions_init);
+   register_init_routine(rbus_discovery_init);
+
+   /* Register tap and service response time tables */
+   rbus_tap = register_tap("rbus");
+   register_srt_table(proto_rbus, NULL, 2, rbus_srt_packet, rbus_srt_init, NULL);
+   stats_tree_register_plugin("rbus", "rbus,hops", "RBus/Hop Latency", 0,
+      rbus_hops_stats_tree_packet, rbus_hops_stats_tree_init, NULL);
+   stats_tree_register_plugin("rbus", "rbus,tree", "RBus/Topics", 0,
+      rbus_topics_stats_tree_packet, rbus_topics_stats_tree_init, rbus_topics_stats_tree_cleanup);
+   stats_tree_register_plugin("rbus", "rbus,events", "RBus/Event Publications", 0,
+      rbus_events_stats_tree_packet, rbus_events_stats_tree_init, NULL);
+   stats_tree_register_plugin("rbus", "rbus,set", "RBus/SET Transactions", 0,
+      rbus_set_stats_tree_packet, rbus_set_stats_tree_init, NULL);
+   stats_tree_register_plugin("rbus", "rbus,discovery", "RBus/Discovery", 0,
+      rbus_discovery_stats_tree_packet, rbus_discovery_stats_tree_init, NULL);
+
    /* Register preferences */
    rbus_module = prefs_register_protocol(proto_rbus, NULL);
 
@@ -2485,6 +4785,12 @@ proto_register_rbus(void) {
       "TCP port for RBus protocol",
       10, &pref_tcp_port);
 
+   prefs_register_bool_preference(rbus_module, "desegment",
+      "Reassemble RBus messages spanning multiple TCP segments",
+      "Whether the RBus dissector should reassemble messages spanning multiple TCP segments. "
+      "To use this option, you must also enable \"Allow subdissectors to reassemble TCP streams\" in the TCP protocol settings.",
+      &pref_desegment);
+
    prefs_register_uint_preference(rbus_module, "msgpack_depth_limit",
       "MessagePack Depth Limit",
       "Maximum nesting depth for MessagePack decoding",
@@ -2494,6 +4800,32 @@ proto_register_rbus(void) {
       "MessagePack Object Limit",
       "Maximum number of MessagePack objects to decode per payload",
       10, &pref_msgpack_object_limit);
+
+   prefs_register_uint_preference(rbus_module, "hop_threshold",
+      "Roundtrip Hop Threshold (s)",
+      "Flag roundtrip hops (T1-T5 deltas, whole seconds) longer than this many seconds; 0 disables the check",
+      10, &pref_hop_threshold);
+
+   prefs_register_uint_preference(rbus_module, "response_timeout",
+      "Response Timeout (ms)",
+      "Flag requests with no response within this many milliseconds, as the rbus client gives up on them "
+      "(15000 by default); 0 disables the check",
+      10, &pref_response_timeout);
+
+   prefs_register_uint_preference(rbus_module, "response_sla",
+      "Response Time SLA (ms)",
+      "Flag responses slower than this many milliseconds; 0 disables the check",
+      10, &pref_response_sla);
+
+   prefs_register_uint_preference(rbus_module, "discovery_window",
+      "Discovery Window (s)",
+      "Window over which discovery requests are counted per requesting inbox",
+      10, &pref_discovery_window);
+
+   prefs_register_uint_preference(rbus_module, "discovery_threshold",
+      "Discovery Requests per Window",
+      "Flag an inbox sending more discovery requests than this within the window; 0 disables the check",
+      10, &pref_discovery_threshold);
 }
 
 /*
@@ -2501,9 +4833,6 @@ proto_register_rbus(void) {
  */
 void
 proto_reg_handoff_rbus(void) {
-   /* Create dissector handle */
-   rbus_handle = create_dissector_handle(dissect_rbus, proto_rbus);
-
    /* Register as heuristic dissector for TCP */
    heur_dissector_add("tcp", dissect_rbus_heur, "RBus over TCP",
       "rbus_tcp", proto_rbus, HEURISTIC_ENABLE);
@@ -0,0 +1,763 @@
+/*
+ * rbus-wire.c - RBus wire format decoding library
+ *
+ * Copyright 2026
+ * Licensed under the Apache License, Version 2.0
+ */
+
+#include <string.h>
+
+#include "rbus-protocol.h"
+#include "rbus-wire.h"
+
+static inline uint16_t
+get_be16(const uint8_t* p) {
+   return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t
+get_be32(const uint8_t* p) {
+   return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline uint64_t
+get_be64(const uint8_t* p) {
+   return ((uint64_t)get_be32(p) << 32) | get_be32(p + 4);
+}
+
+/*
+ * Framing
+ */
+bool
+rbus_wire_header_plausible(const uint8_t* data, size_t length) {
+   uint16_t header_length;
+
+   if (length < RBUS_WIRE_FRAME_HEADER_LENGTH) {
+      return false;
+   }
+
+   /* Marker, version 2, reasonable header and payload lengths */
+   if (get_be16(data) != RBUS_WIRE_MARKER || get_be16(data + 2) != 2) {
+      return false;
+   }
+   header_length = get_be16(data + 4);
+   if (header_length < 32 || header_length > RBUS_WIRE_MAX_HEADER_LENGTH) {
+      return false;
+   }
+   if (get_be32(data + 18) > RBUS_MAX_PAYLOAD_SIZE) {
+      return false;
+   }
+
+   /* The closing marker ends the header; check it when it is in the buffer */
+   if (header_length <= length && get_be16(data + header_length - 2) != RBUS_WIRE_MARKER) {
+      return false;
+   }
+   return true;
+}
+
+size_t
+rbus_wire_message_length(const uint8_t* data, size_t length) {
+   if (length < RBUS_WIRE_FRAME_HEADER_LENGTH) {
+      return 0;
+   }
+   /* header_length at offset 4, payload_length at offset 18 */
+   return (size_t)get_be16(data + 4) + get_be32(data + 18);
+}
+
+/*
+ * The opening marker is searched a word at a time: XOR with 0xAA.. turns
+ * marker bytes into zero bytes, and the has-zero-byte test rules out eight
+ * bytes at once.
+ */
+long
+rbus_wire_find_header(const uint8_t* data, size_t length) {
+   size_t i = 0;
+
+   while (i + 1 < length) {
+      if (i + 8 <= length) {
+         uint64_t word;
+
+         memcpy(&word, data + i, 8);
+         word ^= UINT64_C(0xAAAAAAAAAAAAAAAA);
+         if (((word - UINT64_C(0x0101010101010101)) & ~word & UINT64_C(0x8080808080808080)) == 0) {
+            i += 8;
+            continue;
+         }
+      }
+
+      /* A word holding a marker byte is checked byte by byte */
+      size_t stop = (i + 8 < length - 1) ? i + 8 : length - 1;
+      for (; i < stop; i++) {
+         if (data[i] == 0xAA && data[i + 1] == 0xAA &&
+            (length - i < RBUS_WIRE_FRAME_HEADER_LENGTH || rbus_wire_header_plausible(data + i, length - i))) {
+            return (long)i;
+         }
+      }
+   }
+
+   /* A trailing marker byte may be the first half of a split marker */
+   if (length > 0 && data[length - 1] == 0xAA) {
+      return (long)(length - 1);
+   }
+   return -1;
+}
+
+/*
+ * Header
+ */
+rbus_wire_status_t
+rbus_wire_parse_header(const uint8_t* data, size_t length, rbus_wire_header_t* header) {
+   size_t offset;
+
+   if (length < RBUS_WIRE_FRAME_HEADER_LENGTH + 4) {
+      return RBUS_WIRE_NEED_MORE;
+   }
+   if (get_be16(data) != RBUS_WIRE_MARKER) {
+      return RBUS_WIRE_INVALID;
+   }
+
+   memset(header, 0, sizeof(*header));
+   header->version = get_be16(data + 2);
+   header->header_length = get_be16(data + 4);
+   header->sequence = get_be32(data + 6);
+   header->flags = get_be32(data + 10);
+   header->control = get_be32(data + 14);
+   header->payload_length = get_be32(data + 18);
+
+   if (header->header_length > length) {
+      return RBUS_WIRE_NEED_MORE;
+   }
+
+   /* Topic and reply topic, each a 32-bit length and the bytes */
+   offset = 22;
+   header->topic_length = get_be32(data + offset);
+   offset += 4;
+   if (header->topic_length > header->header_length - offset) {
+      return RBUS_WIRE_INVALID;
+   }
+   header->topic_offset = (uint32_t)offset;
+   offset += header->topic_length;
+
+   if (offset + 4 > header->header_length) {
+      return RBUS_WIRE_INVALID;
+   }
+   header->reply_topic_length = get_be32(data + offset);
+   offset += 4;
+   if (header->reply_topic_length > header->header_length - offset) {
+      return RBUS_WIRE_INVALID;
+   }
+   header->reply_topic_offset = (uint32_t)offset;
+   offset += header->reply_topic_length;
+
+   /* Optional T1-T5, present when the closing marker sits 20 bytes later */
+   if (offset + 22 <= header->header_length && get_be16(data + offset + 20) == RBUS_WIRE_MARKER) {
+      header->has_roundtrip = true;
+      for (int i = 0; i < RBUS_WIRE_ROUNDTRIP_COUNT; i++) {
+         header->roundtrip[i] = get_be32(data + offset + 4 * i);
+      }
+      offset += 20;
+   }
+
+   if (offset + 2 > header->header_length || get_be16(data + offset) != RBUS_WIRE_MARKER) {
+      return RBUS_WIRE_INVALID;
+   }
+   return RBUS_WIRE_OK;
+}
+
+/*
+ * MessagePack
+ */
+static inline uint64_t
+get_be_sized(const uint8_t* p, uint32_t size) {
+   return (size == 1) ? p[0] : (size == 2) ? get_be16(p) : (size == 4) ? get_be32(p) : get_be64(p);
+}
+
+bool
+rbus_mp_read_head(const uint8_t* data, uint32_t offset, uint32_t end, rbus_mp_object_t* obj) {
+   uint32_t head = 1;         /* Bytes before the data (type byte + length/value fields) */
+   uint32_t data_len = 0;     /* STR/BIN/EXT data bytes */
+   uint32_t field;            /* Size of the length/value field that follows the type byte */
+   uint32_t avail;
+   uint8_t b;
+
+   if (offset >= end) {
+      return false;
+   }
+
+   b = data[offset];
+   avail = end - offset;
+   obj->offset = offset;
+
+   if (b <= 0x7f) {
+      obj->type = RBUS_MP_UINT;
+      obj->via.u64 = b;
+   } else if (b >= 0xe0) {
+      obj->type = RBUS_MP_INT;
+      obj->via.i64 = (int8_t)b;
+   } else if ((b & 0xf0) == 0x80) {
+      obj->type = RBUS_MP_MAP;
+      obj->via.size = b & 0x0f;
+   } else if ((b & 0xf0) == 0x90) {
+      obj->type = RBUS_MP_ARRAY;
+      obj->via.size = b & 0x0f;
+   } else if ((b & 0xe0) == 0xa0) {
+      obj->type = RBUS_MP_STR;
+      data_len = b & 0x1f;
+   } else {
+      switch (b) {
+         case 0xc0:
+            obj->type = RBUS_MP_NIL;
+            break;
+         case 0xc2:
+         case 0xc3:
+            obj->type = RBUS_MP_BOOLEAN;
+            obj->via.boolean = (b == 0xc3);
+            break;
+         case 0xc4: case 0xc5: case 0xc6:     /* bin 8/16/32 */
+         case 0xd9: case 0xda: case 0xdb:     /* str 8/16/32 */
+            obj->type = (b <= 0xc6) ? RBUS_MP_BIN : RBUS_MP_STR;
+            field = 1u << ((b <= 0xc6) ? (b - 0xc4) : (b - 0xd9));
+            if (avail < 1 + field) {
+               return false;
+            }
+            head += field;
+            data_len = (uint32_t)get_be_sized(data + offset + 1, field);
+            break;
+         case 0xc7: case 0xc8: case 0xc9:     /* ext 8/16/32 (length + type byte) */
+            obj->type = RBUS_MP_EXT;
+            field = 1u << (b - 0xc7);
+            if (avail < 2 + field) {
+               return false;
+            }
+            head += field + 1;
+            data_len = (uint32_t)get_be_sized(data + offset + 1, field);
+            break;
+         case 0xd4: case 0xd5: case 0xd6: case 0xd7: case 0xd8:   /* fixext 1/2/4/8/16 */
+            obj->type = RBUS_MP_EXT;
+            head += 1;
+            data_len = 1u << (b - 0xd4);
+            break;
+         case 0xca: {
+            uint32_t bits;
+            float value;
+
+            if (avail < 5) {
+               return false;
+            }
+            bits = get_be32(data + offset + 1);
+            memcpy(&value, &bits, sizeof(value));
+            obj->type = RBUS_MP_FLOAT32;
+            obj->via.f64 = value;
+            head += 4;
+            break;
+         }
+         case 0xcb: {
+            uint64_t bits;
+
+            if (avail < 9) {
+               return false;
+            }
+            bits = get_be64(data + offset + 1);
+            obj->type = RBUS_MP_FLOAT64;
+            memcpy(&obj->via.f64, &bits, sizeof(obj->via.f64));
+            head += 8;
+            break;
+         }
+         case 0xcc: case 0xcd: case 0xce: case 0xcf:   /* uint 8/16/32/64 */
+            field = 1u << (b - 0xcc);
+            if (avail < 1 + field) {
+               return false;
+            }
+            obj->type = RBUS_MP_UINT;
+            obj->via.u64 = get_be_sized(data + offset + 1, field);
+            head += field;
+            break;
+         case 0xd0: case 0xd1: case 0xd2: case 0xd3: { /* int 8/16/32/64 */
+            int64_t value;
+
+            field = 1u << (b - 0xd0);
+            if (avail < 1 + field) {
+               return false;
+            }
+            value = (field == 1) ? (int8_t)data[offset + 1] :
+                    (field == 2) ? (int16_t)get_be16(data + offset + 1) :
+                    (field == 4) ? (int32_t)get_be32(data + offset + 1) :
+                                   (int64_t)get_be64(data + offset + 1);
+            /* Like libmsgpack, classify by value so a fixed int32 metadata offset reads as unsigned */
+            if (value >= 0) {
+               obj->type = RBUS_MP_UINT;
+               obj->via.u64 = (uint64_t)value;
+            } else {
+               obj->type = RBUS_MP_INT;
+               obj->via.i64 = value;
+            }
+            head += field;
+            break;
+         }
+         case 0xdc: case 0xdd:                /* array 16/32 */
+         case 0xde: case 0xdf:                /* map 16/32 */
+            field = (b == 0xdc || b == 0xde) ? 2 : 4;
+            if (avail < 1 + field) {
+               return false;
+            }
+            obj->type = (b <= 0xdd) ? RBUS_MP_ARRAY : RBUS_MP_MAP;
+            obj->via.size = (uint32_t)get_be_sized(data + offset + 1, field);
+            head += field;
+            break;
+         default:
+            /* 0xc1 is never used */
+            return false;
+      }
+   }
+
+   if ((uint64_t)head + data_len > avail) {
+      return false;
+   }
+
+   if (obj->type == RBUS_MP_STR || obj->type == RBUS_MP_BIN || obj->type == RBUS_MP_EXT) {
+      obj->via.size = data_len;
+   }
+   obj->data_offset = offset + head;
+   obj->length = head + data_len;
+   return true;
+}
+
+/* Nesting tracked on the stack by rbus_mp_read_object before it gives up */
+#define RBUS_MP_MAX_STACK 64
+
+rbus_wire_status_t
+rbus_mp_read_object(const uint8_t* data, uint32_t offset, uint32_t end,
+   uint32_t max_depth, rbus_mp_object_t* obj) {
+   uint64_t remaining[RBUS_MP_MAX_STACK];   /* Children left per open container */
+   uint32_t depth = 0;
+   uint32_t pos;
+
+   if (!rbus_mp_read_head(data, offset, end, obj)) {
+      return RBUS_WIRE_INVALID;
+   }
+   if ((obj->type != RBUS_MP_ARRAY && obj->type != RBUS_MP_MAP) || obj->via.size == 0) {
+      return RBUS_WIRE_OK;
+   }
+
+   if (max_depth > RBUS_MP_MAX_STACK) {
+      max_depth = RBUS_MP_MAX_STACK;
+   }
+   remaining[depth++] = (obj->type == RBUS_MP_MAP) ? 2 * (uint64_t)obj->via.size : obj->via.size;
+   pos = obj->data_offset;
+
+   while (depth > 0) {
+      rbus_mp_object_t child;
+
+      if (!rbus_mp_read_head(data, pos, end, &child)) {
+         return RBUS_WIRE_INVALID;
+      }
+      remaining[depth - 1]--;
+
+      if ((child.type == RBUS_MP_ARRAY || child.type == RBUS_MP_MAP) && child.via.size > 0) {
+         if (depth >= max_depth) {
+            return RBUS_WIRE_INVALID;
+         }
+         remaining[depth++] = (child.type == RBUS_MP_MAP) ? 2 * (uint64_t)child.via.size : child.via.size;
+         pos = child.data_offset;
+         continue;
+      }
+
+      pos = child.offset + child.length;
+      while (depth > 0 && remaining[depth - 1] == 0) {
+         depth--;
+      }
+   }
+
+   obj->length = pos - obj->offset;
+   return RBUS_WIRE_OK;
+}
+
+/*
+ * Methods
+ */
+static const char* const rbus_method_strings[RBUS_METHOD_COUNT] = {
+   [RBUS_METHOD_NONE] = "",
+   [RBUS_METHOD_OTHER] = "METHOD_",
+   [RBUS_METHOD_GETPARAMETERVALUES] = "METHOD_GETPARAMETERVALUES",
+   [RBUS_METHOD_SETPARAMETERVALUES] = "METHOD_SETPARAMETERVALUES",
+   [RBUS_METHOD_GETPARAMETERNAMES] = "METHOD_GETPARAMETERNAMES",
+   [RBUS_METHOD_GETPARAMETERATTRIBUTES] = "METHOD_GETPARAMETERATTRIBUTES",
+   [RBUS_METHOD_SETPARAMETERATTRIBUTES] = "METHOD_SETPARAMETERATTRIBUTES",
+   [RBUS_METHOD_COMMIT] = "METHOD_COMMIT",
+   [RBUS_METHOD_SUBSCRIBE] = "METHOD_SUBSCRIBE",
+   [RBUS_METHOD_UNSUBSCRIBE] = "METHOD_UNSUBSCRIBE",
+   [RBUS_METHOD_RPC] = "METHOD_RPC",
+   [RBUS_METHOD_ADDTBLROW] = "METHOD_ADDTBLROW",
+   [RBUS_METHOD_DELETETBLROW] = "METHOD_DELETETBLROW",
+   [RBUS_METHOD_OPENDIRECT_CONN] = "METHOD_OPENDIRECT_CONN",
+   [RBUS_METHOD_CLOSEDIRECT_CONN] = "METHOD_CLOSEDIRECT_CONN",
+   [RBUS_METHOD_RESPONSE] = "METHOD_RESPONSE",
+};
+
+#define RBUS_METHOD_PREFIX_LEN 7   /* strlen("METHOD_") */
+
+const char*
+rbus_wire_method_name(rbus_method_t method) {
+   return (method < RBUS_METHOD_COUNT) ? rbus_method_strings[method] : rbus_method_strings[RBUS_METHOD_OTHER];
+}
+
+/*
+ * The name length (and the first character where two names share a length)
+ * selects a single candidate, which one comparison then confirms.
+ */
+rbus_method_t
+rbus_wire_method_from_string(const uint8_t* str, size_t length) {
+   rbus_method_t candidate;
+   const uint8_t* name;
+   size_t name_len;
+
+   if (length < RBUS_METHOD_PREFIX_LEN || memcmp(str, "METHOD_", RBUS_METHOD_PREFIX_LEN) != 0) {
+      return RBUS_METHOD_NONE;
+   }
+
+   name = str + RBUS_METHOD_PREFIX_LEN;
+   name_len = length - RBUS_METHOD_PREFIX_LEN;
+   if (name_len == 0) {
+      return RBUS_METHOD_OTHER;
+   }
+
+   switch (name_len) {
+      case 3:  candidate = RBUS_METHOD_RPC; break;
+      case 6:  candidate = RBUS_METHOD_COMMIT; break;
+      case 8:  candidate = RBUS_METHOD_RESPONSE; break;
+      case 9:  candidate = (name[0] == 'S') ? RBUS_METHOD_SUBSCRIBE : RBUS_METHOD_ADDTBLROW; break;
+      case 11: candidate = RBUS_METHOD_UNSUBSCRIBE; break;
+      case 12: candidate = RBUS_METHOD_DELETETBLROW; break;
+      case 15: candidate = RBUS_METHOD_OPENDIRECT_CONN; break;
+      case 16: candidate = RBUS_METHOD_CLOSEDIRECT_CONN; break;
+      case 17: candidate = RBUS_METHOD_GETPARAMETERNAMES; break;
+      case 18: candidate = (name[0] == 'G') ? RBUS_METHOD_GETPARAMETERVALUES : RBUS_METHOD_SETPARAMETERVALUES; break;
+      case 22: candidate = (name[0] == 'G') ? RBUS_METHOD_GETPARAMETERATTRIBUTES : RBUS_METHOD_SETPARAMETERATTRIBUTES; break;
+      default: return RBUS_METHOD_OTHER;
+   }
+
+   if (memcmp(name, rbus_method_strings[candidate] + RBUS_METHOD_PREFIX_LEN, name_len) != 0) {
+      return RBUS_METHOD_OTHER;
+   }
+   return candidate;
+}
+
+/*
+ * Payload summary
+ */
+rbus_wire_status_t
+rbus_wire_scan_payload(const uint8_t* data, size_t length,
+   const rbus_wire_limits_t* limits, rbus_wire_payload_t* payload) {
+   uint32_t end = (uint32_t)length;
+   uint32_t pos = 0;
+
+   memset(payload, 0, sizeof(*payload));
+   payload->method_index = -1;
+
+   while (pos < end && payload->object_count < limits->max_objects) {
+      rbus_mp_object_t obj;
+
+      if (rbus_mp_read_object(data, pos, end, limits->max_depth, &obj) != RBUS_WIRE_OK) {
+         return payload->object_count > 0 ? RBUS_WIRE_OK : RBUS_WIRE_INVALID;
+      }
+
+      if (payload->method_index < 0 && obj.type == RBUS_MP_STR) {
+         rbus_method_t method = rbus_wire_method_from_string(data + obj.data_offset, obj.via.size);
+
+         if (method != RBUS_METHOD_NONE) {
+            payload->method = method;
+            payload->method_index = (int32_t)payload->object_count;
+         }
+      }
+
+      payload->object_count++;
+      pos = obj.offset + obj.length;
+      payload->decoded_length = pos;
+   }
+
+   payload->complete = (pos == end);
+   return RBUS_WIRE_OK;
+}
+
+/*
+ * Method fields. Each decoder walks the objects before the marker in wire
+ * order; an object of an unexpected type ends the optional fields it could
+ * have been.
+ */
+typedef struct {
+   const uint8_t* data;
+   const rbus_mp_object_t* objects;
+   uint32_t count;
+   rbus_wire_method_fields_t* result;
+} field_walk_t;
+
+static void
+add_field(field_walk_t* walk, rbus_wire_field_id_t id, uint32_t index) {
+   rbus_wire_field_t* field = &walk->result->fields[walk->result->field_count++];
+
+   field->id = id;
+   field->offset = walk->objects[index].offset;
+}
+
+/* Add the object at *index as id if it is of type, and advance past it */
+static bool
+take_field(field_walk_t* walk, uint32_t* index, rbus_mp_type_t type, rbus_wire_field_id_t id) {
+   if (*index >= walk->count || walk->objects[*index].type != type) {
+      return false;
+   }
+   add_field(walk, id, (*index)++);
+   return true;
+}
+
+static bool
+is_integer(const rbus_mp_object_t* obj) {
+   return obj->type == RBUS_MP_UINT || obj->type == RBUS_MP_INT;
+}
+
+static int32_t
+integer_value(const rbus_mp_object_t* obj) {
+   return obj->type == RBUS_MP_UINT ? (int32_t)obj->via.u64 :
+      obj->type == RBUS_MP_INT ? (int32_t)obj->via.i64 : 0;
+}
+
+/* GET Request: [componentName, paramCount, parameterName, ...] */
+static void
+fields_get(field_walk_t* walk) {
+   uint32_t i = 0;
+
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_COMPONENT_NAME);
+   i = 1;
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_PARAM_COUNT);
+   for (i = 2; i < walk->count; i++) {
+      if (walk->objects[i].type == RBUS_MP_STR) {
+         add_field(walk, RBUS_FIELD_PARAMETER_NAME, i);
+      }
+   }
+}
+
+/* SUBSCRIBE/UNSUBSCRIBE Request: [eventName, replyTopic, hasPayload, payload, publishOnSubscribe, rawData, ...] */
+static void
+fields_subscribe(field_walk_t* walk) {
+   uint32_t i = 0;
+
+   if (take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_EVENT_NAME)) {
+      take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_REPLY_TOPIC);
+   }
+}
+
+/* RPC/Invoke Request: [sessionId, methodName, hasParams, params (optional)] */
+static void
+fields_rpc(field_walk_t* walk) {
+   uint32_t i = 0;
+
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_SESSION_ID);
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_INVOKE_METHOD_NAME);
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_HAS_PARAMS);
+}
+
+/* COMMIT Request: [sessionId, componentName, paramCount] */
+static void
+fields_commit(field_walk_t* walk) {
+   uint32_t i = 0;
+
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_SESSION_ID);
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_COMPONENT_NAME);
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_PARAM_COUNT);
+}
+
+/* GETPARAMETERNAMES/Discovery Request: [objectName, depth, getRowNamesOnly, ...] */
+static void
+fields_get_names(field_walk_t* walk) {
+   uint32_t i = 0;
+
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_PARAMETER_NAME);
+   /* Depth may be negative (-1 = unlimited) */
+   if (i < walk->count) {
+      add_field(walk, RBUS_FIELD_DISCOVERY_DEPTH, i++);
+   }
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_ROW_NAMES_ONLY);
+}
+
+/* GET/SETPARAMETERATTRIBUTES Request: [componentName, ...] */
+static void
+fields_attributes(field_walk_t* walk) {
+   uint32_t i = 0;
+
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_COMPONENT_NAME);
+   for (; i < walk->count; i++) {
+      if (walk->objects[i].type == RBUS_MP_STR) {
+         add_field(walk, RBUS_FIELD_PARAMETER_NAME, i);
+      } else if (walk->objects[i].type == RBUS_MP_UINT) {
+         add_field(walk, RBUS_FIELD_PARAM_COUNT, i);
+      }
+   }
+}
+
+/* Add Table Row: [sessionId, tableName, aliasName, ...] */
+static void
+fields_add_row(field_walk_t* walk) {
+   uint32_t i = 0;
+
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_SESSION_ID);
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_PARAMETER_NAME);
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_TABLE_ALIAS);
+}
+
+/* Delete Table Row: [sessionId, rowName, ...] */
+static void
+fields_delete_row(field_walk_t* walk) {
+   uint32_t i = 0;
+
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_SESSION_ID);
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_PARAMETER_NAME);
+}
+
+/* Direct connection requests: any string is a component name */
+static void
+fields_direct_conn(field_walk_t* walk) {
+   uint32_t i;
+
+   for (i = 0; i < walk->count; i++) {
+      if (walk->objects[i].type == RBUS_MP_STR) {
+         add_field(walk, RBUS_FIELD_COMPONENT_NAME, i);
+      }
+   }
+}
+
+/* SET Request: [sessionId, componentName, rollback, paramCount, params..., commit] */
+static void
+fields_set(field_walk_t* walk) {
+   uint32_t param_count = 0;
+   uint32_t i = 0;
+   uint32_t p;
+
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_SESSION_ID);
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_COMPONENT_NAME);
+   take_field(walk, &i, RBUS_MP_UINT, RBUS_FIELD_ROLLBACK);
+   if (i < walk->count && walk->objects[i].type == RBUS_MP_UINT) {
+      param_count = (uint32_t)walk->objects[i].via.u64;
+      add_field(walk, RBUS_FIELD_PARAM_COUNT, i++);
+   }
+
+   /* Parameters are name, type, value triplets */
+   for (p = 0; p < param_count && i + 2 < walk->count; p++, i += 3) {
+      add_field(walk, RBUS_FIELD_PARAMETER, i);
+   }
+   take_field(walk, &i, RBUS_MP_STR, RBUS_FIELD_COMMIT);
+}
+
+/*
+ * Response: [errorCode, propertyCount, properties...]. Newer peers put
+ * further fields between the two, so the property count is the first
+ * integer that is followed by what a count expects: a property name if it is
+ * non-zero, anything but another integer if it is zero. A simple error
+ * response has a failed element name instead of properties.
+ */
+static void
+fields_response(field_walk_t* walk) {
+   const rbus_mp_object_t* objects = walk->objects;
+   uint32_t prop_count = 0;
+   uint32_t i = 0;
+   uint32_t p;
+
+   if (i >= walk->count) {
+      return;
+   }
+   add_field(walk, RBUS_FIELD_ERROR_CODE, i++);
+   if (i >= walk->count) {
+      return;
+   }
+
+   if (integer_value(&objects[0]) != 0 && objects[i].type == RBUS_MP_STR && i + 1 < walk->count &&
+      objects[i + 1].type == RBUS_MP_STR && objects[i + 1].via.size >= 7 &&
+      memcmp(walk->data + objects[i + 1].data_offset, "METHOD_", 7) == 0) {
+      add_field(walk, RBUS_FIELD_FAILED_ELEMENT, i);
+      return;
+   }
+
+   for (; i < walk->count; i++) {
+      if (!is_integer(&objects[i]) || i + 1 >= walk->count) {
+         continue;
+      }
+      prop_count = (uint32_t)integer_value(&objects[i]);
+      if ((prop_count > 0 && objects[i + 1].type == RBUS_MP_STR) ||
+         (prop_count == 0 && !is_integer(&objects[i + 1]))) {
+         add_field(walk, RBUS_FIELD_PROPERTY_COUNT, i++);
+         break;
+      }
+      prop_count = 0;
+   }
+
+   for (p = 0; p < prop_count && i + 2 < walk->count; p++, i += 3) {
+      add_field(walk, RBUS_FIELD_PROPERTY, i);
+   }
+}
+
+typedef void (*field_decoder_t)(field_walk_t* walk);
+
+static const field_decoder_t field_decoders[RBUS_METHOD_COUNT] = {
+   [RBUS_METHOD_GETPARAMETERVALUES] = fields_get,
+   [RBUS_METHOD_SETPARAMETERVALUES] = fields_set,
+   [RBUS_METHOD_GETPARAMETERNAMES] = fields_get_names,
+   [RBUS_METHOD_GETPARAMETERATTRIBUTES] = fields_attributes,
+   [RBUS_METHOD_SETPARAMETERATTRIBUTES] = fields_attributes,
+   [RBUS_METHOD_COMMIT] = fields_commit,
+   [RBUS_METHOD_SUBSCRIBE] = fields_subscribe,
+   [RBUS_METHOD_UNSUBSCRIBE] = fields_subscribe,
+   [RBUS_METHOD_RPC] = fields_rpc,
+   [RBUS_METHOD_ADDTBLROW] = fields_add_row,
+   [RBUS_METHOD_DELETETBLROW] = fields_delete_row,
+   [RBUS_METHOD_OPENDIRECT_CONN] = fields_direct_conn,
+   [RBUS_METHOD_CLOSEDIRECT_CONN] = fields_direct_conn,
+   [RBUS_METHOD_RESPONSE] = fields_response,
+};
+
+void
+rbus_wire_method_fields(const uint8_t* data, const rbus_mp_object_t* objects, uint32_t method_index,
+   rbus_method_t method, rbus_wire_field_t* fields, rbus_wire_method_fields_t* result) {
+   field_walk_t walk = { data, objects, method_index, result };
+
+   memset(result, 0, sizeof(*result));
+   result->method = method;
+   result->method_index = method_index;
+   result->fields = fields;
+
+   if (method < RBUS_METHOD_COUNT && field_decoders[method]) {
+      field_decoders[method](&walk);
+   }
+
+   switch (method) {
+      case RBUS_METHOD_SETPARAMETERVALUES:
+      case RBUS_METHOD_COMMIT:
+         /* The transaction view: session ID first; a SET also needs its count and commit flag */
+         if (method_index < 1 || objects[0].type != RBUS_MP_UINT) {
+            break;
+         }
+         result->session_id = (uint32_t)objects[0].via.u64;
+         result->commit = true;
+         if (method == RBUS_METHOD_SETPARAMETERVALUES) {
+            const rbus_mp_object_t* commit = &objects[method_index - 1];
+
+            if (method_index < 5) {
+               break;
+            }
+            if (objects[3].type == RBUS_MP_UINT) {
+               result->param_count = (uint32_t)objects[3].via.u64;
+            }
+            if (commit->type == RBUS_MP_STR) {
+               result->commit = commit->via.size == 4 && memcmp(data + commit->data_offset, "TRUE", 4) == 0;
+            }
+         }
+         result->set_request = true;
+         break;
+
+      case RBUS_METHOD_RESPONSE:
+         if (method_index >= 1) {
+            result->error_code = integer_value(&objects[0]);
+         }
+         break;
+
+      default:
+         break;
+   }
+}
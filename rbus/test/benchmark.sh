@@ -0,0 +1,143 @@
+#!/bin/sh
+#
+# benchmark.sh - End-to-end tshark throughput benchmark for the RBus plugin
+#
+# Copyright 2026
+# Licensed under the Apache License, Version 2.0
+#
+# Generates one capture per traffic mix with rbus-capture-gen, dissects each
+# with tshark and the freshly built plugin, and reports packets/s, us/packet
+# and peak RSS. Normally run through "make benchmark".
+#
+# Usage: benchmark.sh <work dir>
+#
+# Environment:
+#   TSHARK                  tshark binary (default: tshark)
+#   RBUS_CAPTURE_GEN        rbus-capture-gen binary
+#   RBUS_PLUGIN             Built rbus.so
+#   RBUS_BENCH_OPERATIONS   Operations per capture (default 100000)
+#   RBUS_BENCH_RUNS         tshark runs per capture; the fastest counts (default 3)
+#   RBUS_BENCH_TSHARK_ARGS  Dissection options (default "-n -V", a full decode)
+#   RBUS_BENCH_BASELINE     results.tsv of an earlier run to compare against
+#   RBUS_BENCH_TOLERANCE    Allowed us/packet increase over the baseline, in % (default 10)
+#
+# Exits non-zero if any mix is slower than the baseline by more than the tolerance.
+
+set -eu
+
+WORK=${1:-benchmark}
+TSHARK=${TSHARK:-tshark}
+RBUS_CAPTURE_GEN=${RBUS_CAPTURE_GEN:-rbus-capture-gen}
+OPERATIONS=${RBUS_BENCH_OPERATIONS:-100000}
+RUNS=${RBUS_BENCH_RUNS:-3}
+TSHARK_ARGS=${RBUS_BENCH_TSHARK_ARGS:--n -V}
+BASELINE=${RBUS_BENCH_BASELINE:-}
+TOLERANCE=${RBUS_BENCH_TOLERANCE:-10}
+
+# name|rbus-capture-gen options
+MIXES="
+mixed|-m mixed
+get|-m get
+set|-m set
+events|-m events
+events-forwarded|-m events -f
+control|-m control
+large-mss|-m get=50,set=50 -p 2000-8000 -s mss:1448
+fragmented|-m mixed -s random:64
+coalesced|-m mixed -s coalesce:8
+"
+
+if [ -z "${RBUS_PLUGIN:-}" ] || [ ! -f "$RBUS_PLUGIN" ]; then
+   echo "RBUS_PLUGIN must point at the built rbus.so" >&2
+   exit 1
+fi
+
+mkdir -p "$WORK"
+WORK=$(cd "$WORK" && pwd)
+
+# Load only the plugin under test: a private plugin directory, and a private
+# HOME so personal preferences and personally installed plugins stay out
+VERSION=$("$TSHARK" --version | sed -n '1s/^[^0-9]*\([0-9][0-9]*\)\.\([0-9][0-9]*\)\..*/\1.\2/p')
+if [ "$(uname)" = "Darwin" ]; then
+   VERSION=$(echo "$VERSION" | tr . -)
+fi
+mkdir -p "$WORK/plugins/$VERSION/epan" "$WORK/home"
+ln -sf "$RBUS_PLUGIN" "$WORK/plugins/$VERSION/epan/rbus.so"
+WIRESHARK_PLUGIN_DIR="$WORK/plugins"
+HOME="$WORK/home"
+export WIRESHARK_PLUGIN_DIR HOME
+
+if ! "$TSHARK" -G plugins 2>/dev/null | grep -q "$WORK/plugins"; then
+   echo "tshark did not load $RBUS_PLUGIN" >&2
+   exit 1
+fi
+
+# Print "<elapsed seconds> <peak RSS in KiB>" for a command, discarding its output
+if /usr/bin/time -f '%e %M' true >/dev/null 2>&1; then
+   GNU_TIME=1
+else
+   GNU_TIME=0
+fi
+
+measure() {
+   if [ "$GNU_TIME" = 1 ]; then
+      /usr/bin/time -f '%e %M' -o "$WORK/time.out" "$@" >/dev/null 2>"$WORK/tshark.err" || return 1
+      tail -n 1 "$WORK/time.out"
+   else
+      # BSD time: "-l" reports the peak RSS in bytes
+      /usr/bin/time -l "$@" >/dev/null 2>"$WORK/time.out" || return 1
+      awk '/ real /{ e = $1 } /maximum resident set size/{ m = int($1 / 1024) } END { print e, m }' "$WORK/time.out"
+   fi
+}
+
+RESULTS="$WORK/results.tsv"
+printf 'mix\tframes\tseconds\tpackets_per_sec\tus_per_packet\tpeak_rss_kb\n' >"$RESULTS"
+printf '%-12s %10s %9s %12s %10s %12s\n' "Mix" "Frames" "Seconds" "Packets/s" "us/packet" "Peak RSS KiB"
+
+echo "$MIXES" | while IFS='|' read -r name options; do
+   [ -n "$name" ] || continue
+   capture="$WORK/$name.pcapng"
+
+   # shellcheck disable=SC2086 # options is a word list
+   frames=$("$RBUS_CAPTURE_GEN" $options -n "$OPERATIONS" -w "$capture" | sed 's/.*: \([0-9]*\) frames.*/\1/')
+
+   best=""
+   rss=0
+   run=0
+   while [ "$run" -lt "$RUNS" ]; do
+      # shellcheck disable=SC2086 # TSHARK_ARGS is a word list
+      if ! timing=$(measure "$TSHARK" $TSHARK_ARGS -d tcp.port==10002,rbus -r "$capture"); then
+         echo "tshark failed on $capture" >&2
+         cat "$WORK/tshark.err" "$WORK/time.out" >&2 2>/dev/null || true
+         exit 1
+      fi
+      set -- $timing
+      best=$(awk -v a="$1" -v b="$best" 'BEGIN { print (b == "" || a < b) ? a : b }')
+      if [ "$2" -gt "$rss" ]; then
+         rss=$2
+      fi
+      run=$((run + 1))
+   done
+
+   awk -v name="$name" -v frames="$frames" -v secs="$best" -v rss="$rss" -v results="$RESULTS" 'BEGIN {
+      if (secs <= 0) secs = 0.01
+      printf "%-12s %10d %9.2f %12.0f %10.2f %12d\n", name, frames, secs, frames / secs, secs * 1e6 / frames, rss
+      printf "%s\t%d\t%.2f\t%.0f\t%.2f\t%d\n", name, frames, secs, frames / secs, secs * 1e6 / frames, rss >> results
+   }'
+done
+
+echo "Results written to $RESULTS"
+
+if [ -n "$BASELINE" ]; then
+   echo "Comparing with $BASELINE (tolerance ${TOLERANCE}%)"
+   awk -F '\t' -v tol="$TOLERANCE" '
+      FNR == 1 { next }
+      NR == FNR { base[$1] = $5; next }
+      ($1 in base) && base[$1] > 0 {
+         change = ($5 - base[$1]) * 100 / base[$1]
+         flag = (change > tol) ? "REGRESSION" : "ok"
+         printf "%-12s %10.2f -> %10.2f us/packet (%+.1f%%) %s\n", $1, base[$1], $5, change, flag
+         if (change > tol) failed = 1
+      }
+      END { exit failed }' "$BASELINE" "$RESULTS"
+fi
@@ -0,0 +1,876 @@
+/*
+ * epan-stub.c - Minimal stand-in for the epan API used by packet-rbus.c
+ *
+ * Copyright 2026
+ * Licensed under the Apache License, Version 2.0
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "epan-stub.h"
+
+uint64_t epan_stub_items_added = 0;
+
+const unit_name_string units_microseconds = { "\xC2\xB5s", NULL };
+const unit_name_string units_milliseconds = { "ms", NULL };
+const unit_name_string units_byte_bytes = { " byte", " bytes" };
+
+static void
+stub_abort(const char* what) {
+   fprintf(stderr, "epan-stub: %s\n", what);
+   abort();
+}
+
+/*
+ * wmem: bump allocation from a chain of blocks. Each allocation is preceded
+ * by its size so wmem_realloc can copy it; nothing is freed until the
+ * allocator is reset.
+ */
+#define STUB_BLOCK_SIZE (1u << 20)
+#define STUB_ALIGN 16
+
+typedef struct stub_block {
+   struct stub_block* next;
+   size_t size;
+   size_t used;
+   uint8_t* data;
+} stub_block_t;
+
+struct _wmem_allocator_t {
+   stub_block_t* blocks;
+};
+
+static wmem_allocator_t file_scope;
+static wmem_allocator_t packet_scope;
+
+wmem_allocator_t*
+wmem_file_scope(void) {
+   return &file_scope;
+}
+
+static void
+stub_allocator_reset(wmem_allocator_t* allocator) {
+   stub_block_t* block = allocator->blocks;
+
+   if (!block) {
+      return;
+   }
+   /* Keep the first block (normally the largest one) for reuse */
+   while (block->next) {
+      stub_block_t* next = block->next;
+      block->next = next->next;
+      free(next->data);
+      free(next);
+   }
+   block->used = 0;
+}
+
+void*
+wmem_alloc(wmem_allocator_t* allocator, size_t size) {
+   size_t needed = STUB_ALIGN + ((size + STUB_ALIGN - 1) & ~(size_t)(STUB_ALIGN - 1));
+   stub_block_t* block = allocator->blocks;
+   uint8_t* chunk;
+
+   if (!block || block->used + needed > block->size) {
+      block = (stub_block_t*)calloc(1, sizeof(*block));
+      if (!block) {
+         stub_abort("out of memory");
+      }
+      block->size = needed > STUB_BLOCK_SIZE ? needed : STUB_BLOCK_SIZE;
+      block->data = (uint8_t*)malloc(block->size);
+      if (!block->data) {
+         stub_abort("out of memory");
+      }
+      block->next = allocator->blocks;
+      allocator->blocks = block;
+   }
+   chunk = block->data + block->used;
+   block->used += needed;
+   *(size_t*)chunk = size;
+   return chunk + STUB_ALIGN;
+}
+
+void*
+wmem_alloc0(wmem_allocator_t* allocator, size_t size) {
+   return memset(wmem_alloc(allocator, size), 0, size);
+}
+
+void*
+wmem_realloc(wmem_allocator_t* allocator, void* ptr, size_t size) {
+   void* copy = wmem_alloc(allocator, size);
+
+   if (ptr) {
+      size_t old_size = *(size_t*)((uint8_t*)ptr - STUB_ALIGN);
+      memcpy(copy, ptr, old_size < size ? old_size : size);
+   }
+   return copy;
+}
+
+/* Freed chunks are reclaimed when the allocator is reset */
+void
+wmem_free(wmem_allocator_t* allocator _U_, void* ptr _U_) {
+}
+
+void*
+wmem_memdup(wmem_allocator_t* allocator, const void* source, size_t size) {
+   return memcpy(wmem_alloc(allocator, size), source, size);
+}
+
+char*
+wmem_strdup(wmem_allocator_t* allocator, const char* src) {
+   return (char*)wmem_memdup(allocator, src, strlen(src) + 1);
+}
+
+char*
+wmem_strdup_printf(wmem_allocator_t* allocator, const char* fmt, ...) {
+   va_list ap;
+   int length;
+   char* str;
+
+   va_start(ap, fmt);
+   length = vsnprintf(NULL, 0, fmt, ap);
+   va_end(ap);
+   str = (char*)wmem_alloc(allocator, (size_t)length + 1);
+   va_start(ap, fmt);
+   vsnprintf(str, (size_t)length + 1, fmt, ap);
+   va_end(ap);
+   return str;
+}
+
+/* Maps are only created in file scope, which lives as long as the process */
+struct _wmem_map_t {
+   GHashTable* table;
+};
+
+wmem_map_t*
+wmem_map_new(wmem_allocator_t* allocator, GHashFunc hash_func, GEqualFunc eql_func) {
+   wmem_map_t* map = wmem_new(allocator, wmem_map_t);
+   map->table = g_hash_table_new_full(hash_func, eql_func, NULL, NULL);
+   return map;
+}
+
+void*
+wmem_map_insert(wmem_map_t* map, const void* key, void* value) {
+   void* old = g_hash_table_lookup(map->table, key);
+   g_hash_table_insert(map->table, (gpointer)key, value);
+   return old;
+}
+
+void*
+wmem_map_lookup(wmem_map_t* map, const void* key) {
+   return g_hash_table_lookup(map->table, key);
+}
+
+void*
+wmem_map_remove(wmem_map_t* map, const void* key) {
+   void* old = g_hash_table_lookup(map->table, key);
+   g_hash_table_remove(map->table, key);
+   return old;
+}
+
+unsigned
+wmem_map_size(wmem_map_t* map) {
+   return g_hash_table_size(map->table);
+}
+
+struct _wmem_array_t {
+   wmem_allocator_t* allocator;
+   size_t elem_size;
+   unsigned count;
+   unsigned capacity;
+   uint8_t* data;
+};
+
+wmem_array_t*
+wmem_array_new(wmem_allocator_t* allocator, const size_t elem_size) {
+   wmem_array_t* array = wmem_new0(allocator, wmem_array_t);
+   array->allocator = allocator;
+   array->elem_size = elem_size;
+   return array;
+}
+
+void
+wmem_array_append(wmem_array_t* array, const void* in, unsigned count) {
+   if (array->count + count > array->capacity) {
+      unsigned capacity = array->capacity ? array->capacity : 32;
+
+      while (capacity < array->count + count) {
+         capacity *= 2;
+      }
+      array->data = (uint8_t*)wmem_realloc(array->allocator, array->data, capacity * array->elem_size);
+      array->capacity = capacity;
+   }
+   memcpy(array->data + array->count * array->elem_size, in, count * array->elem_size);
+   array->count += count;
+}
+
+void*
+wmem_array_index(wmem_array_t* array, unsigned array_index) {
+   if (array_index >= array->count) {
+      stub_abort("wmem_array_index out of range");
+   }
+   return array->data + array_index * array->elem_size;
+}
+
+unsigned
+wmem_array_get_count(wmem_array_t* array) {
+   return array->count;
+}
+
+void
+nstime_set_zero(nstime_t* t) {
+   t->secs = 0;
+   t->nsecs = 0;
+}
+
+void
+nstime_delta(nstime_t* delta, const nstime_t* b, const nstime_t* a) {
+   delta->secs = b->secs - a->secs;
+   delta->nsecs = b->nsecs - a->nsecs;
+   if (delta->nsecs < 0) {
+      delta->nsecs += 1000000000;
+      delta->secs--;
+   }
+}
+
+int
+nstime_cmp(const nstime_t* a, const nstime_t* b) {
+   if (a->secs != b->secs) {
+      return a->secs < b->secs ? -1 : 1;
+   }
+   return a->nsecs < b->nsecs ? -1 : a->nsecs > b->nsecs;
+}
+
+double
+nstime_to_sec(const nstime_t* t) {
+   return (double)t->secs + (double)t->nsecs / 1000000000.0;
+}
+
+/*
+ * tvbuffs
+ */
+static void
+tvb_check(const tvbuff_t* tvb, int offset, int length) {
+   if (offset < 0 || length < 0 || (unsigned)offset > tvb->length || (unsigned)length > tvb->length - (unsigned)offset) {
+      stub_abort("tvb access out of bounds");
+   }
+}
+
+unsigned
+tvb_captured_length(const tvbuff_t* tvb) {
+   return tvb->length;
+}
+
+int
+tvb_captured_length_remaining(const tvbuff_t* tvb, const int offset) {
+   tvb_check(tvb, offset, 0);
+   return (int)(tvb->length - (unsigned)offset);
+}
+
+uint8_t
+tvb_get_uint8(tvbuff_t* tvb, const int offset) {
+   tvb_check(tvb, offset, 1);
+   return tvb->data[offset];
+}
+
+uint16_t
+tvb_get_ntohs(tvbuff_t* tvb, const int offset) {
+   tvb_check(tvb, offset, 2);
+   return (uint16_t)((tvb->data[offset] << 8) | tvb->data[offset + 1]);
+}
+
+const uint8_t*
+tvb_get_ptr(tvbuff_t* tvb, const int offset, const int length) {
+   tvb_check(tvb, offset, length < 0 ? tvb_captured_length_remaining(tvb, offset) : length);
+   return tvb->data + offset;
+}
+
+uint8_t*
+tvb_get_string_enc(wmem_allocator_t* scope, tvbuff_t* tvb, const int offset, const int length,
+   const unsigned encoding _U_) {
+   uint8_t* str;
+
+   tvb_check(tvb, offset, length);
+   str = (uint8_t*)wmem_alloc(scope, (size_t)length + 1);
+   memcpy(str, tvb->data + offset, (size_t)length);
+   str[length] = '\0';
+   return str;
+}
+
+int
+tvb_memeql(tvbuff_t* tvb, const int offset, const uint8_t* str, size_t size) {
+   if (offset < 0 || (unsigned)offset > tvb->length || size > tvb->length - (unsigned)offset) {
+      return -1;
+   }
+   return memcmp(tvb->data + offset, str, size) == 0 ? 0 : -1;
+}
+
+/*
+ * Field registry
+ */
+static header_field_info** fields = NULL;
+static int field_count = 0;
+static int subtree_count = 0;
+static int protocol_count = 0;
+
+int
+proto_register_protocol(const char* name _U_, const char* short_name _U_, const char* filter_name _U_) {
+   return ++protocol_count;
+}
+
+void
+proto_register_field_array(const int parent, hf_register_info* hf, const int num_records) {
+   int i;
+
+   fields = (header_field_info**)realloc(fields, sizeof(*fields) * (size_t)(field_count + num_records));
+   if (!fields) {
+      stub_abort("out of memory");
+   }
+   for (i = 0; i < num_records; i++) {
+      hf[i].hfinfo.id = field_count;
+      hf[i].hfinfo.parent = parent;
+      fields[field_count] = &hf[i].hfinfo;
+      *hf[i].p_id = field_count++;
+   }
+}
+
+void
+proto_register_subtree_array(int* const* indices, const int num_indices) {
+   int i;
+
+   for (i = 0; i < num_indices; i++) {
+      *indices[i] = subtree_count++;
+   }
+}
+
+bool
+proto_field_is_referenced(proto_tree* tree, int proto_id _U_) {
+   return tree != NULL;
+}
+
+const char*
+try_val_to_str(const uint32_t val, const value_string* vs) {
+   for (; vs && vs->strptr; vs++) {
+      if (vs->value == val) {
+         return vs->strptr;
+      }
+   }
+   return NULL;
+}
+
+const char*
+val_to_str(wmem_allocator_t* scope, const uint32_t val, const value_string* vs, const char* fmt) {
+   const char* str = try_val_to_str(val, vs);
+   return str ? str : wmem_strdup_printf(scope, fmt, val);
+}
+
+/*
+ * Protocol trees: every item is the tree it was added to, as Wireshark does
+ * for items it fakes. Visible trees pay for formatting each label, which is
+ * the dominant per-item cost in a real tree.
+ */
+static char label_buffer[240];
+
+static const char*
+field_name(int hfindex) {
+   return (hfindex >= 0 && hfindex < field_count) ? fields[hfindex]->name : "?";
+}
+
+static proto_item*
+tree_add(proto_tree* tree) {
+   if (tree) {
+      epan_stub_items_added++;
+   }
+   return tree;
+}
+
+static void
+tree_format(proto_tree* tree, const char* format, va_list ap) {
+   if (tree && PTREE_DATA(tree)->visible) {
+      vsnprintf(label_buffer, sizeof(label_buffer), format, ap);
+   }
+}
+
+static void
+tree_label(proto_tree* tree, const char* format, ...) G_GNUC_PRINTF(2, 3);
+
+static void
+tree_label(proto_tree* tree, const char* format, ...) {
+   va_list ap;
+
+   va_start(ap, format);
+   tree_format(tree, format, ap);
+   va_end(ap);
+}
+
+#define TREE_ADD_FORMAT(tree, format) \
+   do { \
+      va_list ap; \
+      va_start(ap, format); \
+      tree_format(tree, format, ap); \
+      va_end(ap); \
+   } while (0)
+
+proto_item*
+proto_tree_add_item(proto_tree* tree, int hfindex, tvbuff_t* tvb, const int start, int length,
+   const unsigned encoding _U_) {
+   if (length > 0) {
+      tvb_check(tvb, start, length);
+   }
+   tree_label(tree, "%s", field_name(hfindex));
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_item_ret_uint(proto_tree* tree, int hfindex, tvbuff_t* tvb, const int start, int length,
+   const unsigned encoding _U_, uint32_t* retval) {
+   uint32_t value = 0;
+   int i;
+
+   tvb_check(tvb, start, length);
+   for (i = 0; i < length && i < 4; i++) {
+      value = (value << 8) | tvb->data[start + i];
+   }
+   if (retval) {
+      *retval = value;
+   }
+   tree_label(tree, "%s: %u", field_name(hfindex), value);
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_bitmask_ret_uint64(proto_tree* tree, tvbuff_t* tvb, const unsigned offset, const int hf_hdr,
+   const int ett _U_, int* const* fields_ _U_, const unsigned encoding _U_, uint64_t* retval) {
+   uint64_t value = 0;
+   int i;
+
+   tvb_check(tvb, (int)offset, 4);
+   for (i = 0; i < 4; i++) {
+      value = (value << 8) | tvb->data[offset + i];
+   }
+   if (retval) {
+      *retval = value;
+   }
+   tree_label(tree, "%s: 0x%08" PRIx64, field_name(hf_hdr), value);
+   return tree_add(tree);
+}
+
+proto_tree*
+proto_item_add_subtree(proto_item* pi, const int idx _U_) {
+   return pi;
+}
+
+proto_tree*
+proto_tree_add_subtree(proto_tree* tree, tvbuff_t* tvb _U_, int start _U_, int length _U_, int idx _U_,
+   proto_item** tree_item, const char* text) {
+   tree_label(tree, "%s", text);
+   tree_add(tree);
+   if (tree_item) {
+      *tree_item = tree;
+   }
+   return tree;
+}
+
+void
+proto_item_set_len(proto_item* pi _U_, const int length _U_) {
+}
+
+void
+proto_item_set_text(proto_item* pi, const char* format, ...) {
+   TREE_ADD_FORMAT(pi, format);
+}
+
+void
+proto_item_append_text(proto_item* pi, const char* format, ...) {
+   TREE_ADD_FORMAT(pi, format);
+}
+
+void
+proto_item_set_generated(proto_item* pi _U_) {
+}
+
+proto_item*
+proto_tree_add_string(proto_tree* tree, int hfindex, tvbuff_t* tvb _U_, int start _U_, int length _U_,
+   const char* value) {
+   tree_label(tree, "%s: %s", field_name(hfindex), value ? value : "");
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_uint(proto_tree* tree, int hfindex, tvbuff_t* tvb _U_, int start _U_, int length _U_,
+   uint32_t value) {
+   tree_label(tree, "%s: %u", field_name(hfindex), value);
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_int(proto_tree* tree, int hfindex, tvbuff_t* tvb _U_, int start _U_, int length _U_,
+   int32_t value) {
+   tree_label(tree, "%s: %d", field_name(hfindex), value);
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_uint64(proto_tree* tree, int hfindex, tvbuff_t* tvb _U_, int start _U_, int length _U_,
+   uint64_t value) {
+   tree_label(tree, "%s: %" PRIu64, field_name(hfindex), value);
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_int64(proto_tree* tree, int hfindex, tvbuff_t* tvb _U_, int start _U_, int length _U_,
+   int64_t value) {
+   tree_label(tree, "%s: %" PRId64, field_name(hfindex), value);
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_double(proto_tree* tree, int hfindex, tvbuff_t* tvb _U_, int start _U_, int length _U_,
+   double value) {
+   tree_label(tree, "%s: %g", field_name(hfindex), value);
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_boolean(proto_tree* tree, int hfindex, tvbuff_t* tvb _U_, int start _U_, int length _U_,
+   uint64_t value) {
+   tree_label(tree, "%s: %s", field_name(hfindex), value ? "True" : "False");
+   return tree_add(tree);
+}
+
+proto_item*
+proto_tree_add_time(proto_tree* tree, int hfindex, tvbuff_t* tvb _U_, int start _U_, int length _U_,
+   const nstime_t* value_ptr) {
+   tree_label(tree, "%s: %ld.%09d", field_name(hfindex), (long)value_ptr->secs, value_ptr->nsecs);
+   return tree_add(tree);
+}
+
+/* The *_format variants only differ in where the text comes from */
+#define DEFINE_ADD_FORMAT(name, value_type) \
+   proto_item* \
+   name(proto_tree* tree, int hfindex _U_, tvbuff_t* tvb _U_, int start _U_, int length _U_, \
+      value_type value _U_, const char* format, ...) { \
+      TREE_ADD_FORMAT(tree, format); \
+      return tree_add(tree); \
+   }
+
+DEFINE_ADD_FORMAT(proto_tree_add_string_format, const char*)
+DEFINE_ADD_FORMAT(proto_tree_add_string_format_value, const char*)
+DEFINE_ADD_FORMAT(proto_tree_add_uint64_format, uint64_t)
+DEFINE_ADD_FORMAT(proto_tree_add_uint64_format_value, uint64_t)
+DEFINE_ADD_FORMAT(proto_tree_add_int64_format, int64_t)
+DEFINE_ADD_FORMAT(proto_tree_add_int64_format_value, int64_t)
+DEFINE_ADD_FORMAT(proto_tree_add_double_format, double)
+DEFINE_ADD_FORMAT(proto_tree_add_double_format_value, double)
+DEFINE_ADD_FORMAT(proto_tree_add_boolean_format, uint64_t)
+DEFINE_ADD_FORMAT(proto_tree_add_boolean_format_value, uint64_t)
+DEFINE_ADD_FORMAT(proto_tree_add_bytes_format, const uint8_t*)
+DEFINE_ADD_FORMAT(proto_tree_add_bytes_format_value, const uint8_t*)
+
+proto_tree*
+epan_stub_tree_new(bool visible) {
+   proto_tree* tree = (proto_tree*)calloc(1, sizeof(*tree));
+   tree_data_t* data = (tree_data_t*)calloc(1, sizeof(*data));
+
+   if (!tree || !data) {
+      stub_abort("out of memory");
+   }
+   data->visible = visible;
+   tree->tree_data = data;
+   return tree;
+}
+
+/*
+ * Expert info
+ */
+static int expert_count = 0;
+
+expert_module_t*
+expert_register_protocol(int id _U_) {
+   static int module;
+   return (expert_module_t*)&module;
+}
+
+void
+expert_register_field_array(expert_module_t* module _U_, ei_register_info* ei, const int num_records) {
+   int i;
+
+   for (i = 0; i < num_records; i++) {
+      ei[i].ids->ei = expert_count++;
+   }
+}
+
+proto_item*
+expert_add_info(packet_info* pinfo _U_, proto_item* pi, expert_field* eiindex _U_) {
+   return tree_add(pi);
+}
+
+proto_item*
+expert_add_info_format(packet_info* pinfo _U_, proto_item* pi, expert_field* eiindex _U_, const char* format, ...) {
+   TREE_ADD_FORMAT(pi, format);
+   return tree_add(pi);
+}
+
+proto_item*
+proto_tree_add_expert_format(proto_tree* tree, packet_info* pinfo _U_, expert_field* eiindex _U_,
+   tvbuff_t* tvb _U_, int start _U_, int length _U_, const char* format, ...) {
+   TREE_ADD_FORMAT(tree, format);
+   return tree_add(tree);
+}
+
+/*
+ * Columns: benchmarks run without column info
+ */
+void
+col_set_str(column_info* cinfo _U_, const int col _U_, const char* str _U_) {
+}
+
+void
+col_clear(column_info* cinfo _U_, const int col _U_) {
+}
+
+void
+col_append_str(column_info* cinfo _U_, const int col _U_, const char* str _U_) {
+}
+
+void
+col_append_fstr(column_info* cinfo _U_, const int col _U_, const char* format _U_, ...) {
+}
+
+void
+col_append_sep_str(column_info* cinfo _U_, const int col _U_, const char* sep _U_, const char* str _U_) {
+}
+
+void
+col_append_sep_fstr(column_info* cinfo _U_, const int col _U_, const char* sep _U_, const char* format _U_, ...) {
+}
+
+/*
+ * Dissector registration, per-packet data and conversations
+ */
+dissector_handle_t
+register_dissector(const char* name _U_, dissector_t dissector _U_, const int proto _U_) {
+   static int handle;
+   return (dissector_handle_t)&handle;
+}
+
+void
+heur_dissector_add(const char* name _U_, heur_dissector_t dissector _U_, const char* display_name _U_,
+   const char* internal_name _U_, const int proto _U_, int enable _U_) {
+}
+
+void
+dissector_add_uint(const char* name _U_, const uint32_t pattern _U_, dissector_handle_t handle _U_) {
+}
+
+#define STUB_MAX_INIT_ROUTINES 16
+
+static void (*init_routines[STUB_MAX_INIT_ROUTINES])(void);
+static int init_routine_count = 0;
+
+void
+register_init_routine(void (*func)(void)) {
+   if (init_routine_count == STUB_MAX_INIT_ROUTINES) {
+      stub_abort("too many init routines");
+   }
+   init_routines[init_routine_count++] = func;
+}
+
+void
+epan_stub_run_init_routines(void) {
+   int i;
+
+   for (i = 0; i < init_routine_count; i++) {
+      init_routines[i]();
+   }
+}
+
+/* Per-packet data of the current packet; a benchmark packet carries only a few entries */
+#define STUB_MAX_PROTO_DATA 64
+
+typedef struct {
+   int proto;
+   uint32_t key;
+   void* data;
+} stub_proto_data_t;
+
+static stub_proto_data_t proto_data[STUB_MAX_PROTO_DATA];
+static int proto_data_count = 0;
+
+void
+p_add_proto_data(wmem_allocator_t* scope _U_, packet_info* pinfo _U_, int proto, uint32_t key, void* data) {
+   if (proto_data_count == STUB_MAX_PROTO_DATA) {
+      stub_abort("too much per-packet data");
+   }
+   proto_data[proto_data_count].proto = proto;
+   proto_data[proto_data_count].key = key;
+   proto_data[proto_data_count].data = data;
+   proto_data_count++;
+}
+
+void*
+p_get_proto_data(wmem_allocator_t* scope _U_, packet_info* pinfo _U_, int proto, uint32_t key) {
+   int i;
+
+   for (i = proto_data_count - 1; i >= 0; i--) {
+      if (proto_data[i].proto == proto && proto_data[i].key == key) {
+         return proto_data[i].data;
+      }
+   }
+   return NULL;
+}
+
+void
+p_remove_proto_data(wmem_allocator_t* scope _U_, packet_info* pinfo _U_, int proto, uint32_t key) {
+   int i;
+
+   for (i = 0; i < proto_data_count; i++) {
+      if (proto_data[i].proto == proto && proto_data[i].key == key) {
+         proto_data[i] = proto_data[--proto_data_count];
+         return;
+      }
+   }
+}
+
+/* A single conversation is enough for decoding one payload at a time */
+struct _conversation {
+   int proto;
+   void* data;
+};
+
+static conversation_t conversation;
+
+conversation_t*
+find_or_create_conversation(packet_info* pinfo _U_) {
+   return &conversation;
+}
+
+void
+conversation_add_proto_data(conversation_t* conv, const int proto, void* data) {
+   conv->proto = proto;
+   conv->data = data;
+}
+
+void*
+conversation_get_proto_data(const conversation_t* conv, const int proto) {
+   return conv->proto == proto ? conv->data : NULL;
+}
+
+void
+conversation_set_dissector_from_frame_number(conversation_t* conv _U_, const uint32_t starting_frame_num _U_,
+   const dissector_handle_t handle _U_) {
+}
+
+int
+tcp_dissect_pdus(tvbuff_t* tvb _U_, packet_info* pinfo _U_, proto_tree* tree _U_, bool proto_desegment _U_,
+   const unsigned fixed_len _U_, unsigned (*get_pdu_len)(packet_info*, tvbuff_t*, int, void*) _U_,
+   dissector_t dissect_pdu _U_, void* dissector_data _U_) {
+   stub_abort("tcp_dissect_pdus is not available in the benchmark stub");
+   return 0;
+}
+
+/*
+ * Preferences, taps and statistics: registered and never used
+ */
+module_t*
+prefs_register_protocol(int id _U_, void (*apply_cb)(void) _U_) {
+   static int module;
+   return (module_t*)&module;
+}
+
+void
+prefs_register_uint_preference(module_t* module _U_, const char* name _U_, const char* title _U_,
+   const char* description _U_, unsigned base _U_, unsigned* var _U_) {
+}
+
+void
+prefs_register_bool_preference(module_t* module _U_, const char* name _U_, const char* title _U_,
+   const char* description _U_, bool* var _U_) {
+}
+
+int
+register_tap(const char* name _U_) {
+   return 1;
+}
+
+bool
+have_tap_listener(int tap_id _U_) {
+   return false;
+}
+
+void
+tap_queue_packet(int tap_id _U_, packet_info* pinfo _U_, const void* tap_specific_data _U_) {
+}
+
+void
+register_srt_table(const int proto_id _U_, const char* tap_listener _U_, int max_tables _U_,
+   tap_packet_cb srt_packet_func _U_, srt_init_cb init_cb _U_, srt_param_handler_cb param_cb _U_) {
+}
+
+srt_stat_table*
+init_srt_table(const char* name _U_, const char* short_name _U_, GArray* srt_array _U_, int num_procs _U_,
+   const char* proc_column_name _U_, const char* filter_string _U_, void* table_specific_data _U_) {
+   stub_abort("SRT tables are not available in the benchmark stub");
+   return NULL;
+}
+
+void
+init_srt_table_row(srt_stat_table* rst _U_, int proc_index _U_, const char* procedure _U_) {
+}
+
+void
+add_srt_table_data(srt_stat_table* rst _U_, int proc_index _U_, const nstime_t* req_time _U_,
+   packet_info* pinfo _U_) {
+}
+
+void
+stats_tree_register_plugin(const char* tapname _U_, const char* abbr _U_, const char* path _U_,
+   unsigned flags _U_, stat_tree_packet_cb packet _U_, stat_tree_init_cb init _U_,
+   stat_tree_cleanup_cb cleanup _U_) {
+}
+
+int
+stats_tree_create_node(stats_tree* st _U_, const char* name _U_, int parent_id _U_, int datatype _U_,
+   bool with_children _U_) {
+   return 0;
+}
+
+int
+tick_stat_node(stats_tree* st _U_, const char* name _U_, int parent_id _U_, bool with_children _U_) {
+   return 0;
+}
+
+int
+increase_stat_node(stats_tree* st _U_, const char* name _U_, int parent_id _U_, bool with_children _U_,
+   int value _U_) {
+   return 0;
+}
+
+int
+avg_stat_node_add_value_int(stats_tree* st _U_, const char* name _U_, int parent_id _U_,
+   bool with_children _U_, int value _U_) {
+   return 0;
+}
+
+void
+proto_register_plugin(const proto_plugin* plugin _U_) {
+}
+
+/*
+ * Packets
+ */
+void
+epan_stub_packet_init(packet_info* pinfo) {
+   static frame_data fd;
+
+   stub_allocator_reset(&packet_scope);
+   proto_data_count = 0;
+   memset(pinfo, 0, sizeof(*pinfo));
+   fd.num = 1;
+   fd.visited = 0;
+   pinfo->fd = &fd;
+   pinfo->num = 1;
+   pinfo->pool = &packet_scope;
+}
@@ -0,0 +1,475 @@
+/*
+ * epan-stub.h - Minimal stand-in for the epan API used by packet-rbus.c
+ *
+ * Copyright 2026
+ * Licensed under the Apache License, Version 2.0
+ *
+ * Lets the microbenchmarks compile the dissector on its own and call its
+ * payload decoders on in-memory buffers. Only the calls the dissector makes
+ * are provided. Tree items are counted and their label text is formatted
+ * (as Wireshark does for a visible tree), but nothing is kept; registration,
+ * conversations, taps and statistics are no-ops. GLib is the real one.
+ */
+
+#ifndef EPAN_STUB_H
+#define EPAN_STUB_H
+
+#include <glib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#define _U_ __attribute__((unused))
+#define WS_DLL_PUBLIC extern
+#define WS_DLL_PUBLIC_DEF
+#define WIRESHARK_VERSION_MAJOR 4
+#define WIRESHARK_VERSION_MINOR 6
+#define array_length(x) (sizeof(x) / sizeof((x)[0]))
+
+/*
+ * wmem: bump allocators that are reset as a whole
+ */
+typedef struct _wmem_allocator_t wmem_allocator_t;
+
+wmem_allocator_t* wmem_file_scope(void);
+void* wmem_alloc(wmem_allocator_t* allocator, size_t size);
+void* wmem_alloc0(wmem_allocator_t* allocator, size_t size);
+void* wmem_realloc(wmem_allocator_t* allocator, void* ptr, size_t size);
+void wmem_free(wmem_allocator_t* allocator, void* ptr);
+void* wmem_memdup(wmem_allocator_t* allocator, const void* source, size_t size);
+char* wmem_strdup(wmem_allocator_t* allocator, const char* src);
+char* wmem_strdup_printf(wmem_allocator_t* allocator, const char* fmt, ...) G_GNUC_PRINTF(2, 3);
+
+#define wmem_new(allocator, type) ((type*)wmem_alloc((allocator), sizeof(type)))
+#define wmem_new0(allocator, type) ((type*)wmem_alloc0((allocator), sizeof(type)))
+#define wmem_alloc_array(allocator, type, count) ((type*)wmem_alloc((allocator), sizeof(type) * (count)))
+#define wmem_alloc0_array(allocator, type, count) ((type*)wmem_alloc0((allocator), sizeof(type) * (count)))
+#define wmem_realloc_array(allocator, ptr, type, count) ((type*)wmem_realloc((allocator), (ptr), sizeof(type) * (count)))
+
+typedef struct _wmem_map_t wmem_map_t;
+
+wmem_map_t* wmem_map_new(wmem_allocator_t* allocator, GHashFunc hash_func, GEqualFunc eql_func);
+void* wmem_map_insert(wmem_map_t* map, const void* key, void* value);
+void* wmem_map_lookup(wmem_map_t* map, const void* key);
+void* wmem_map_remove(wmem_map_t* map, const void* key);
+unsigned wmem_map_size(wmem_map_t* map);
+
+typedef struct _wmem_array_t wmem_array_t;
+
+wmem_array_t* wmem_array_new(wmem_allocator_t* allocator, const size_t elem_size);
+void wmem_array_append(wmem_array_t* array, const void* in, unsigned count);
+#define wmem_array_append_one(array, val) wmem_array_append((array), &(val), 1)
+void* wmem_array_index(wmem_array_t* array, unsigned array_index);
+unsigned wmem_array_get_count(wmem_array_t* array);
+
+/*
+ * Time
+ */
+typedef struct {
+   time_t secs;
+   int nsecs;
+} nstime_t;
+
+void nstime_set_zero(nstime_t* t);
+void nstime_delta(nstime_t* delta, const nstime_t* b, const nstime_t* a);
+int nstime_cmp(const nstime_t* a, const nstime_t* b);
+double nstime_to_sec(const nstime_t* t);
+
+/*
+ * Packets
+ */
+typedef struct _frame_data {
+   uint32_t num;
+   unsigned visited : 1;
+} frame_data;
+
+typedef struct _column_info column_info;
+typedef struct _conversation conversation_t;
+
+typedef struct _packet_info {
+   frame_data* fd;
+   uint32_t num;
+   nstime_t abs_ts;
+   column_info* cinfo;
+   wmem_allocator_t* pool;
+   int desegment_offset;
+   uint32_t desegment_len;
+   uint32_t srcport;
+   uint32_t destport;
+   unsigned curr_layer_num;
+} packet_info;
+
+#define PINFO_FD_VISITED(pinfo) ((pinfo)->fd->visited)
+#define DESEGMENT_ONE_MORE_SEGMENT 0x0fffffff
+
+/*
+ * tvbuffs: a flat view of caller-owned bytes. Out-of-bounds access aborts
+ * instead of throwing, since no benchmark input should trigger one.
+ */
+typedef struct tvbuff {
+   const uint8_t* data;
+   unsigned length;
+} tvbuff_t;
+
+unsigned tvb_captured_length(const tvbuff_t* tvb);
+int tvb_captured_length_remaining(const tvbuff_t* tvb, const int offset);
+uint8_t tvb_get_uint8(tvbuff_t* tvb, const int offset);
+uint16_t tvb_get_ntohs(tvbuff_t* tvb, const int offset);
+const uint8_t* tvb_get_ptr(tvbuff_t* tvb, const int offset, const int length);
+uint8_t* tvb_get_string_enc(wmem_allocator_t* scope, tvbuff_t* tvb, const int offset, const int length,
+   const unsigned encoding);
+int tvb_memeql(tvbuff_t* tvb, const int offset, const uint8_t* str, size_t size);
+
+#define ENC_BIG_ENDIAN 0x00000000
+#define ENC_NA 0x00000000
+#define ENC_ASCII 0x00000000
+#define ENC_UTF_8 0x00000004
+
+/*
+ * Protocol trees
+ */
+enum ftenum {
+   FT_NONE, FT_PROTOCOL, FT_BOOLEAN, FT_UINT8, FT_UINT16, FT_UINT32, FT_UINT64, FT_INT32, FT_INT64,
+   FT_DOUBLE, FT_STRING, FT_BYTES, FT_FRAMENUM, FT_RELATIVE_TIME, FT_ABSOLUTE_TIME, FT_UINT_STRING
+};
+
+#define BASE_NONE 0
+#define BASE_DEC 1
+#define BASE_HEX 2
+#define BASE_DEC_HEX 3
+#define BASE_CUSTOM 4
+#define BASE_UNIT_STRING 0x1000
+
+enum {
+   FT_FRAMENUM_NONE, FT_FRAMENUM_REQUEST, FT_FRAMENUM_RESPONSE, FT_FRAMENUM_ACK, FT_FRAMENUM_DUP_ACK,
+   FT_FRAMENUM_RETRANS_PREV, FT_FRAMENUM_RETRANS_NEXT
+};
+#define FRAMENUM_TYPE(x) ((const void*)(uintptr_t)(x))
+
+typedef struct _value_string {
+   uint32_t value;
+   const char* strptr;
+} value_string;
+
+#define VALS(x) ((const void*)(x))
+#define UNS(x) ((const void*)(x))
+
+typedef struct {
+   const char* singular;
+   const char* plural;
+} unit_name_string;
+
+extern const unit_name_string units_microseconds;
+extern const unit_name_string units_milliseconds;
+extern const unit_name_string units_byte_bytes;
+
+const char* try_val_to_str(const uint32_t val, const value_string* vs);
+const char* val_to_str(wmem_allocator_t* scope, const uint32_t val, const value_string* vs, const char* fmt);
+
+typedef struct _header_field_info {
+   const char* name;
+   const char* abbrev;
+   int type;
+   int display;
+   const void* strings;
+   uint64_t bitmask;
+   const char* blurb;
+   int id;
+   int parent;
+   int ref_type;
+   int same_name_prev_id;
+   void* same_name_next;
+} header_field_info;
+
+typedef struct hf_register_info {
+   int* p_id;
+   header_field_info hfinfo;
+} hf_register_info;
+
+#define HFILL -1, 0, 0, 0, NULL
+
+typedef struct {
+   bool visible;
+} tree_data_t;
+
+typedef struct _proto_node {
+   tree_data_t* tree_data;
+} proto_node;
+
+typedef proto_node proto_tree;
+typedef proto_node proto_item;
+
+#define PTREE_DATA(proto_tree) ((proto_tree)->tree_data)
+
+int proto_register_protocol(const char* name, const char* short_name, const char* filter_name);
+void proto_register_field_array(const int parent, hf_register_info* hf, const int num_records);
+void proto_register_subtree_array(int* const* indices, const int num_indices);
+bool proto_field_is_referenced(proto_tree* tree, int proto_id);
+
+proto_item* proto_tree_add_item(proto_tree* tree, int hfindex, tvbuff_t* tvb, const int start, int length,
+   const unsigned encoding);
+proto_item* proto_tree_add_item_ret_uint(proto_tree* tree, int hfindex, tvbuff_t* tvb, const int start,
+   int length, const unsigned encoding, uint32_t* retval);
+proto_item* proto_tree_add_bitmask_ret_uint64(proto_tree* tree, tvbuff_t* tvb, const unsigned offset,
+   const int hf_hdr, const int ett, int* const* fields, const unsigned encoding, uint64_t* retval);
+proto_tree* proto_item_add_subtree(proto_item* pi, const int idx);
+proto_tree* proto_tree_add_subtree(proto_tree* tree, tvbuff_t* tvb, int start, int length, int idx,
+   proto_item** tree_item, const char* text);
+void proto_item_set_len(proto_item* pi, const int length);
+void proto_item_set_text(proto_item* pi, const char* format, ...) G_GNUC_PRINTF(2, 3);
+void proto_item_append_text(proto_item* pi, const char* format, ...) G_GNUC_PRINTF(2, 3);
+void proto_item_set_generated(proto_item* pi);
+
+proto_item* proto_tree_add_string(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   const char* value);
+proto_item* proto_tree_add_string_format(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   const char* value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_string_format_value(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start,
+   int length, const char* value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_uint(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   uint32_t value);
+proto_item* proto_tree_add_int(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   int32_t value);
+proto_item* proto_tree_add_uint64(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   uint64_t value);
+proto_item* proto_tree_add_uint64_format(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   uint64_t value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_uint64_format_value(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start,
+   int length, uint64_t value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_int64(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   int64_t value);
+proto_item* proto_tree_add_int64_format(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   int64_t value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_int64_format_value(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start,
+   int length, int64_t value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_double(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   double value);
+proto_item* proto_tree_add_double_format(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   double value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_double_format_value(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start,
+   int length, double value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_boolean(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   uint64_t value);
+proto_item* proto_tree_add_boolean_format(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   uint64_t value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_boolean_format_value(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start,
+   int length, uint64_t value, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_bytes_format(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   const uint8_t* start_ptr, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_bytes_format_value(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start,
+   int length, const uint8_t* start_ptr, const char* format, ...) G_GNUC_PRINTF(7, 8);
+proto_item* proto_tree_add_time(proto_tree* tree, int hfindex, tvbuff_t* tvb, int start, int length,
+   const nstime_t* value_ptr);
+
+/*
+ * Expert info
+ */
+typedef struct expert_field {
+   int ei;
+   int hf;
+} expert_field;
+
+#define EI_INIT { -1, -1 }
+
+typedef struct expert_field_info {
+   const char* name;
+   int group;
+   int severity;
+   const char* summary;
+   int id;
+   int hf;
+} expert_field_info;
+
+typedef struct ei_register_info {
+   expert_field* ids;
+   expert_field_info eiinfo;
+} ei_register_info;
+
+#define EXPFILL 0, 0
+
+#define PI_SEQUENCE 0x02000000
+#define PI_RESPONSE_CODE 0x03000000
+#define PI_REQUEST_CODE 0x04000000
+#define PI_UNDECODED 0x05000000
+#define PI_MALFORMED 0x07000000
+#define PI_PROTOCOL 0x09000000
+#define PI_PERFORMANCE 0x0d000000
+
+#define PI_CHAT 0x00200000
+#define PI_NOTE 0x00400000
+#define PI_WARN 0x00600000
+#define PI_ERROR 0x00800000
+
+typedef struct expert_module expert_module_t;
+
+expert_module_t* expert_register_protocol(int id);
+void expert_register_field_array(expert_module_t* module, ei_register_info* ei, const int num_records);
+proto_item* expert_add_info(packet_info* pinfo, proto_item* pi, expert_field* eiindex);
+proto_item* expert_add_info_format(packet_info* pinfo, proto_item* pi, expert_field* eiindex,
+   const char* format, ...) G_GNUC_PRINTF(4, 5);
+proto_item* proto_tree_add_expert_format(proto_tree* tree, packet_info* pinfo, expert_field* eiindex,
+   tvbuff_t* tvb, int start, int length, const char* format, ...) G_GNUC_PRINTF(7, 8);
+
+/*
+ * Columns
+ */
+#define COL_PROTOCOL 1
+#define COL_INFO 2
+
+void col_set_str(column_info* cinfo, const int col, const char* str);
+void col_clear(column_info* cinfo, const int col);
+void col_append_str(column_info* cinfo, const int col, const char* str);
+void col_append_fstr(column_info* cinfo, const int col, const char* format, ...) G_GNUC_PRINTF(3, 4);
+void col_append_sep_str(column_info* cinfo, const int col, const char* sep, const char* str);
+void col_append_sep_fstr(column_info* cinfo, const int col, const char* sep, const char* format, ...)
+   G_GNUC_PRINTF(4, 5);
+
+/*
+ * Dissector tables, per-packet data and conversations
+ */
+typedef int (*dissector_t)(tvbuff_t*, packet_info*, proto_tree*, void*);
+typedef bool (*heur_dissector_t)(tvbuff_t*, packet_info*, proto_tree*, void*);
+typedef struct dissector_handle* dissector_handle_t;
+
+#define HEURISTIC_ENABLE 1
+
+dissector_handle_t register_dissector(const char* name, dissector_t dissector, const int proto);
+void heur_dissector_add(const char* name, heur_dissector_t dissector, const char* display_name,
+   const char* internal_name, const int proto, int enable);
+void dissector_add_uint(const char* name, const uint32_t pattern, dissector_handle_t handle);
+void register_init_routine(void (*func)(void));
+
+void p_add_proto_data(wmem_allocator_t* scope, packet_info* pinfo, int proto, uint32_t key, void* proto_data);
+void* p_get_proto_data(wmem_allocator_t* scope, packet_info* pinfo, int proto, uint32_t key);
+void p_remove_proto_data(wmem_allocator_t* scope, packet_info* pinfo, int proto, uint32_t key);
+
+conversation_t* find_or_create_conversation(packet_info* pinfo);
+void conversation_add_proto_data(conversation_t* conv, const int proto, void* proto_data);
+void* conversation_get_proto_data(const conversation_t* conv, const int proto);
+void conversation_set_dissector_from_frame_number(conversation_t* conversation, const uint32_t starting_frame_num,
+   const dissector_handle_t handle);
+
+int tcp_dissect_pdus(tvbuff_t* tvb, packet_info* pinfo, proto_tree* tree, bool proto_desegment,
+   const unsigned fixed_len, unsigned (*get_pdu_len)(packet_info*, tvbuff_t*, int, void*),
+   dissector_t dissect_pdu, void* dissector_data);
+
+/*
+ * Preferences
+ */
+typedef struct pref_module module_t;
+
+module_t* prefs_register_protocol(int id, void (*apply_cb)(void));
+void prefs_register_uint_preference(module_t* module, const char* name, const char* title,
+   const char* description, unsigned base, unsigned* var);
+void prefs_register_bool_preference(module_t* module, const char* name, const char* title,
+   const char* description, bool* var);
+
+/*
+ * Taps, SRT tables and stats trees
+ */
+typedef struct epan_dissect epan_dissect_t;
+typedef enum {
+   TAP_PACKET_DONT_REDRAW,
+   TAP_PACKET_REDRAW,
+   TAP_PACKET_FAILED
+} tap_packet_status;
+typedef unsigned tap_flags_t;
+typedef tap_packet_status (*tap_packet_cb)(void*, packet_info*, epan_dissect_t*, const void*, tap_flags_t);
+
+int register_tap(const char* name);
+bool have_tap_listener(int tap_id);
+void tap_queue_packet(int tap_id, packet_info* pinfo, const void* tap_specific_data);
+
+#define TL_REQUIRES_NOTHING 0x00000000
+
+typedef struct {
+   uint32_t num;
+   uint32_t min_num;
+   uint32_t max_num;
+   nstime_t min;
+   nstime_t max;
+   nstime_t tot;
+   double variance;
+} timestat_t;
+
+typedef struct _srt_procedure_t {
+   int proc_index;
+   timestat_t stats;
+   char* procedure;
+} srt_procedure_t;
+
+typedef struct _srt_stat_table {
+   char* name;
+   char* short_name;
+   char* filter_string;
+   int num_procs;
+   char* proc_column_name;
+   srt_procedure_t* procedures;
+   void* table_specific_data;
+} srt_stat_table;
+
+typedef struct _srt_data_t {
+   GArray* srt_array;
+   void* user_data;
+} srt_data_t;
+
+struct register_srt;
+typedef void (*srt_init_cb)(struct register_srt*, GArray*);
+typedef unsigned (*srt_param_handler_cb)(struct register_srt*, const char*, char**);
+
+void register_srt_table(const int proto_id, const char* tap_listener, int max_tables,
+   tap_packet_cb srt_packet_func, srt_init_cb init_cb, srt_param_handler_cb param_cb);
+srt_stat_table* init_srt_table(const char* name, const char* short_name, GArray* srt_array, int num_procs,
+   const char* proc_column_name, const char* filter_string, void* table_specific_data);
+void init_srt_table_row(srt_stat_table* rst, int proc_index, const char* procedure);
+void add_srt_table_data(srt_stat_table* rst, int proc_index, const nstime_t* req_time, packet_info* pinfo);
+
+typedef struct _stats_tree stats_tree;
+typedef tap_packet_status (*stat_tree_packet_cb)(stats_tree*, packet_info*, epan_dissect_t*, const void*,
+   tap_flags_t);
+typedef void (*stat_tree_init_cb)(stats_tree*);
+typedef void (*stat_tree_cleanup_cb)(stats_tree*);
+
+#define STAT_DT_INT 0
+#define ST_FLG_SORT_TOP 0x00400000
+#define ST_FLG_DEF_NOEXPAND 0x01000000
+#define ST_SORT_COL_COUNT 2
+
+void stats_tree_register_plugin(const char* tapname, const char* abbr, const char* path, unsigned flags,
+   stat_tree_packet_cb packet, stat_tree_init_cb init, stat_tree_cleanup_cb cleanup);
+int stats_tree_create_node(stats_tree* st, const char* name, int parent_id, int datatype, bool with_children);
+int tick_stat_node(stats_tree* st, const char* name, int parent_id, bool with_children);
+int increase_stat_node(stats_tree* st, const char* name, int parent_id, bool with_children, int value);
+int avg_stat_node_add_value_int(stats_tree* st, const char* name, int parent_id, bool with_children, int value);
+
+/*
+ * Plugins
+ */
+#define WS_PLUGIN_DESC_DISSECTOR (1UL << 0)
+
+typedef struct {
+   void (*register_protoinfo)(void);
+   void (*register_handoff)(void);
+} proto_plugin;
+
+void proto_register_plugin(const proto_plugin* plugin);
+
+/*
+ * Benchmark hooks
+ */
+
+/* Tree items added since the last reset */
+extern uint64_t epan_stub_items_added;
+
+/* Root of a tree; visible trees have their label text formatted */
+proto_tree* epan_stub_tree_new(bool visible);
+
+/* Run the routines registered with register_init_routine, as at file open */
+void epan_stub_run_init_routines(void);
+
+/* Start a new packet: empties pinfo->pool and the per-packet data */
+void epan_stub_packet_init(packet_info* pinfo);
+
+#endif /* EPAN_STUB_H */
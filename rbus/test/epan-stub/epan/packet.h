@@ -0,0 +1,2 @@
+/* Forwards to the benchmark epan stub */
+#include "epan-stub.h"
@@ -0,0 +1,925 @@
+/*
+ * rbus-capture-gen.c - Generate synthetic RBus captures
+ *
+ * Copyright 2026
+ * Licensed under the Apache License, Version 2.0
+ *
+ * Writes a pcapng file of Ethernet/IPv4/TCP frames carrying RBus traffic
+ * between a number of clients and rtrouted on port 10002. The traffic mix,
+ * the size of property values and the way the TCP stream is cut into
+ * segments are configurable, so the same decoder paths can be exercised at
+ * scale: MessagePack requests and responses, events, JSON router control
+ * messages, and reassembly of messages split over or packed into segments.
+ *
+ * Output is deterministic for a given set of options and seed.
+ *
+ *   rbus-capture-gen -m mixed -n 100000 -w mixed.pcapng
+ *   rbus-capture-gen -m get=50,set=50 -p 2000-8000 -s mss:1448 -w large.pcapng
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rbus-protocol.h"
+#include "rbus-wire.h"
+
+/* pcapng block types */
+#define PCAPNG_BLOCK_SHB 0x0A0D0D0A
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define LINKTYPE_ETHERNET 1
+
+#define ETH_HEADER_LENGTH 14
+#define IPV4_HEADER_LENGTH 20
+#define TCP_HEADER_LENGTH 20
+#define FRAME_HEADER_LENGTH (ETH_HEADER_LENGTH + IPV4_HEADER_LENGTH + TCP_HEADER_LENGTH)
+#define MAX_SEGMENT_PAYLOAD (65535 - IPV4_HEADER_LENGTH - TCP_HEADER_LENGTH)
+
+#define TCP_FLAG_SYN 0x02
+#define TCP_FLAG_PSH 0x08
+#define TCP_FLAG_ACK 0x10
+
+/* Not in rbus-protocol.h: MessagePack payloads are sent with the raw binary flag */
+#define RTMSG_FLAG_RAW_BINARY 0x10
+
+/* RBus value type IDs */
+#define RBUS_TYPE_STRING 0x50E
+
+#define CLIENT_PORT_BASE 40000
+#define MAX_CONNECTIONS 1024
+#define PARAMETER_POOL_SIZE 256
+#define MAX_FANOUT 3             /* -f: subscribers each event is forwarded to */
+
+typedef enum {
+   KIND_GET,
+   KIND_SET,
+   KIND_EVENT,
+   KIND_CONTROL,
+   KIND_COUNT
+} traffic_kind_t;
+
+static const char* const kind_names[KIND_COUNT] = { "get", "set", "event", "control" };
+
+/* Named traffic mixes: weights in kind order */
+static const struct {
+   const char* name;
+   unsigned weights[KIND_COUNT];
+} mix_presets[] = {
+   { "mixed",   { 40, 10, 40, 10 } },
+   { "get",     { 100, 0, 0, 0 } },
+   { "set",     { 0, 100, 0, 0 } },
+   { "events",  { 0, 0, 100, 0 } },
+   { "control", { 0, 0, 0, 100 } },
+};
+
+typedef enum {
+   SEGMENT_WHOLE,       /* One segment per message */
+   SEGMENT_MSS,         /* Each message cut into segments of at most N bytes */
+   SEGMENT_RANDOM,      /* Each message cut at random points into 1..N byte segments */
+   SEGMENT_COALESCE     /* N consecutive messages in one direction packed into a segment */
+} segment_mode_t;
+
+typedef struct {
+   uint8_t* data;
+   size_t length;
+   size_t capacity;
+} buffer_t;
+
+typedef struct {
+   uint8_t client_ip[4];
+   uint16_t client_port;
+   uint32_t client_seq;         /* Next TCP sequence number, client to server */
+   uint32_t server_seq;         /* Next TCP sequence number, server to client */
+   uint32_t rbus_seq;           /* Last RBus sequence number used on this connection */
+   int established;
+   buffer_t pending[2];         /* SEGMENT_COALESCE: queued bytes per direction */
+   unsigned pending_count[2];
+} connection_t;
+
+enum { TO_SERVER = 0, TO_CLIENT = 1 };
+
+static const uint8_t server_ip[4] = { 10, 0, 0, 1 };
+
+/* Options */
+static unsigned weights[KIND_COUNT];
+static unsigned long operations = 10000;
+static unsigned connection_count = 8;
+static size_t value_min = 4;
+static size_t value_max = 64;
+static segment_mode_t segment_mode = SEGMENT_WHOLE;
+static size_t segment_size = 0;
+static uint64_t rng_state = 0x9E3779B97F4A7C15ull;
+static int forward_legs = 0;
+
+/* Output state */
+static connection_t connections[MAX_CONNECTIONS];
+static FILE* output = NULL;
+static uint64_t now_us = 1700000000ull * 1000000;
+static unsigned long frames_written = 0;
+static unsigned long messages_written = 0;
+static uint64_t bytes_written = 0;
+static uint8_t frame[FRAME_HEADER_LENGTH + MAX_SEGMENT_PAYLOAD];
+
+static void
+usage(const char* prog) {
+   fprintf(stderr,
+      "Usage: %s -w <file> [-m <mix>] [-n <operations>] [-c <connections>]\n"
+      "          [-p <min>-<max>] [-s <segmentation>] [-r <seed>] [-f]\n"
+      "  -w  pcapng output file\n"
+      "  -m  Traffic mix: mixed, get, set, events, control, or weights such as\n"
+      "      get=40,set=10,event=40,control=10 (default mixed). Every GET and SET\n"
+      "      request is followed by its METHOD_RESPONSE\n"
+      "  -n  Operations to generate (default 10000)\n"
+      "  -c  Client connections (default 8)\n"
+      "  -p  Property value size range in bytes (default 4-64)\n"
+      "  -s  TCP segmentation: whole, mss:<n>, random:<n> or coalesce:<n> (default whole)\n"
+      "  -r  Random seed\n"
+      "  -f  Also write the legs rtrouted forwards: each event is published by one\n"
+      "      client to the router, then copied to up to %d other clients\n",
+      prog, MAX_FANOUT);
+}
+
+/*
+ * Deterministic pseudo-random numbers (xorshift64*)
+ */
+static uint64_t
+rng_next(void) {
+   rng_state ^= rng_state >> 12;
+   rng_state ^= rng_state << 25;
+   rng_state ^= rng_state >> 27;
+   return rng_state * 0x2545F4914F6CDD1Dull;
+}
+
+/* Uniform in [lo, hi] */
+static uint64_t
+rng_range(uint64_t lo, uint64_t hi) {
+   return lo + rng_next() % (hi - lo + 1);
+}
+
+/*
+ * Growable byte buffer with big-endian and MessagePack writers
+ */
+static void
+buffer_reserve(buffer_t* buf, size_t extra) {
+   if (buf->length + extra > buf->capacity) {
+      size_t capacity = buf->capacity ? buf->capacity : 256;
+
+      while (capacity < buf->length + extra) {
+         capacity *= 2;
+      }
+      buf->data = realloc(buf->data, capacity);
+      if (!buf->data) {
+         perror("realloc");
+         exit(1);
+      }
+      buf->capacity = capacity;
+   }
+}
+
+static void
+put_bytes(buffer_t* buf, const void* data, size_t length) {
+   buffer_reserve(buf, length);
+   memcpy(buf->data + buf->length, data, length);
+   buf->length += length;
+}
+
+static void
+put_u8(buffer_t* buf, uint8_t value) {
+   put_bytes(buf, &value, 1);
+}
+
+static void
+put_be16(buffer_t* buf, uint16_t value) {
+   uint8_t be[2] = { (uint8_t)(value >> 8), (uint8_t)value };
+   put_bytes(buf, be, sizeof(be));
+}
+
+static void
+put_be32(buffer_t* buf, uint32_t value) {
+   uint8_t be[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value };
+   put_bytes(buf, be, sizeof(be));
+}
+
+static void
+mp_put_uint(buffer_t* buf, uint32_t value) {
+   if (value <= 0x7f) {
+      put_u8(buf, (uint8_t)value);
+   } else if (value <= 0xff) {
+      put_u8(buf, 0xcc);
+      put_u8(buf, (uint8_t)value);
+   } else if (value <= 0xffff) {
+      put_u8(buf, 0xcd);
+      put_be16(buf, (uint16_t)value);
+   } else {
+      put_u8(buf, 0xce);
+      put_be32(buf, value);
+   }
+}
+
+static void
+mp_put_str(buffer_t* buf, const char* str) {
+   size_t length = strlen(str);
+
+   if (length < 32) {
+      put_u8(buf, (uint8_t)(0xa0 | length));
+   } else if (length <= 0xff) {
+      put_u8(buf, 0xd9);
+      put_u8(buf, (uint8_t)length);
+   } else {
+      put_u8(buf, 0xda);
+      put_be16(buf, (uint16_t)length);
+   }
+   put_bytes(buf, str, length);
+}
+
+static void
+mp_put_bin(buffer_t* buf, const uint8_t* data, size_t length) {
+   if (length <= 0xff) {
+      put_u8(buf, 0xc4);
+      put_u8(buf, (uint8_t)length);
+   } else if (length <= 0xffff) {
+      put_u8(buf, 0xc5);
+      put_be16(buf, (uint16_t)length);
+   } else {
+      put_u8(buf, 0xc6);
+      put_be32(buf, (uint32_t)length);
+   }
+   put_bytes(buf, data, length);
+}
+
+/* RBUS_STRING value: type ID, then the NUL-terminated text as bin */
+static void
+mp_put_string_value(buffer_t* buf) {
+   static uint8_t text[1 << 16];
+   size_t length = (size_t)rng_range(value_min, value_max);
+   size_t i;
+
+   for (i = 0; i < length; i++) {
+      text[i] = (uint8_t)('a' + rng_next() % 26);
+   }
+   text[length] = 0;
+   mp_put_uint(buf, RBUS_TYPE_STRING);
+   mp_put_bin(buf, text, length + 1);
+}
+
+/* Trailing metadata: method, ot_parent, ot_state and the fixed int32 offset of the method */
+static void
+mp_put_metadata(buffer_t* buf, const char* method) {
+   uint32_t offset = (uint32_t)buf->length;
+
+   mp_put_str(buf, method);
+   mp_put_str(buf, "");
+   mp_put_str(buf, "");
+   put_u8(buf, 0xd2);
+   put_be32(buf, offset);
+}
+
+/*
+ * Names
+ */
+static char parameter_pool[PARAMETER_POOL_SIZE][96];
+
+static void
+init_parameter_pool(void) {
+   static const char* const templates[] = {
+      "Device.WiFi.Radio.%u.Channel",
+      "Device.WiFi.SSID.%u.SSID",
+      "Device.WiFi.AccessPoint.%u.AssociatedDeviceNumberOfEntries",
+      "Device.Ethernet.Interface.%u.Stats.BytesReceived",
+      "Device.IP.Interface.%u.IPv4Address.1.IPAddress",
+      "Device.Hosts.Host.%u.HostName",
+      "Device.DeviceInfo.X_RDKCENTRAL-COM_Param%u",
+      "Device.Time.X_Vendor_Zone%u.LocalTimeZone",
+   };
+   unsigned i;
+
+   for (i = 0; i < PARAMETER_POOL_SIZE; i++) {
+      snprintf(parameter_pool[i], sizeof(parameter_pool[i]),
+         templates[i % (sizeof(templates) / sizeof(templates[0]))], i / 8 + 1);
+   }
+}
+
+static const char*
+random_parameter(void) {
+   return parameter_pool[rng_next() % PARAMETER_POOL_SIZE];
+}
+
+static void
+client_inbox(const connection_t* conn, char* out, size_t size) {
+   snprintf(out, size, "rbus.client%u.INBOX.%u", (unsigned)(conn->client_port - CLIENT_PORT_BASE),
+      (unsigned)conn->client_port * 7);
+}
+
+static void
+client_component(const connection_t* conn, char* out, size_t size) {
+   snprintf(out, size, "client%u-%u", (unsigned)(conn->client_port - CLIENT_PORT_BASE),
+      (unsigned)conn->client_port * 7);
+}
+
+/*
+ * Message assembly: rtMessage header without roundtrip times, then the payload
+ */
+static void
+build_message(buffer_t* msg, uint32_t seq, uint32_t flags, const char* topic, const char* reply_topic,
+   const buffer_t* payload) {
+   size_t topic_length = strlen(topic);
+   size_t reply_length = strlen(reply_topic);
+
+   msg->length = 0;
+   put_be16(msg, RBUS_WIRE_MARKER);
+   put_be16(msg, 2);
+   put_be16(msg, (uint16_t)(32 + topic_length + reply_length));
+   put_be32(msg, seq);
+   put_be32(msg, flags);
+   put_be32(msg, 0);
+   put_be32(msg, (uint32_t)payload->length);
+   put_be32(msg, (uint32_t)topic_length);
+   put_bytes(msg, topic, topic_length);
+   put_be32(msg, (uint32_t)reply_length);
+   put_bytes(msg, reply_topic, reply_length);
+   put_be16(msg, RBUS_WIRE_MARKER);
+   put_bytes(msg, payload->data, payload->length);
+}
+
+/*
+ * pcapng output, in host byte order; readers detect it from the byte-order magic
+ */
+static void
+write_u16(uint16_t value) {
+   fwrite(&value, sizeof(value), 1, output);
+}
+
+static void
+write_u32(uint32_t value) {
+   fwrite(&value, sizeof(value), 1, output);
+}
+
+static void
+write_pcapng_header(void) {
+   write_u32(PCAPNG_BLOCK_SHB);
+   write_u32(28);
+   write_u32(PCAPNG_BYTE_ORDER_MAGIC);
+   write_u16(1);                /* Version 1.0 */
+   write_u16(0);
+   write_u32(0xFFFFFFFF);       /* Section length -1 */
+   write_u32(0xFFFFFFFF);
+   write_u32(28);
+
+   write_u32(PCAPNG_BLOCK_IDB);
+   write_u32(20);
+   write_u16(LINKTYPE_ETHERNET);
+   write_u16(0);                /* Reserved */
+   write_u32(0);                /* Snaplen */
+   write_u32(20);
+}
+
+static void
+store_be16(uint8_t* p, uint16_t value) {
+   p[0] = (uint8_t)(value >> 8);
+   p[1] = (uint8_t)value;
+}
+
+static void
+store_be32(uint8_t* p, uint32_t value) {
+   p[0] = (uint8_t)(value >> 24);
+   p[1] = (uint8_t)(value >> 16);
+   p[2] = (uint8_t)(value >> 8);
+   p[3] = (uint8_t)value;
+}
+
+/* Ones' complement sum of big-endian 16-bit words */
+static uint32_t
+checksum_add(uint32_t sum, const uint8_t* data, size_t length) {
+   size_t i;
+
+   for (i = 0; i + 1 < length; i += 2) {
+      sum += ((uint32_t)data[i] << 8) | data[i + 1];
+   }
+   if (length & 1) {
+      sum += (uint32_t)data[length - 1] << 8;
+   }
+   return sum;
+}
+
+static uint16_t
+checksum_fold(uint32_t sum) {
+   while (sum >> 16) {
+      sum = (sum & 0xffff) + (sum >> 16);
+   }
+   return (uint16_t)~sum;
+}
+
+/*
+ * Write one TCP segment as an enhanced packet block
+ */
+static void
+write_segment(connection_t* conn, int direction, uint8_t tcp_flags, const uint8_t* data, size_t length) {
+   uint8_t* eth = frame;
+   uint8_t* ip = eth + ETH_HEADER_LENGTH;
+   uint8_t* tcp = ip + IPV4_HEADER_LENGTH;
+   const uint8_t* src_ip = (direction == TO_SERVER) ? conn->client_ip : server_ip;
+   const uint8_t* dst_ip = (direction == TO_SERVER) ? server_ip : conn->client_ip;
+   uint32_t* seq = (direction == TO_SERVER) ? &conn->client_seq : &conn->server_seq;
+   uint32_t ack = (direction == TO_SERVER) ? conn->server_seq : conn->client_seq;
+   uint32_t frame_length = (uint32_t)(FRAME_HEADER_LENGTH + length);
+   uint32_t padding = (4 - (frame_length & 3)) & 3;
+   uint32_t block_length = 32 + frame_length + padding;
+   uint8_t pseudo[12];
+   uint32_t sum;
+
+   /* Ethernet: locally administered MACs derived from the IPv4 addresses */
+   memset(eth, 0, ETH_HEADER_LENGTH);
+   eth[0] = 0x02;
+   memcpy(eth + 2, dst_ip, 4);
+   eth[6] = 0x02;
+   memcpy(eth + 8, src_ip, 4);
+   store_be16(eth + 12, 0x0800);
+
+   memset(ip, 0, IPV4_HEADER_LENGTH);
+   ip[0] = 0x45;
+   store_be16(ip + 2, (uint16_t)(IPV4_HEADER_LENGTH + TCP_HEADER_LENGTH + length));
+   store_be16(ip + 4, (uint16_t)frames_written);
+   ip[6] = 0x40;                /* Don't fragment */
+   ip[8] = 64;                  /* TTL */
+   ip[9] = 6;                   /* TCP */
+   memcpy(ip + 12, src_ip, 4);
+   memcpy(ip + 16, dst_ip, 4);
+   store_be16(ip + 10, checksum_fold(checksum_add(0, ip, IPV4_HEADER_LENGTH)));
+
+   memset(tcp, 0, TCP_HEADER_LENGTH);
+   store_be16(tcp, (direction == TO_SERVER) ? conn->client_port : RBUS_DEFAULT_TCP_PORT);
+   store_be16(tcp + 2, (direction == TO_SERVER) ? RBUS_DEFAULT_TCP_PORT : conn->client_port);
+   store_be32(tcp + 4, *seq);
+   store_be32(tcp + 8, (tcp_flags & TCP_FLAG_ACK) ? ack : 0);
+   tcp[12] = (TCP_HEADER_LENGTH / 4) << 4;
+   tcp[13] = tcp_flags;
+   store_be16(tcp + 14, 65535);
+   if (length > 0) {
+      memcpy(tcp + TCP_HEADER_LENGTH, data, length);
+   }
+
+   memcpy(pseudo, src_ip, 4);
+   memcpy(pseudo + 4, dst_ip, 4);
+   pseudo[8] = 0;
+   pseudo[9] = 6;
+   store_be16(pseudo + 10, (uint16_t)(TCP_HEADER_LENGTH + length));
+   sum = checksum_add(0, pseudo, sizeof(pseudo));
+   store_be16(tcp + 16, checksum_fold(checksum_add(sum, tcp, TCP_HEADER_LENGTH + length)));
+
+   *seq += (uint32_t)length + ((tcp_flags & TCP_FLAG_SYN) ? 1 : 0);
+
+   write_u32(PCAPNG_BLOCK_EPB);
+   write_u32(block_length);
+   write_u32(0);                        /* Interface 0 */
+   write_u32((uint32_t)(now_us >> 32)); /* Timestamp, microseconds */
+   write_u32((uint32_t)now_us);
+   write_u32(frame_length);
+   write_u32(frame_length);
+   fwrite(frame, 1, frame_length, output);
+   fwrite("\0\0\0", 1, padding, output);
+   write_u32(block_length);
+
+   frames_written++;
+   bytes_written += frame_length;
+   now_us += 2;
+}
+
+static void
+write_stream(connection_t* conn, int direction, const uint8_t* data, size_t length, size_t max_segment) {
+   while (length > 0) {
+      size_t chunk = length < max_segment ? length : max_segment;
+
+      write_segment(conn, direction, TCP_FLAG_PSH | TCP_FLAG_ACK, data, chunk);
+      data += chunk;
+      length -= chunk;
+   }
+}
+
+static void
+flush_pending(connection_t* conn, int direction) {
+   buffer_t* pending = &conn->pending[direction];
+
+   write_stream(conn, direction, pending->data, pending->length, MAX_SEGMENT_PAYLOAD);
+   pending->length = 0;
+   conn->pending_count[direction] = 0;
+}
+
+/*
+ * Send one message on a connection, segmented according to the chosen mode
+ */
+static void
+send_message(connection_t* conn, int direction, const buffer_t* msg) {
+   if (!conn->established) {
+      write_segment(conn, TO_SERVER, TCP_FLAG_SYN, NULL, 0);
+      write_segment(conn, TO_CLIENT, TCP_FLAG_SYN | TCP_FLAG_ACK, NULL, 0);
+      write_segment(conn, TO_SERVER, TCP_FLAG_ACK, NULL, 0);
+      conn->established = 1;
+   }
+
+   messages_written++;
+
+   switch (segment_mode) {
+      case SEGMENT_WHOLE:
+         write_stream(conn, direction, msg->data, msg->length, MAX_SEGMENT_PAYLOAD);
+         break;
+      case SEGMENT_MSS:
+         write_stream(conn, direction, msg->data, msg->length, segment_size);
+         break;
+      case SEGMENT_RANDOM: {
+         size_t offset = 0;
+
+         while (offset < msg->length) {
+            size_t chunk = (size_t)rng_range(1, segment_size);
+
+            if (chunk > msg->length - offset) {
+               chunk = msg->length - offset;
+            }
+            write_segment(conn, direction, TCP_FLAG_PSH | TCP_FLAG_ACK, msg->data + offset, chunk);
+            offset += chunk;
+         }
+         break;
+      }
+      case SEGMENT_COALESCE:
+         /* Data in the other direction has to be on the wire before this message's reply can be */
+         if (conn->pending_count[!direction] > 0) {
+            flush_pending(conn, !direction);
+         }
+         put_bytes(&conn->pending[direction], msg->data, msg->length);
+         if (++conn->pending_count[direction] >= segment_size) {
+            flush_pending(conn, direction);
+         }
+         break;
+   }
+}
+
+/*
+ * Traffic generators, one per kind
+ */
+static void
+generate_get(connection_t* conn, buffer_t* payload, buffer_t* msg) {
+   const char* parameter = random_parameter();
+   uint32_t seq = ++conn->rbus_seq;
+   char inbox[64];
+   char component[64];
+
+   client_inbox(conn, inbox, sizeof(inbox));
+   client_component(conn, component, sizeof(component));
+
+   payload->length = 0;
+   mp_put_str(payload, component);
+   mp_put_uint(payload, 1);
+   mp_put_str(payload, parameter);
+   mp_put_metadata(payload, "METHOD_GETPARAMETERVALUES");
+   build_message(msg, seq, RTMSG_FLAG_REQUEST | RTMSG_FLAG_RAW_BINARY, parameter, inbox, payload);
+   send_message(conn, TO_SERVER, msg);
+
+   now_us += rng_range(200, 2000);
+
+   payload->length = 0;
+   mp_put_uint(payload, 0);             /* RBUS_ERROR_SUCCESS */
+   mp_put_uint(payload, 1);
+   mp_put_str(payload, parameter);
+   mp_put_string_value(payload);
+   mp_put_metadata(payload, "METHOD_RESPONSE");
+   build_message(msg, seq, RTMSG_FLAG_RESPONSE | RTMSG_FLAG_RAW_BINARY, inbox, parameter, payload);
+   send_message(conn, TO_CLIENT, msg);
+}
+
+static void
+generate_set(connection_t* conn, buffer_t* payload, buffer_t* msg) {
+   const char* parameter = random_parameter();
+   uint32_t seq = ++conn->rbus_seq;
+   char inbox[64];
+   char component[64];
+
+   client_inbox(conn, inbox, sizeof(inbox));
+   client_component(conn, component, sizeof(component));
+
+   payload->length = 0;
+   mp_put_uint(payload, 0);             /* Session ID */
+   mp_put_str(payload, component);
+   mp_put_uint(payload, 0);             /* Rollback */
+   mp_put_uint(payload, 1);
+   mp_put_str(payload, parameter);
+   mp_put_string_value(payload);
+   mp_put_str(payload, "TRUE");
+   mp_put_metadata(payload, "METHOD_SETPARAMETERVALUES");
+   build_message(msg, seq, RTMSG_FLAG_REQUEST | RTMSG_FLAG_RAW_BINARY, parameter, inbox, payload);
+   send_message(conn, TO_SERVER, msg);
+
+   now_us += rng_range(200, 2000);
+
+   payload->length = 0;
+   mp_put_uint(payload, 0);
+   mp_put_str(payload, parameter);
+   mp_put_string_value(payload);
+   mp_put_metadata(payload, "METHOD_RESPONSE");
+   build_message(msg, seq, RTMSG_FLAG_RESPONSE | RTMSG_FLAG_RAW_BINARY, inbox, parameter, payload);
+   send_message(conn, TO_CLIENT, msg);
+}
+
+static void
+generate_event(connection_t* conn, buffer_t* payload, buffer_t* msg) {
+   const char* parameter = random_parameter();
+   uint32_t metadata_offset;
+   unsigned subscribers;
+   unsigned i;
+
+   payload->length = 0;
+   mp_put_str(payload, parameter);
+   mp_put_uint(payload, 3);             /* General event */
+   mp_put_uint(payload, 1);             /* Has data */
+
+   /* RBusObject: name, type, two properties, no children */
+   mp_put_str(payload, parameter);
+   mp_put_uint(payload, 0);
+   mp_put_uint(payload, 2);
+   mp_put_str(payload, "value");
+   mp_put_string_value(payload);
+   mp_put_str(payload, "oldValue");
+   mp_put_string_value(payload);
+   mp_put_uint(payload, 0);
+
+   /* hasFilter, interval, duration, componentId */
+   mp_put_uint(payload, 0);
+   mp_put_uint(payload, 0);
+   mp_put_uint(payload, 0);
+   mp_put_uint(payload, 0);
+
+   /* Event metadata: event name, object name, isRbus2, offset */
+   metadata_offset = (uint32_t)payload->length;
+   mp_put_str(payload, parameter);
+   mp_put_str(payload, "provider");
+   mp_put_uint(payload, 1);
+   put_u8(payload, 0xd2);
+   put_be32(payload, metadata_offset);
+
+   build_message(msg, ++conn->rbus_seq, RTMSG_FLAG_RAW_BINARY, parameter, "", payload);
+   if (!forward_legs) {
+      send_message(conn, TO_CLIENT, msg);
+      return;
+   }
+
+   /* conn is the provider: its publication to rtrouted, then the copy to each subscriber */
+   send_message(conn, TO_SERVER, msg);
+   subscribers = connection_count - 1 < MAX_FANOUT ? connection_count - 1 : MAX_FANOUT;
+   for (i = 1; i <= subscribers; i++) {
+      now_us += rng_range(5, 20);
+      send_message(&connections[(conn - connections + i) % connection_count], TO_CLIENT, msg);
+   }
+}
+
+static void
+generate_control(connection_t* conn, buffer_t* payload, buffer_t* msg) {
+   const char* parameter = random_parameter();
+   char inbox[64];
+   char json[1024];
+   unsigned count;
+   unsigned i;
+   int length;
+
+   client_inbox(conn, inbox, sizeof(inbox));
+
+   if (rng_next() & 1) {
+      length = snprintf(json, sizeof(json), "{\"add\":1,\"topic\":\"%s\",\"route_id\":1}", parameter);
+      payload->length = 0;
+      put_bytes(payload, json, (size_t)length);
+      build_message(msg, ++conn->rbus_seq, RTMSG_FLAG_REQUEST, "_RTROUTED.INBOX.SUBSCRIBE", inbox, payload);
+      send_message(conn, TO_SERVER, msg);
+      return;
+   }
+
+   length = snprintf(json, sizeof(json), "{\"expression\":\"%s\"}", parameter);
+   payload->length = 0;
+   put_bytes(payload, json, (size_t)length);
+   build_message(msg, ++conn->rbus_seq, RTMSG_FLAG_REQUEST, "_enumerate_elements", inbox, payload);
+   send_message(conn, TO_SERVER, msg);
+
+   now_us += rng_range(100, 500);
+
+   count = (unsigned)rng_range(1, 8);
+   payload->length = 0;
+   length = snprintf(json, sizeof(json), "{\"count\":%u,\"items\":[", count);
+   put_bytes(payload, json, (size_t)length);
+   for (i = 0; i < count; i++) {
+      length = snprintf(json, sizeof(json), "%s\"%s\"", i ? "," : "", random_parameter());
+      put_bytes(payload, json, (size_t)length);
+   }
+   put_bytes(payload, "]}", 2);
+   build_message(msg, conn->rbus_seq, RTMSG_FLAG_RESPONSE, inbox, "_enumerate_elements", payload);
+   send_message(conn, TO_CLIENT, msg);
+}
+
+/*
+ * Option parsing
+ */
+static int
+parse_mix(const char* spec) {
+   size_t i;
+   char* copy;
+   char* item;
+   char* save = NULL;
+
+   for (i = 0; i < sizeof(mix_presets) / sizeof(mix_presets[0]); i++) {
+      if (strcmp(spec, mix_presets[i].name) == 0) {
+         memcpy(weights, mix_presets[i].weights, sizeof(weights));
+         return 0;
+      }
+   }
+
+   memset(weights, 0, sizeof(weights));
+   copy = strdup(spec);
+   for (item = strtok_r(copy, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+      char* eq = strchr(item, '=');
+      int kind;
+
+      if (!eq) {
+         free(copy);
+         return -1;
+      }
+      *eq = '\0';
+      for (kind = 0; kind < KIND_COUNT; kind++) {
+         if (strcmp(item, kind_names[kind]) == 0) {
+            break;
+         }
+      }
+      if (kind == KIND_COUNT) {
+         free(copy);
+         return -1;
+      }
+      weights[kind] = (unsigned)strtoul(eq + 1, NULL, 10);
+   }
+   free(copy);
+
+   for (i = 0; i < KIND_COUNT; i++) {
+      if (weights[i] > 0) {
+         return 0;
+      }
+   }
+   return -1;
+}
+
+static int
+parse_segmentation(const char* spec) {
+   static const struct {
+      const char* prefix;
+      segment_mode_t mode;
+   } modes[] = {
+      { "mss:", SEGMENT_MSS },
+      { "random:", SEGMENT_RANDOM },
+      { "coalesce:", SEGMENT_COALESCE },
+   };
+   size_t i;
+
+   if (strcmp(spec, "whole") == 0) {
+      segment_mode = SEGMENT_WHOLE;
+      return 0;
+   }
+   for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+      size_t prefix_length = strlen(modes[i].prefix);
+
+      if (strncmp(spec, modes[i].prefix, prefix_length) == 0) {
+         segment_mode = modes[i].mode;
+         segment_size = strtoul(spec + prefix_length, NULL, 10);
+         return (segment_size > 0 && segment_size <= MAX_SEGMENT_PAYLOAD) ? 0 : -1;
+      }
+   }
+   return -1;
+}
+
+int
+main(int argc, char* argv[]) {
+   const char* path = NULL;
+   buffer_t payload = { 0 };
+   buffer_t msg = { 0 };
+   unsigned total_weight = 0;
+   unsigned long n;
+   unsigned i;
+   int opt;
+
+   parse_mix("mixed");
+
+   while ((opt = getopt(argc, argv, "w:m:n:c:p:s:r:fh")) != -1) {
+      switch (opt) {
+         case 'w':
+            path = optarg;
+            break;
+         case 'm':
+            if (parse_mix(optarg) < 0) {
+               fprintf(stderr, "Invalid traffic mix: %s\n", optarg);
+               return 1;
+            }
+            break;
+         case 'n':
+            operations = strtoul(optarg, NULL, 10);
+            break;
+         case 'c':
+            connection_count = (unsigned)strtoul(optarg, NULL, 10);
+            if (connection_count == 0 || connection_count > MAX_CONNECTIONS) {
+               fprintf(stderr, "Connections must be 1-%d\n", MAX_CONNECTIONS);
+               return 1;
+            }
+            break;
+         case 'p':
+            if (sscanf(optarg, "%zu-%zu", &value_min, &value_max) != 2 ||
+               value_min > value_max || value_max >= (1 << 16)) {
+               fprintf(stderr, "Invalid value size range: %s\n", optarg);
+               return 1;
+            }
+            break;
+         case 's':
+            if (parse_segmentation(optarg) < 0) {
+               fprintf(stderr, "Invalid segmentation: %s\n", optarg);
+               return 1;
+            }
+            break;
+         case 'r':
+            rng_state = strtoull(optarg, NULL, 0) | 1;
+            break;
+         case 'f':
+            forward_legs = 1;
+            break;
+         default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+      }
+   }
+   if (!path) {
+      usage(argv[0]);
+      return 1;
+   }
+
+   output = fopen(path, "wb");
+   if (!output) {
+      perror(path);
+      return 1;
+   }
+   write_pcapng_header();
+
+   init_parameter_pool();
+   for (i = 0; i < connection_count; i++) {
+      connections[i].client_ip[0] = 10;
+      connections[i].client_ip[1] = 0;
+      connections[i].client_ip[2] = (uint8_t)(1 + i / 250);
+      connections[i].client_ip[3] = (uint8_t)(2 + i % 250);
+      connections[i].client_port = (uint16_t)(CLIENT_PORT_BASE + i);
+      connections[i].client_seq = (uint32_t)rng_next();
+      connections[i].server_seq = (uint32_t)rng_next();
+   }
+   for (i = 0; i < KIND_COUNT; i++) {
+      total_weight += weights[i];
+   }
+
+   for (n = 0; n < operations; n++) {
+      connection_t* conn = &connections[rng_next() % connection_count];
+      unsigned pick = (unsigned)(rng_next() % total_weight);
+      traffic_kind_t kind = KIND_GET;
+
+      while (pick >= weights[kind]) {
+         pick -= weights[kind];
+         kind++;
+      }
+
+      switch (kind) {
+         case KIND_GET:
+            generate_get(conn, &payload, &msg);
+            break;
+         case KIND_SET:
+            generate_set(conn, &payload, &msg);
+            break;
+         case KIND_EVENT:
+            generate_event(conn, &payload, &msg);
+            break;
+         default:
+            generate_control(conn, &payload, &msg);
+            break;
+      }
+      now_us += rng_range(50, 500);
+   }
+
+   for (i = 0; i < connection_count; i++) {
+      if (connections[i].pending_count[TO_SERVER] > 0) {
+         flush_pending(&connections[i], TO_SERVER);
+      }
+      if (connections[i].pending_count[TO_CLIENT] > 0) {
+         flush_pending(&connections[i], TO_CLIENT);
+      }
+      free(connections[i].pending[TO_SERVER].data);
+      free(connections[i].pending[TO_CLIENT].data);
+   }
+   free(payload.data);
+   free(msg.data);
+
+   if (fclose(output) != 0) {
+      perror(path);
+      return 1;
+   }
+
+   /* Summary on stdout for scripts: frames, messages, bytes */
+   printf("%s: %lu frames, %lu messages, %llu bytes\n", path, frames_written, messages_written,
+      (unsigned long long)bytes_written);
+   return 0;
+}
@@ -0,0 +1,664 @@
+/*
+ * rbus-microbench.c - Microbenchmarks for the RBus payload decoders
+ *
+ * Copyright 2026
+ * Licensed under the Apache License, Version 2.0
+ *
+ * Builds the dissector against the epan stub in test/epan-stub and times its
+ * payload decoders on in-memory buffers: rbus_summarize_payload with
+ * parse_rbus_payload, display_msgpack_object, add_typed_value and
+ * parse_control_message. Besides typical messages the suite covers the shapes
+ * the decoder limits exist for: a payload at the 20,000-object limit, nesting
+ * at the depth-16 limit and multi-megabyte BIN values.
+ *
+ * Results go to stdout as tab-separated values, one line per benchmark:
+ *
+ *   benchmark  iterations  ns_per_op  ns_per_object  objects_per_op  items_per_op  bytes_per_op
+ *
+ * where objects are decoded MessagePack objects (JSON values for control
+ * messages) and items are tree items added. Each figure is the median over
+ * several timed batches.
+ *
+ *   rbus-microbench                       # run everything
+ *   rbus-microbench > before.tsv
+ *   rbus-microbench -f display_
+ *   rbus-microbench -b before.tsv -t 10   # exit 1 if any ns/object grew by more than 10%
+ */
+
+#include <getopt.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* The decoders are static, so the dissector is compiled into this file */
+#include "packet-rbus.c"
+
+#define BATCHES 7
+
+typedef struct {
+   uint8_t* data;
+   size_t length;
+   size_t capacity;
+} buffer_t;
+
+typedef enum {
+   TARGET_PAYLOAD,              /* rbus_summarize_payload, then parse_rbus_payload */
+   TARGET_DISPLAY,              /* display_msgpack_object over each top-level object */
+   TARGET_TYPED_VALUE,          /* add_typed_value on the first object */
+   TARGET_CONTROL               /* parse_control_message over a JSON payload */
+} target_t;
+
+typedef struct {
+   const char* name;
+   target_t target;
+   void (*build)(buffer_t* buf);
+   const char* control_topic;   /* TARGET_CONTROL: topic selecting the control message type */
+} bench_t;
+
+static unsigned min_batch_ms = 50;
+static bool fields_only = false;
+
+/*
+ * Growable byte buffer with big-endian and MessagePack writers
+ */
+static void
+buffer_reserve(buffer_t* buf, size_t extra) {
+   if (buf->length + extra > buf->capacity) {
+      size_t capacity = buf->capacity ? buf->capacity : 256;
+
+      while (capacity < buf->length + extra) {
+         capacity *= 2;
+      }
+      buf->data = realloc(buf->data, capacity);
+      if (!buf->data) {
+         perror("realloc");
+         exit(1);
+      }
+      buf->capacity = capacity;
+   }
+}
+
+static void
+put_bytes(buffer_t* buf, const void* data, size_t length) {
+   buffer_reserve(buf, length);
+   memcpy(buf->data + buf->length, data, length);
+   buf->length += length;
+}
+
+static void
+put_u8(buffer_t* buf, uint8_t value) {
+   put_bytes(buf, &value, 1);
+}
+
+static void
+put_be16(buffer_t* buf, uint16_t value) {
+   uint8_t be[2] = { (uint8_t)(value >> 8), (uint8_t)value };
+   put_bytes(buf, be, sizeof(be));
+}
+
+static void
+put_be32(buffer_t* buf, uint32_t value) {
+   uint8_t be[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value };
+   put_bytes(buf, be, sizeof(be));
+}
+
+static void
+put_printf(buffer_t* buf, const char* format, ...) G_GNUC_PRINTF(2, 3);
+
+static void
+put_printf(buffer_t* buf, const char* format, ...) {
+   char text[256];
+   va_list ap;
+   int length;
+
+   va_start(ap, format);
+   length = vsnprintf(text, sizeof(text), format, ap);
+   va_end(ap);
+   put_bytes(buf, text, (size_t)length);
+}
+
+static void
+mp_put_uint(buffer_t* buf, uint32_t value) {
+   if (value <= 0x7f) {
+      put_u8(buf, (uint8_t)value);
+   } else if (value <= 0xff) {
+      put_u8(buf, 0xcc);
+      put_u8(buf, (uint8_t)value);
+   } else if (value <= 0xffff) {
+      put_u8(buf, 0xcd);
+      put_be16(buf, (uint16_t)value);
+   } else {
+      put_u8(buf, 0xce);
+      put_be32(buf, value);
+   }
+}
+
+static void
+mp_put_int64(buffer_t* buf, int64_t value) {
+   put_u8(buf, 0xd3);
+   put_be32(buf, (uint32_t)((uint64_t)value >> 32));
+   put_be32(buf, (uint32_t)value);
+}
+
+static void
+mp_put_double(buffer_t* buf, double value) {
+   uint64_t bits;
+
+   memcpy(&bits, &value, sizeof(bits));
+   put_u8(buf, 0xcb);
+   put_be32(buf, (uint32_t)(bits >> 32));
+   put_be32(buf, (uint32_t)bits);
+}
+
+static void
+mp_put_str(buffer_t* buf, const char* str) {
+   size_t length = strlen(str);
+
+   if (length < 32) {
+      put_u8(buf, (uint8_t)(0xa0 | length));
+   } else if (length <= 0xff) {
+      put_u8(buf, 0xd9);
+      put_u8(buf, (uint8_t)length);
+   } else {
+      put_u8(buf, 0xda);
+      put_be16(buf, (uint16_t)length);
+   }
+   put_bytes(buf, str, length);
+}
+
+static void
+mp_put_bin_header(buffer_t* buf, size_t length) {
+   if (length <= 0xff) {
+      put_u8(buf, 0xc4);
+      put_u8(buf, (uint8_t)length);
+   } else if (length <= 0xffff) {
+      put_u8(buf, 0xc5);
+      put_be16(buf, (uint16_t)length);
+   } else {
+      put_u8(buf, 0xc6);
+      put_be32(buf, (uint32_t)length);
+   }
+}
+
+/* RBUS_STRING value: type ID, then the NUL-terminated text as bin */
+static void
+mp_put_string_value(buffer_t* buf, const char* text) {
+   size_t length = strlen(text) + 1;
+
+   mp_put_uint(buf, 0x50E);
+   mp_put_bin_header(buf, length);
+   put_bytes(buf, text, length);
+}
+
+/* A BIN of length printable bytes, as a large string property would carry */
+static void
+mp_put_large_bin(buffer_t* buf, size_t length) {
+   size_t i;
+
+   mp_put_bin_header(buf, length);
+   buffer_reserve(buf, length);
+   for (i = 0; i < length; i++) {
+      buf->data[buf->length + i] = (uint8_t)('a' + i % 26);
+   }
+   buf->length += length;
+}
+
+/* Trailing metadata: method, ot_parent, ot_state and the fixed int32 offset of the method */
+static void
+mp_put_metadata(buffer_t* buf, const char* method) {
+   uint32_t offset = (uint32_t)buf->length;
+
+   mp_put_str(buf, method);
+   mp_put_str(buf, "");
+   mp_put_str(buf, "");
+   put_u8(buf, 0xd2);
+   put_be32(buf, offset);
+}
+
+/*
+ * Payloads
+ */
+static void
+build_get_request(buffer_t* buf) {
+   mp_put_str(buf, "client3-40021");
+   mp_put_uint(buf, 1);
+   mp_put_str(buf, "Device.WiFi.Radio.1.Channel");
+   mp_put_metadata(buf, "METHOD_GETPARAMETERVALUES");
+}
+
+static void
+build_get_response_100(buffer_t* buf) {
+   char name[64];
+   guint i;
+
+   mp_put_uint(buf, 0);
+   mp_put_uint(buf, 100);
+   for (i = 0; i < 100; i++) {
+      snprintf(name, sizeof(name), "Device.Hosts.Host.%u.HostName", i + 1);
+      mp_put_str(buf, name);
+      mp_put_string_value(buf, "living-room-tv.lan");
+   }
+   mp_put_metadata(buf, "METHOD_RESPONSE");
+}
+
+static void
+build_set_request(buffer_t* buf) {
+   mp_put_uint(buf, 0);
+   mp_put_str(buf, "client3-40021");
+   mp_put_uint(buf, 0);
+   mp_put_uint(buf, 1);
+   mp_put_str(buf, "Device.WiFi.SSID.1.SSID");
+   mp_put_string_value(buf, "HomeNetwork");
+   mp_put_str(buf, "TRUE");
+   mp_put_metadata(buf, "METHOD_SETPARAMETERVALUES");
+}
+
+static void
+build_event(buffer_t* buf) {
+   uint32_t metadata_offset;
+
+   mp_put_str(buf, "Device.WiFi.AccessPoint.1.AssociatedDeviceNumberOfEntries");
+   mp_put_uint(buf, 3);
+   mp_put_uint(buf, 1);
+   mp_put_str(buf, "Device.WiFi.AccessPoint.1.AssociatedDeviceNumberOfEntries");
+   mp_put_uint(buf, 0);
+   mp_put_uint(buf, 2);
+   mp_put_str(buf, "value");
+   mp_put_string_value(buf, "4");
+   mp_put_str(buf, "oldValue");
+   mp_put_string_value(buf, "3");
+   mp_put_uint(buf, 0);
+   mp_put_uint(buf, 0);
+   mp_put_uint(buf, 0);
+   mp_put_uint(buf, 0);
+   mp_put_uint(buf, 0);
+   metadata_offset = (uint32_t)buf->length;
+   mp_put_str(buf, "Device.WiFi.AccessPoint.1.AssociatedDeviceNumberOfEntries");
+   mp_put_str(buf, "provider");
+   mp_put_uint(buf, 1);
+   put_u8(buf, 0xd2);
+   put_be32(buf, metadata_offset);
+}
+
+/* 20,000 top-level objects, the default object limit: name/type/value triples */
+static void
+build_flat_20000(buffer_t* buf) {
+   char name[64];
+   guint i;
+
+   for (i = 0; i < 20000 / 3; i++) {
+      snprintf(name, sizeof(name), "Device.Hosts.Host.%u.Active", i + 1);
+      mp_put_str(buf, name);
+      mp_put_uint(buf, 0x50E);
+      mp_put_uint(buf, i);
+   }
+   mp_put_uint(buf, 0);
+   mp_put_uint(buf, 1);
+}
+
+/* One map of 10,000 pairs: 20,000 objects below a single top-level object */
+static void
+build_map_20000(buffer_t* buf) {
+   char key[32];
+   guint i;
+
+   put_u8(buf, 0xdf);
+   put_be32(buf, 10000);
+   for (i = 0; i < 10000; i++) {
+      snprintf(key, sizeof(key), "key%u", i);
+      mp_put_str(buf, key);
+      mp_put_uint(buf, i);
+   }
+}
+
+/* Arrays nested to the depth limit, each level carrying a few scalars */
+static void
+build_nested_16(buffer_t* buf) {
+   guint depth;
+
+   for (depth = 0; depth < 16; depth++) {
+      put_u8(buf, 0x94);
+      mp_put_str(buf, "level");
+      mp_put_uint(buf, depth);
+      put_u8(buf, depth & 1 ? 0xc3 : 0xc2);
+   }
+   put_u8(buf, 0xc0);
+}
+
+static void
+build_bin_4mb(buffer_t* buf) {
+   mp_put_large_bin(buf, 4u << 20);
+}
+
+static void
+build_value_string(buffer_t* buf) {
+   mp_put_str(buf, "Device.DeviceInfo.SoftwareVersion");
+}
+
+static void
+build_value_uint(buffer_t* buf) {
+   mp_put_uint(buf, 0x12345678);
+}
+
+static void
+build_value_int64(buffer_t* buf) {
+   mp_put_int64(buf, -0x123456789LL);
+}
+
+static void
+build_value_double(buffer_t* buf) {
+   mp_put_double(buf, 42.125);
+}
+
+static void
+build_value_bool(buffer_t* buf) {
+   static const uint8_t true_value = 0x01;
+
+   mp_put_bin_header(buf, 1);
+   put_bytes(buf, &true_value, 1);
+}
+
+static void
+build_value_bin_4mb(buffer_t* buf) {
+   mp_put_large_bin(buf, 4u << 20);
+}
+
+static void
+build_control_subscribe(buffer_t* buf) {
+   put_printf(buf, "{\"add\":1,\"topic\":\"%s\",\"route_id\":1}", "Device.WiFi.Radio.1.Channel");
+}
+
+static void
+build_control_enumerate_1000(buffer_t* buf) {
+   guint i;
+
+   put_printf(buf, "{\"count\":1000,\"items\":[");
+   for (i = 0; i < 1000; i++) {
+      put_printf(buf, "%s\"Device.Hosts.Host.%u.HostName\"", i ? "," : "", i + 1);
+   }
+   put_printf(buf, "]}");
+}
+
+static bench_t benchmarks[] = {
+   { "payload_get_request", TARGET_PAYLOAD, build_get_request, NULL },
+   { "payload_get_response_100", TARGET_PAYLOAD, build_get_response_100, NULL },
+   { "payload_set_request", TARGET_PAYLOAD, build_set_request, NULL },
+   { "payload_event", TARGET_PAYLOAD, build_event, NULL },
+   { "display_get_response_100", TARGET_DISPLAY, build_get_response_100, NULL },
+   { "display_flat_20000", TARGET_DISPLAY, build_flat_20000, NULL },
+   { "display_map_20000", TARGET_DISPLAY, build_map_20000, NULL },
+   { "display_nested_16", TARGET_DISPLAY, build_nested_16, NULL },
+   { "display_bin_4mb", TARGET_DISPLAY, build_bin_4mb, NULL },
+   { "typed_value_string", TARGET_TYPED_VALUE, build_value_string, NULL },
+   { "typed_value_uint", TARGET_TYPED_VALUE, build_value_uint, NULL },
+   { "typed_value_int64", TARGET_TYPED_VALUE, build_value_int64, NULL },
+   { "typed_value_double", TARGET_TYPED_VALUE, build_value_double, NULL },
+   { "typed_value_bool", TARGET_TYPED_VALUE, build_value_bool, NULL },
+   { "typed_value_bin_4mb", TARGET_TYPED_VALUE, build_value_bin_4mb, NULL },
+   { "control_subscribe", TARGET_CONTROL, build_control_subscribe, "_RTROUTED.INBOX.SUBSCRIBE" },
+   { "control_enumerate_1000", TARGET_CONTROL, build_control_enumerate_1000, "_enumerate_elements" },
+};
+
+/*
+ * Running
+ */
+static packet_info pinfo;
+static proto_tree* tree;
+static double measured[array_length(benchmarks)];    /* ns/object, negative if not run */
+
+/* Count the values of a JSON document: every scalar, array and object */
+static guint
+count_json_values(const buffer_t* buf) {
+   guint count = 0;
+   gboolean in_string = FALSE;
+   size_t i;
+
+   for (i = 0; i < buf->length; i++) {
+      char c = (char)buf->data[i];
+
+      if (in_string) {
+         if (c == '\\') {
+            i++;
+         } else if (c == '"') {
+            in_string = FALSE;
+         }
+      } else if (c == '"') {
+         in_string = TRUE;
+         count++;
+      } else if (c == '{' || c == '[' || g_ascii_isdigit(c)) {
+         if (!(g_ascii_isdigit(c) && i > 0 && g_ascii_isdigit((char)buf->data[i - 1]))) {
+            count++;
+         }
+      }
+   }
+   return count;
+}
+
+/* One operation on a fresh packet; returns the number of MessagePack objects decoded */
+static guint
+run_once(const bench_t* bench, const buffer_t* payload) {
+   tvbuff_t tvb = { payload->data, (unsigned)payload->length };
+   rbus_msgpack_cursor_t cursor;
+
+   epan_stub_packet_init(&pinfo);
+
+   switch (bench->target) {
+      case TARGET_PAYLOAD:
+         rbus_cursor_init(&cursor, pinfo.pool, &tvb, 0, tvb.length, pref_msgpack_object_limit,
+            pref_msgpack_depth_limit);
+         parse_rbus_payload(&tvb, &pinfo, tree, rbus_summarize_payload(pinfo.pool, &tvb, &pinfo, &cursor), &cursor,
+            tvb.length);
+         return cursor.node_count;
+
+      case TARGET_DISPLAY: {
+         rbus_parse_context_t ctx = { 0, FALSE, 0, RBUS_METHOD_NONE, 0, 0 };
+         guint32 index;
+
+         rbus_cursor_init(&cursor, pinfo.pool, &tvb, 0, tvb.length, pref_msgpack_object_limit,
+            pref_msgpack_depth_limit);
+         for (index = 0; rbus_cursor_has(&cursor, index); index++) {
+            ctx.object_index = index;
+            display_msgpack_object(tree, &tvb, &pinfo, &cursor, rbus_cursor_top(&cursor, index), 0, NULL, &ctx);
+         }
+         return cursor.node_count;
+      }
+
+      case TARGET_TYPED_VALUE: {
+         rbus_mp_object_t obj;
+
+         if (!rbus_mp_read_head(tvb.data, 0, tvb.length, &obj)) {
+            fprintf(stderr, "%s: undecodable value\n", bench->name);
+            exit(1);
+         }
+         add_typed_value(tree, &tvb, &pinfo, &obj, TRUE);
+         return 1;
+      }
+
+      case TARGET_CONTROL:
+         parse_control_message(&tvb, &pinfo, tree, 0, tvb.length, get_control_message_type(bench->control_topic));
+         return 0;
+   }
+   return 0;
+}
+
+static uint64_t
+now_ns(void) {
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int
+compare_double(const void* a, const void* b) {
+   double x = *(const double*)a;
+   double y = *(const double*)b;
+   return (x > y) - (x < y);
+}
+
+/* Times one benchmark, prints its result line and returns its ns/object */
+static double
+run_benchmark(const bench_t* bench) {
+   buffer_t payload = { NULL, 0, 0 };
+   double samples[BATCHES];
+   unsigned long iterations = 1;
+   guint objects;
+   uint64_t items;
+   uint64_t start;
+   double ns_per_op;
+   double ns_per_object;
+   int batch;
+
+   bench->build(&payload);
+
+   /* First run: warms caches and the intern table, and counts objects and items */
+   epan_stub_items_added = 0;
+   objects = run_once(bench, &payload);
+   if (bench->target == TARGET_CONTROL) {
+      objects = count_json_values(&payload);
+   }
+   items = epan_stub_items_added;
+
+   /* Size batches to take at least min_batch_ms each */
+   for (;;) {
+      unsigned long i;
+
+      start = now_ns();
+      for (i = 0; i < iterations; i++) {
+         run_once(bench, &payload);
+      }
+      if (now_ns() - start >= (uint64_t)min_batch_ms * 1000000u || iterations >= (1ul << 30)) {
+         break;
+      }
+      iterations *= 2;
+   }
+
+   for (batch = 0; batch < BATCHES; batch++) {
+      unsigned long i;
+
+      start = now_ns();
+      for (i = 0; i < iterations; i++) {
+         run_once(bench, &payload);
+      }
+      samples[batch] = (double)(now_ns() - start) / (double)iterations;
+   }
+   qsort(samples, BATCHES, sizeof(samples[0]), compare_double);
+   ns_per_op = samples[BATCHES / 2];
+   ns_per_object = ns_per_op / (objects ? objects : 1);
+
+   printf("%s\t%lu\t%.1f\t%.2f\t%u\t%" PRIu64 "\t%zu\n",
+      bench->name, iterations, ns_per_op, ns_per_object, objects, items, payload.length);
+   fflush(stdout);
+   free(payload.data);
+   return ns_per_object;
+}
+
+/*
+ * Compare ns/object with an earlier results file, reporting on stderr.
+ * Returns the number of benchmarks slower by more than tolerance percent.
+ */
+static int
+compare_baseline(const char* path, double tolerance) {
+   char line[512];
+   FILE* baseline = fopen(path, "r");
+   int regressions = 0;
+   size_t i;
+
+   if (!baseline) {
+      perror(path);
+      return 1;
+   }
+   fprintf(stderr, "Comparing with %s (tolerance %.0f%%)\n", path, tolerance);
+   while (fgets(line, sizeof(line), baseline)) {
+      char name[128];
+      double base;
+
+      /* Skips the header, whose ns_per_object column does not parse */
+      if (sscanf(line, "%127s %*s %*s %lf", name, &base) != 2 || base <= 0) {
+         continue;
+      }
+      for (i = 0; i < array_length(benchmarks); i++) {
+         double change;
+
+         if (measured[i] < 0 || strcmp(benchmarks[i].name, name) != 0) {
+            continue;
+         }
+         change = (measured[i] - base) * 100 / base;
+         fprintf(stderr, "%-28s %10.2f -> %10.2f ns/object (%+.1f%%) %s\n", name, base, measured[i],
+            change, change > tolerance ? "REGRESSION" : "ok");
+         if (change > tolerance) {
+            regressions++;
+         }
+      }
+   }
+   fclose(baseline);
+   return regressions;
+}
+
+static void
+usage(const char* prog) {
+   fprintf(stderr,
+      "Usage: %s [options]\n"
+      "  -f <prefix>     Run only benchmarks whose name starts with prefix\n"
+      "  -m <ms>         Minimum duration of a timed batch (default %u)\n"
+      "  -F              Fields-only tree: no label text, as for filtering without -V\n"
+      "  -b <file>       Compare ns/object with an earlier results file\n"
+      "  -t <percent>    Allowed ns/object increase over the baseline (default 10)\n"
+      "  -l              List the benchmarks\n",
+      prog, min_batch_ms);
+}
+
+int
+main(int argc, char* argv[]) {
+   const char* filter = NULL;
+   const char* baseline_path = NULL;
+   double tolerance = 10;
+   size_t i;
+   int opt;
+
+   while ((opt = getopt(argc, argv, "f:m:Fb:t:lh")) != -1) {
+      switch (opt) {
+         case 'f':
+            filter = optarg;
+            break;
+         case 'm':
+            min_batch_ms = (unsigned)strtoul(optarg, NULL, 10);
+            break;
+         case 'F':
+            fields_only = true;
+            break;
+         case 'b':
+            baseline_path = optarg;
+            break;
+         case 't':
+            tolerance = strtod(optarg, NULL);
+            break;
+         case 'l':
+            for (i = 0; i < array_length(benchmarks); i++) {
+               printf("%s\n", benchmarks[i].name);
+            }
+            return 0;
+         default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+      }
+   }
+
+   proto_register_rbus();
+   epan_stub_run_init_routines();
+   tree = epan_stub_tree_new(!fields_only);
+
+   printf("benchmark\titerations\tns_per_op\tns_per_object\tobjects_per_op\titems_per_op\tbytes_per_op\n");
+   for (i = 0; i < array_length(benchmarks); i++) {
+      measured[i] = -1;
+      if (filter && strncmp(benchmarks[i].name, filter, strlen(filter)) != 0) {
+         continue;
+      }
+      measured[i] = run_benchmark(&benchmarks[i]);
+   }
+
+   if (baseline_path && compare_baseline(baseline_path, tolerance) > 0) {
+      return 1;
+   }
+   return 0;
+}
@@ -0,0 +1,1782 @@
+/*
+ * rbus-analyze.c - Multi-threaded offline analysis of RBus captures
+ *
+ * Copyright 2026
+ * Licensed under the Apache License, Version 2.0
+ *
+ * Summarizes large capture sets much faster than running tshark "-z" reports
+ * over them. The captures (pcap or pcapng, memory mapped) are first indexed:
+ * every TCP segment to or from an RBus port is filed under its TCP stream.
+ * The streams are then spread over worker threads, which reassemble them,
+ * frame and decode the messages with libRBusWire and keep statistics of
+ * their own; idle workers steal streams from busy ones. The per-thread
+ * statistics are merged at the end.
+ *
+ *   rbus-analyze day/rbus-*.pcapng
+ *   rbus-analyze -t 16 -p 10002,10003 -n 50 capture.pcap
+ *
+ * Files are analyzed as one capture set in the order given, so a stream cut
+ * across rotated files (tcpdump -C/-G) continues from one file to the next.
+ * Besides Ethernet, Linux cooked, loopback and raw IP captures, exported-PDU
+ * captures written by rbus-uds-capture are read.
+ *
+ * Requests are matched with responses by sequence number within a TCP
+ * stream, as in the dissector; response times are measured from the segment
+ * completing the request to the segment completing the response.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rbus-protocol.h"
+#include "rbus-wire.h"
+
+/* Capture file formats */
+#define PCAP_MAGIC_US 0xA1B2C3D4
+#define PCAP_MAGIC_NS 0xA1B23C4D
+#define PCAPNG_BLOCK_SHB 0x0A0D0D0A
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_PB 0x00000002
+#define PCAPNG_BLOCK_SPB 0x00000003
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+#define PCAPNG_OPT_IF_TSRESOL 9
+
+/* Link types */
+#define LINKTYPE_NULL 0
+#define LINKTYPE_ETHERNET 1
+#define LINKTYPE_RAW_OLD 12
+#define LINKTYPE_RAW 101
+#define LINKTYPE_LOOP 108
+#define LINKTYPE_LINUX_SLL 113
+#define LINKTYPE_IPV4 228
+#define LINKTYPE_IPV6 229
+#define LINKTYPE_WIRESHARK_UPPER_PDU 252
+#define LINKTYPE_LINUX_SLL2 276
+
+/* Wireshark exported PDU tags (epan/exported_pdu.h) */
+#define EXP_PDU_TAG_END_OF_OPT 0
+#define EXP_PDU_TAG_DISSECTOR_NAME 12
+#define EXP_PDU_TAG_IPV4_SRC 20
+#define EXP_PDU_TAG_IPV4_DST 21
+#define EXP_PDU_TAG_IPV6_SRC 22
+#define EXP_PDU_TAG_IPV6_DST 23
+#define EXP_PDU_TAG_SRC_PORT 25
+#define EXP_PDU_TAG_DST_PORT 26
+
+#define ETHERTYPE_IPV4 0x0800
+#define ETHERTYPE_IPV6 0x86DD
+#define ETHERTYPE_VLAN 0x8100
+#define ETHERTYPE_QINQ 0x88A8
+#define IPPROTO_TCP_NUMBER 6
+#define TCP_FLAG_SYN 0x02
+
+#define MAX_PORTS 16
+#define MAX_INTERFACES 64
+#define DEFAULT_TOP 20
+#define NAME_WIDTH 40            /* Minimum width of the name column; longer names widen it */
+
+/* Payload decoding limits, as the dissector's defaults */
+#define MSGPACK_DEPTH_LIMIT 16
+#define MSGPACK_OBJECT_LIMIT 20000
+
+/* Topic prefix length used for grouping, as the dissector's SRT table */
+#define TOPIC_COMPONENTS 2
+
+/*
+ * Response time histogram: four buckets per power of two of microseconds,
+ * enough to estimate percentiles within about 20%
+ */
+#define LATENCY_SUB_BUCKETS 4
+#define LATENCY_BUCKETS (40 * LATENCY_SUB_BUCKETS)
+
+typedef enum {
+   KIND_REQUEST,
+   KIND_RESPONSE,
+   KIND_EVENT,
+   KIND_CONTROL,
+   KIND_OTHER,
+   KIND_COUNT
+} message_kind_t;
+
+static const char* const kind_names[KIND_COUNT] = { "Requests", "Responses", "Events", "Control", "Other" };
+
+/*
+ * Index
+ */
+
+/* One TCP segment; data points into the mapped capture file */
+#define SEGMENT_TO_CLIENT 0x80000000u   /* Sent by the RBus port side */
+#define SEGMENT_SYN 0x40000000u         /* The direction (re)starts at seq + 1 */
+#define SEGMENT_LENGTH_MASK 0x3FFFFFFFu
+
+typedef struct {
+   const uint8_t* data;
+   uint64_t ts_us;
+   uint32_t seq;
+   uint32_t length_flags;
+} segment_t;
+
+/* Endpoints of a TCP stream; the server is the side on an RBus port */
+typedef struct {
+   uint8_t client_addr[16];
+   uint8_t server_addr[16];
+   uint16_t client_port;
+   uint16_t server_port;
+   uint32_t family;             /* 4 or 6 */
+} stream_key_t;
+
+typedef struct {
+   stream_key_t key;
+   uint32_t hash;
+   segment_t* segments;
+   size_t count;
+   size_t capacity;
+   uint64_t bytes;              /* Payload bytes, the cost estimate for scheduling */
+   uint32_t pdu_seq[2];         /* Next sequence number for exported PDUs, per direction */
+} stream_t;
+
+/* Open-addressing hash of streams, plus the streams in order of appearance */
+typedef struct {
+   stream_t** slots;
+   size_t capacity;
+   stream_t** list;
+   size_t count;
+   size_t list_capacity;
+} stream_table_t;
+
+typedef struct {
+   const char* path;
+   const uint8_t* data;
+   size_t size;
+   uint64_t frames;
+   uint64_t segments;
+   char error[128];             /* Set if the file could not be read to the end */
+   stream_table_t streams;
+} capture_file_t;
+
+/*
+ * Statistics, kept per worker thread and merged at the end
+ */
+typedef struct {
+   uint64_t count;
+   uint64_t sum_us;
+   uint64_t min_us;
+   uint64_t max_us;
+   uint64_t buckets[LATENCY_BUCKETS];
+} latency_t;
+
+typedef struct {
+   char* name;
+   uint32_t hash;
+   uint64_t messages;
+   uint64_t bytes;
+   uint64_t first_us;
+   uint64_t last_us;
+   latency_t latency;
+} name_stats_t;
+
+typedef struct {
+   name_stats_t** slots;
+   size_t capacity;
+   size_t count;
+} name_table_t;
+
+typedef struct {
+   uint64_t messages[KIND_COUNT];
+   uint64_t bytes[KIND_COUNT];
+   uint64_t streams;
+   uint64_t unanswered;         /* Requests with no response by the end of their stream */
+   uint64_t unmatched;          /* Responses with no request seen */
+   uint64_t malformed;          /* Framed messages whose header did not parse */
+   uint64_t resync_bytes;       /* Bytes skipped looking for a header */
+   uint64_t gaps;               /* Holes in the TCP sequence space */
+   uint64_t first_us;
+   uint64_t last_us;
+   latency_t methods[RBUS_METHOD_COUNT];
+   name_table_t topics;         /* Topic prefix -> messages, bytes and response times */
+   name_table_t events;         /* Event name -> publications */
+} stats_t;
+
+/*
+ * Work stealing: each worker owns a deque of stream indices. The owner takes
+ * from the tail, where the largest streams are; thieves take from the head.
+ */
+typedef struct {
+   pthread_mutex_t lock;
+   size_t* items;
+   size_t head;
+   size_t tail;
+   size_t capacity;
+} work_queue_t;
+
+typedef struct {
+   unsigned id;
+   pthread_t thread;
+   work_queue_t queue;
+   stats_t stats;
+   uint64_t streams_stolen;
+} worker_t;
+
+static uint16_t ports[MAX_PORTS];
+static unsigned port_count = 0;
+static capture_file_t* files = NULL;
+static unsigned file_count = 0;
+static unsigned next_file = 0;
+static pthread_mutex_t next_file_lock = PTHREAD_MUTEX_INITIALIZER;
+static stream_table_t streams;
+static worker_t* workers = NULL;
+static unsigned worker_count = 0;
+
+static void
+fatal(const char* fmt, ...) {
+   va_list ap;
+
+   va_start(ap, fmt);
+   vfprintf(stderr, fmt, ap);
+   va_end(ap);
+   fputc('\n', stderr);
+   exit(1);
+}
+
+static void*
+xrealloc(void* ptr, size_t size) {
+   void* p = realloc(ptr, size);
+
+   if (!p && size) {
+      fatal("Out of memory");
+   }
+   return p;
+}
+
+static void*
+xcalloc(size_t count, size_t size) {
+   void* p = calloc(count, size);
+
+   if (!p && count && size) {
+      fatal("Out of memory");
+   }
+   return p;
+}
+
+static inline uint16_t
+get_be16(const uint8_t* p) {
+   return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t
+get_be32(const uint8_t* p) {
+   return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* File formats are in the writer's byte order */
+static inline uint16_t
+get_u16(const uint8_t* p, int swapped) {
+   uint16_t v;
+
+   memcpy(&v, p, sizeof(v));
+   return swapped ? (uint16_t)((v >> 8) | (v << 8)) : v;
+}
+
+static inline uint32_t
+get_u32(const uint8_t* p, int swapped) {
+   uint32_t v;
+
+   memcpy(&v, p, sizeof(v));
+   return swapped ? __builtin_bswap32(v) : v;
+}
+
+static uint32_t
+hash_bytes(const void* data, size_t length) {
+   const uint8_t* p = (const uint8_t*)data;
+   uint32_t h = 2166136261u;   /* FNV-1a */
+
+   for (size_t i = 0; i < length; i++) {
+      h = (h ^ p[i]) * 16777619u;
+   }
+   return h;
+}
+
+static uint64_t
+now_us(void) {
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+/*
+ * Streams
+ */
+static void
+stream_table_grow(stream_table_t* table) {
+   size_t capacity = table->capacity ? table->capacity * 2 : 1024;
+   stream_t** slots = xcalloc(capacity, sizeof(*slots));
+
+   for (size_t i = 0; i < table->count; i++) {
+      stream_t* s = table->list[i];
+      size_t slot = s->hash & (capacity - 1);
+
+      while (slots[slot]) {
+         slot = (slot + 1) & (capacity - 1);
+      }
+      slots[slot] = s;
+   }
+   free(table->slots);
+   table->slots = slots;
+   table->capacity = capacity;
+}
+
+/* Return the stream with this key, adding an empty one if new */
+static stream_t*
+stream_table_get(stream_table_t* table, const stream_key_t* key) {
+   uint32_t hash = hash_bytes(key, sizeof(*key));
+   size_t slot;
+   stream_t* s;
+
+   if ((table->count + 1) * 10 > table->capacity * 7) {
+      stream_table_grow(table);
+   }
+
+   for (slot = hash & (table->capacity - 1); table->slots[slot]; slot = (slot + 1) & (table->capacity - 1)) {
+      s = table->slots[slot];
+      if (s->hash == hash && memcmp(&s->key, key, sizeof(*key)) == 0) {
+         return s;
+      }
+   }
+
+   s = xcalloc(1, sizeof(*s));
+   s->key = *key;
+   s->hash = hash;
+   table->slots[slot] = s;
+
+   if (table->count == table->list_capacity) {
+      table->list_capacity = table->list_capacity ? table->list_capacity * 2 : 1024;
+      table->list = xrealloc(table->list, table->list_capacity * sizeof(*table->list));
+   }
+   table->list[table->count++] = s;
+   return s;
+}
+
+static void
+stream_append(stream_t* s, const segment_t* segments, size_t count) {
+   if (s->count + count > s->capacity) {
+      size_t capacity = s->capacity ? s->capacity : 16;
+
+      while (capacity < s->count + count) {
+         capacity *= 2;
+      }
+      s->segments = xrealloc(s->segments, capacity * sizeof(*s->segments));
+      s->capacity = capacity;
+   }
+   memcpy(s->segments + s->count, segments, count * sizeof(*segments));
+   s->count += count;
+}
+
+/*
+ * Packet decoding, down to the TCP payload
+ */
+typedef struct {
+   uint32_t family;
+   const uint8_t* src;
+   const uint8_t* dst;
+   uint16_t src_port;
+   uint16_t dst_port;
+   uint32_t seq;
+   uint8_t tcp_flags;
+   int whole_messages;          /* Exported PDU: the payload is whole messages with no TCP sequence */
+   const uint8_t* payload;
+   uint32_t payload_length;
+} packet_t;
+
+static int
+is_rbus_port(uint16_t port) {
+   for (unsigned i = 0; i < port_count; i++) {
+      if (ports[i] == port) {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+static int
+decode_tcp(const uint8_t* data, uint32_t length, packet_t* pkt) {
+   uint32_t header_length;
+
+   if (length < 20) {
+      return 0;
+   }
+   header_length = (uint32_t)(data[12] >> 4) * 4;
+   if (header_length < 20 || header_length > length) {
+      return 0;
+   }
+   pkt->src_port = get_be16(data);
+   pkt->dst_port = get_be16(data + 2);
+   pkt->seq = get_be32(data + 4);
+   pkt->tcp_flags = data[13];
+   pkt->payload = data + header_length;
+   pkt->payload_length = length - header_length;
+   return 1;
+}
+
+static int
+decode_ip(const uint8_t* data, uint32_t length, packet_t* pkt) {
+   if (length < 1) {
+      return 0;
+   }
+
+   if ((data[0] >> 4) == 4) {
+      uint32_t header_length = (uint32_t)(data[0] & 0x0F) * 4;
+      uint32_t total_length;
+
+      if (length < 20 || header_length < 20 || header_length > length) {
+         return 0;
+      }
+      /* The IP length excludes link layer padding; 0 is TSO, where the capture length is all there is */
+      total_length = get_be16(data + 2);
+      if (total_length >= header_length && total_length < length) {
+         length = total_length;
+      }
+      /* Fragments are left out */
+      if (data[9] != IPPROTO_TCP_NUMBER || (get_be16(data + 6) & 0x3FFF) != 0) {
+         return 0;
+      }
+      pkt->family = 4;
+      pkt->src = data + 12;
+      pkt->dst = data + 16;
+      return decode_tcp(data + header_length, length - header_length, pkt);
+   }
+
+   if ((data[0] >> 4) == 6) {
+      uint32_t offset = 40;
+      uint32_t payload_length;
+      uint8_t next;
+
+      if (length < 40) {
+         return 0;
+      }
+      payload_length = get_be16(data + 4);
+      if (payload_length && 40 + payload_length < length) {
+         length = 40 + payload_length;
+      }
+      next = data[6];
+
+      /* Hop-by-hop, routing and destination options headers */
+      while (next == 0 || next == 43 || next == 60) {
+         if (offset + 8 > length) {
+            return 0;
+         }
+         next = data[offset];
+         offset += ((uint32_t)data[offset + 1] + 1) * 8;
+      }
+      if (next != IPPROTO_TCP_NUMBER || offset > length) {
+         return 0;
+      }
+      pkt->family = 6;
+      pkt->src = data + 8;
+      pkt->dst = data + 24;
+      return decode_tcp(data + offset, length - offset, pkt);
+   }
+
+   return 0;
+}
+
+static int
+decode_ethertype(uint16_t type, const uint8_t* data, uint32_t length, packet_t* pkt) {
+   if (type != ETHERTYPE_IPV4 && type != ETHERTYPE_IPV6) {
+      return 0;
+   }
+   return decode_ip(data, length, pkt);
+}
+
+/* Exported PDU: tags with the addresses and ports, then the message */
+static int
+decode_exported_pdu(const uint8_t* data, uint32_t length, packet_t* pkt) {
+   static const uint8_t unspecified[16] = { 0 };
+   uint32_t offset = 0;
+   int is_rbus = 0;
+
+   pkt->family = 4;
+   pkt->src = unspecified;
+   pkt->dst = unspecified;
+   pkt->src_port = 0;
+   pkt->dst_port = 0;
+
+   for (;;) {
+      uint16_t tag;
+      uint16_t tag_length;
+
+      if (offset + 4 > length) {
+         return 0;
+      }
+      tag = get_be16(data + offset);
+      tag_length = get_be16(data + offset + 2);
+      offset += 4;
+      if (tag == EXP_PDU_TAG_END_OF_OPT) {
+         break;
+      }
+      if (offset + tag_length > length) {
+         return 0;
+      }
+
+      switch (tag) {
+         case EXP_PDU_TAG_DISSECTOR_NAME:
+            is_rbus = tag_length >= strlen(RBUS_PROTOCOL_NAME) &&
+               strncmp((const char*)data + offset, RBUS_PROTOCOL_NAME, tag_length) == 0;
+            break;
+         case EXP_PDU_TAG_IPV4_SRC:
+         case EXP_PDU_TAG_IPV4_DST:
+            if (tag_length >= 4) {
+               *(tag == EXP_PDU_TAG_IPV4_SRC ? &pkt->src : &pkt->dst) = data + offset;
+            }
+            break;
+         case EXP_PDU_TAG_IPV6_SRC:
+         case EXP_PDU_TAG_IPV6_DST:
+            if (tag_length >= 16) {
+               pkt->family = 6;
+               *(tag == EXP_PDU_TAG_IPV6_SRC ? &pkt->src : &pkt->dst) = data + offset;
+            }
+            break;
+         case EXP_PDU_TAG_SRC_PORT:
+         case EXP_PDU_TAG_DST_PORT:
+            if (tag_length >= 4) {
+               *(tag == EXP_PDU_TAG_SRC_PORT ? &pkt->src_port : &pkt->dst_port) = (uint16_t)get_be32(data + offset);
+            }
+            break;
+         default:
+            break;
+      }
+      offset += tag_length;
+   }
+
+   if (!is_rbus) {
+      return 0;
+   }
+   pkt->seq = 0;
+   pkt->tcp_flags = 0;
+   pkt->whole_messages = 1;
+   pkt->payload = data + offset;
+   pkt->payload_length = length - offset;
+   return 1;
+}
+
+static int
+decode_packet(uint32_t linktype, const uint8_t* data, uint32_t length, packet_t* pkt) {
+   uint32_t offset;
+   uint16_t type;
+
+   pkt->whole_messages = 0;
+
+   switch (linktype) {
+      case LINKTYPE_ETHERNET:
+         if (length < 14) {
+            return 0;
+         }
+         type = get_be16(data + 12);
+         offset = 14;
+         while ((type == ETHERTYPE_VLAN || type == ETHERTYPE_QINQ) && offset + 4 <= length) {
+            type = get_be16(data + offset + 2);
+            offset += 4;
+         }
+         return decode_ethertype(type, data + offset, length - offset, pkt);
+
+      case LINKTYPE_LINUX_SLL:
+         if (length < 16) {
+            return 0;
+         }
+         return decode_ethertype(get_be16(data + 14), data + 16, length - 16, pkt);
+
+      case LINKTYPE_LINUX_SLL2:
+         if (length < 20) {
+            return 0;
+         }
+         return decode_ethertype(get_be16(data), data + 20, length - 20, pkt);
+
+      case LINKTYPE_NULL:
+      case LINKTYPE_LOOP:
+         /* The address family is in either byte order; the IP version says enough */
+         if (length < 4) {
+            return 0;
+         }
+         return decode_ip(data + 4, length - 4, pkt);
+
+      case LINKTYPE_RAW_OLD:
+      case LINKTYPE_RAW:
+      case LINKTYPE_IPV4:
+      case LINKTYPE_IPV6:
+         return decode_ip(data, length, pkt);
+
+      case LINKTYPE_WIRESHARK_UPPER_PDU:
+         return decode_exported_pdu(data, length, pkt);
+
+      default:
+         return 0;
+   }
+}
+
+/*
+ * File the packet's payload under its stream if it is RBus traffic
+ */
+static void
+index_packet(capture_file_t* file, uint32_t linktype, const uint8_t* data, uint32_t length, uint64_t ts_us) {
+   size_t address_length;
+   stream_key_t key;
+   packet_t pkt;
+   segment_t seg;
+   stream_t* s;
+   int to_client;
+
+   file->frames++;
+
+   if (!decode_packet(linktype, data, length, &pkt)) {
+      return;
+   }
+   if (is_rbus_port(pkt.dst_port)) {
+      to_client = 0;
+   } else if (is_rbus_port(pkt.src_port)) {
+      to_client = 1;
+   } else if (pkt.whole_messages) {
+      to_client = 0;
+   } else {
+      return;
+   }
+   if (pkt.payload_length == 0 && !(pkt.tcp_flags & TCP_FLAG_SYN)) {
+      return;
+   }
+   if (pkt.payload_length > SEGMENT_LENGTH_MASK) {
+      return;
+   }
+
+   memset(&key, 0, sizeof(key));
+   address_length = pkt.family == 4 ? 4 : 16;
+   key.family = pkt.family;
+   memcpy(key.client_addr, to_client ? pkt.dst : pkt.src, address_length);
+   memcpy(key.server_addr, to_client ? pkt.src : pkt.dst, address_length);
+   key.client_port = to_client ? pkt.dst_port : pkt.src_port;
+   key.server_port = to_client ? pkt.src_port : pkt.dst_port;
+   s = stream_table_get(&file->streams, &key);
+
+   /* Exported PDUs are numbered as if they had been sent back to back */
+   if (pkt.whole_messages) {
+      pkt.seq = s->pdu_seq[to_client];
+      s->pdu_seq[to_client] += pkt.payload_length;
+   }
+
+   seg.data = pkt.payload;
+   seg.ts_us = ts_us;
+   seg.seq = pkt.seq;
+   seg.length_flags = pkt.payload_length | (to_client ? SEGMENT_TO_CLIENT : 0) |
+      ((pkt.tcp_flags & TCP_FLAG_SYN) ? SEGMENT_SYN : 0);
+   stream_append(s, &seg, 1);
+   s->bytes += pkt.payload_length;
+   file->segments++;
+}
+
+/*
+ * Capture file reading
+ */
+static void
+index_pcap(capture_file_t* file) {
+   const uint8_t* p = file->data;
+   size_t size = file->size;
+   uint32_t magic;
+   uint32_t linktype;
+   int swapped;
+   int nanoseconds;
+   size_t offset = 24;
+
+   memcpy(&magic, p, sizeof(magic));
+   swapped = (magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS));
+   nanoseconds = get_u32(p, swapped) == PCAP_MAGIC_NS;
+   linktype = get_u32(p + 20, swapped) & 0x0FFFFFFF;
+
+   while (offset + 16 <= size) {
+      uint32_t ts_sec = get_u32(p + offset, swapped);
+      uint32_t ts_frac = get_u32(p + offset + 4, swapped);
+      uint32_t captured = get_u32(p + offset + 8, swapped);
+
+      offset += 16;
+      if (captured > size - offset) {
+         snprintf(file->error, sizeof(file->error), "truncated record at offset %zu", offset - 16);
+         return;
+      }
+      index_packet(file, linktype, p + offset, captured,
+         (uint64_t)ts_sec * 1000000 + (nanoseconds ? ts_frac / 1000 : ts_frac));
+      offset += captured;
+   }
+}
+
+typedef struct {
+   uint32_t linktype;
+   uint64_t units_per_second;   /* Timestamp resolution */
+} interface_t;
+
+static uint64_t
+pcapng_ts_us(const interface_t* iface, uint64_t ts) {
+   if (iface->units_per_second == 1000000) {
+      return ts;
+   }
+   return ts / iface->units_per_second * 1000000 + ts % iface->units_per_second * 1000000 / iface->units_per_second;
+}
+
+static void
+pcapng_read_idb(const uint8_t* body, size_t length, int swapped, interface_t* iface) {
+   size_t offset = 8;
+
+   iface->linktype = get_u16(body, swapped);
+   iface->units_per_second = 1000000;
+
+   while (offset + 4 <= length) {
+      uint16_t code = get_u16(body + offset, swapped);
+      uint16_t option_length = get_u16(body + offset + 2, swapped);
+
+      offset += 4;
+      if (code == 0 || option_length > length - offset) {
+         break;
+      }
+      if (code == PCAPNG_OPT_IF_TSRESOL && option_length >= 1) {
+         uint8_t resol = body[offset];
+         unsigned exponent = resol & 0x7F;
+         uint64_t units = 1;
+
+         /* Resolutions finer than a picosecond are not worth the overflow risk */
+         if (exponent <= ((resol & 0x80) ? 40u : 12u)) {
+            for (unsigned i = 0; i < exponent; i++) {
+               units *= (resol & 0x80) ? 2 : 10;
+            }
+            iface->units_per_second = units;
+         }
+      }
+      offset += (option_length + 3u) & ~3u;
+   }
+}
+
+static void
+index_pcapng(capture_file_t* file) {
+   interface_t interfaces[MAX_INTERFACES];
+   unsigned interface_count = 0;
+   const uint8_t* p = file->data;
+   size_t size = file->size;
+   size_t offset = 0;
+   int swapped = 0;
+
+   while (offset + 12 <= size) {
+      uint32_t type;
+      uint32_t block_length;
+      const uint8_t* body;
+      size_t body_length;
+
+      /* The section header's byte-order magic sets the byte order of the section */
+      memcpy(&type, p + offset, sizeof(type));
+      if (type == PCAPNG_BLOCK_SHB) {
+         uint32_t magic;
+
+         memcpy(&magic, p + offset + 8, sizeof(magic));
+         if (magic != PCAPNG_BYTE_ORDER_MAGIC && magic != __builtin_bswap32(PCAPNG_BYTE_ORDER_MAGIC)) {
+            snprintf(file->error, sizeof(file->error), "bad section header at offset %zu", offset);
+            return;
+         }
+         swapped = magic != PCAPNG_BYTE_ORDER_MAGIC;
+         interface_count = 0;
+      }
+      type = get_u32(p + offset, swapped);
+      block_length = get_u32(p + offset + 4, swapped);
+      if (block_length < 12 || (block_length & 3) || block_length > size - offset) {
+         snprintf(file->error, sizeof(file->error), "truncated block at offset %zu", offset);
+         return;
+      }
+      body = p + offset + 8;
+      body_length = block_length - 12;
+
+      switch (type) {
+         case PCAPNG_BLOCK_IDB:
+            if (body_length >= 8 && interface_count < MAX_INTERFACES) {
+               pcapng_read_idb(body, body_length, swapped, &interfaces[interface_count++]);
+            }
+            break;
+
+         case PCAPNG_BLOCK_EPB: {
+            uint32_t iface;
+            uint32_t captured;
+
+            if (body_length < 20) {
+               break;
+            }
+            iface = get_u32(body, swapped);
+            captured = get_u32(body + 12, swapped);
+            if (iface < interface_count && captured <= body_length - 20) {
+               uint64_t ts = ((uint64_t)get_u32(body + 4, swapped) << 32) | get_u32(body + 8, swapped);
+               index_packet(file, interfaces[iface].linktype, body + 20, captured,
+                  pcapng_ts_us(&interfaces[iface], ts));
+            }
+            break;
+         }
+
+         case PCAPNG_BLOCK_PB: {
+            uint32_t iface;
+            uint32_t captured;
+
+            if (body_length < 20) {
+               break;
+            }
+            iface = get_u16(body, swapped);
+            captured = get_u32(body + 12, swapped);
+            if (iface < interface_count && captured <= body_length - 20) {
+               uint64_t ts = ((uint64_t)get_u32(body + 4, swapped) << 32) | get_u32(body + 8, swapped);
+               index_packet(file, interfaces[iface].linktype, body + 20, captured,
+                  pcapng_ts_us(&interfaces[iface], ts));
+            }
+            break;
+         }
+
+         case PCAPNG_BLOCK_SPB:
+            /* No timestamp; the captured length is what fits in the block */
+            if (body_length >= 4 && interface_count > 0) {
+               uint32_t captured = get_u32(body, swapped);
+
+               if (captured > body_length - 4) {
+                  captured = (uint32_t)(body_length - 4);
+               }
+               index_packet(file, interfaces[0].linktype, body + 4, captured, 0);
+            }
+            break;
+
+         default:
+            break;
+      }
+
+      offset += block_length;
+   }
+}
+
+static void
+index_file(capture_file_t* file) {
+   struct stat st;
+   uint32_t magic;
+   void* map;
+   int fd;
+
+   fd = open(file->path, O_RDONLY);
+   if (fd < 0 || fstat(fd, &st) < 0) {
+      snprintf(file->error, sizeof(file->error), "%s", strerror(errno));
+      if (fd >= 0) {
+         close(fd);
+      }
+      return;
+   }
+   if (st.st_size < 24) {
+      snprintf(file->error, sizeof(file->error), "not a capture file");
+      close(fd);
+      return;
+   }
+
+   /* Segments point into the mapping, so it stays until the analysis is done */
+   map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (map == MAP_FAILED) {
+      snprintf(file->error, sizeof(file->error), "mmap: %s", strerror(errno));
+      return;
+   }
+   madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+   file->data = map;
+   file->size = (size_t)st.st_size;
+
+   memcpy(&magic, file->data, sizeof(magic));
+   if (magic == PCAPNG_BLOCK_SHB) {
+      index_pcapng(file);
+   } else if (magic == PCAP_MAGIC_US || magic == PCAP_MAGIC_NS ||
+      magic == __builtin_bswap32(PCAP_MAGIC_US) || magic == __builtin_bswap32(PCAP_MAGIC_NS)) {
+      index_pcap(file);
+   } else {
+      snprintf(file->error, sizeof(file->error), "not a pcap or pcapng file");
+   }
+
+   /* Reassembly revisits the data stream by stream, not in file order */
+   madvise(map, (size_t)st.st_size, MADV_RANDOM);
+}
+
+/* Index files in parallel, one file per worker at a time */
+static void*
+index_worker(void* arg) {
+   (void)arg;
+
+   for (;;) {
+      unsigned i;
+
+      pthread_mutex_lock(&next_file_lock);
+      i = next_file++;
+      pthread_mutex_unlock(&next_file_lock);
+      if (i >= file_count) {
+         return NULL;
+      }
+      index_file(&files[i]);
+   }
+}
+
+/*
+ * Statistics
+ */
+static unsigned
+latency_bucket(uint64_t us) {
+   unsigned octave;
+   unsigned sub;
+
+   if (us < LATENCY_SUB_BUCKETS) {
+      return (unsigned)us;
+   }
+   octave = 63 - (unsigned)__builtin_clzll(us);
+   sub = (unsigned)(us >> (octave - 2)) & (LATENCY_SUB_BUCKETS - 1);
+   if (octave - 1 >= LATENCY_BUCKETS / LATENCY_SUB_BUCKETS) {
+      return LATENCY_BUCKETS - 1;
+   }
+   return (octave - 1) * LATENCY_SUB_BUCKETS + sub;
+}
+
+/* Middle of a bucket's range, in microseconds */
+static double
+latency_bucket_value(unsigned bucket) {
+   unsigned octave;
+   double low;
+
+   if (bucket < LATENCY_SUB_BUCKETS) {
+      return bucket;
+   }
+   octave = bucket / LATENCY_SUB_BUCKETS + 1;
+   low = (double)(1ull << octave) * (1.0 + (double)(bucket % LATENCY_SUB_BUCKETS) / LATENCY_SUB_BUCKETS);
+   return low + (double)(1ull << octave) / LATENCY_SUB_BUCKETS / 2;
+}
+
+static void
+latency_add(latency_t* l, uint64_t us) {
+   if (l->count == 0 || us < l->min_us) {
+      l->min_us = us;
+   }
+   if (us > l->max_us) {
+      l->max_us = us;
+   }
+   l->count++;
+   l->sum_us += us;
+   l->buckets[latency_bucket(us)]++;
+}
+
+static void
+latency_merge(latency_t* into, const latency_t* from) {
+   if (from->count == 0) {
+      return;
+   }
+   if (into->count == 0 || from->min_us < into->min_us) {
+      into->min_us = from->min_us;
+   }
+   if (from->max_us > into->max_us) {
+      into->max_us = from->max_us;
+   }
+   into->count += from->count;
+   into->sum_us += from->sum_us;
+   for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+      into->buckets[i] += from->buckets[i];
+   }
+}
+
+static double
+latency_percentile(const latency_t* l, double percentile) {
+   uint64_t rank = (uint64_t)(percentile / 100.0 * (double)l->count);
+   uint64_t seen = 0;
+
+   for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+      seen += l->buckets[i];
+      if (seen > rank) {
+         double value = latency_bucket_value(i);
+         return value < (double)l->min_us ? (double)l->min_us : value > (double)l->max_us ? (double)l->max_us : value;
+      }
+   }
+   return (double)l->max_us;
+}
+
+/* Return the entry for name, adding an empty one if new */
+static name_stats_t*
+name_table_get(name_table_t* table, const uint8_t* name, size_t length) {
+   uint32_t hash = hash_bytes(name, length);
+   size_t slot;
+   name_stats_t* e;
+
+   if ((table->count + 1) * 10 > table->capacity * 7) {
+      size_t capacity = table->capacity ? table->capacity * 2 : 256;
+      name_stats_t** slots = xcalloc(capacity, sizeof(*slots));
+
+      for (size_t i = 0; i < table->capacity; i++) {
+         if ((e = table->slots[i]) != NULL) {
+            for (slot = e->hash & (capacity - 1); slots[slot]; slot = (slot + 1) & (capacity - 1)) {
+            }
+            slots[slot] = e;
+         }
+      }
+      free(table->slots);
+      table->slots = slots;
+      table->capacity = capacity;
+   }
+
+   for (slot = hash & (table->capacity - 1); table->slots[slot]; slot = (slot + 1) & (table->capacity - 1)) {
+      e = table->slots[slot];
+      if (e->hash == hash && strlen(e->name) == length && memcmp(e->name, name, length) == 0) {
+         return e;
+      }
+   }
+
+   e = xcalloc(1, sizeof(*e));
+   e->name = xcalloc(1, length + 1);
+   memcpy(e->name, name, length);
+   e->hash = hash;
+   table->slots[slot] = e;
+   table->count++;
+   return e;
+}
+
+static void
+name_table_merge(name_table_t* into, const name_table_t* from) {
+   for (size_t i = 0; i < from->capacity; i++) {
+      const name_stats_t* f = from->slots[i];
+      name_stats_t* e;
+
+      if (!f) {
+         continue;
+      }
+      e = name_table_get(into, (const uint8_t*)f->name, strlen(f->name));
+      if (e->messages == 0 || (f->first_us && f->first_us < e->first_us)) {
+         e->first_us = f->first_us;
+      }
+      if (f->last_us > e->last_us) {
+         e->last_us = f->last_us;
+      }
+      e->messages += f->messages;
+      e->bytes += f->bytes;
+      latency_merge(&e->latency, &f->latency);
+   }
+}
+
+static void
+stats_merge(stats_t* into, const stats_t* from) {
+   for (unsigned k = 0; k < KIND_COUNT; k++) {
+      into->messages[k] += from->messages[k];
+      into->bytes[k] += from->bytes[k];
+   }
+   into->streams += from->streams;
+   into->unanswered += from->unanswered;
+   into->unmatched += from->unmatched;
+   into->malformed += from->malformed;
+   into->resync_bytes += from->resync_bytes;
+   into->gaps += from->gaps;
+   if (from->first_us && (!into->first_us || from->first_us < into->first_us)) {
+      into->first_us = from->first_us;
+   }
+   if (from->last_us > into->last_us) {
+      into->last_us = from->last_us;
+   }
+   for (unsigned m = 0; m < RBUS_METHOD_COUNT; m++) {
+      latency_merge(&into->methods[m], &from->methods[m]);
+   }
+   name_table_merge(&into->topics, &from->topics);
+   name_table_merge(&into->events, &from->events);
+}
+
+/*
+ * Stream analysis
+ */
+
+/* Requests awaiting their response, by sequence number; linear probing with backward-shift deletion */
+typedef struct {
+   uint32_t seq;
+   uint32_t used;
+   uint64_t ts_us;
+   rbus_method_t method;
+   name_stats_t* topic;
+} pending_t;
+
+typedef struct {
+   pending_t* slots;
+   size_t capacity;
+   size_t count;
+} pending_table_t;
+
+static pending_t*
+pending_find(pending_table_t* table, uint32_t seq) {
+   if (!table->count) {
+      return NULL;
+   }
+   for (size_t slot = (seq * 2654435761u) & (table->capacity - 1); table->slots[slot].used;
+      slot = (slot + 1) & (table->capacity - 1)) {
+      if (table->slots[slot].seq == seq) {
+         return &table->slots[slot];
+      }
+   }
+   return NULL;
+}
+
+static pending_t*
+pending_insert(pending_table_t* table, uint32_t seq) {
+   pending_t* p = pending_find(table, seq);
+   size_t slot;
+
+   if (p) {
+      return p;   /* A reused sequence number replaces the older request */
+   }
+
+   if ((table->count + 1) * 2 > table->capacity) {
+      size_t capacity = table->capacity ? table->capacity * 2 : 64;
+      pending_t* slots = xcalloc(capacity, sizeof(*slots));
+
+      for (size_t i = 0; i < table->capacity; i++) {
+         if (table->slots[i].used) {
+            for (slot = (table->slots[i].seq * 2654435761u) & (capacity - 1); slots[slot].used;
+               slot = (slot + 1) & (capacity - 1)) {
+            }
+            slots[slot] = table->slots[i];
+         }
+      }
+      free(table->slots);
+      table->slots = slots;
+      table->capacity = capacity;
+   }
+
+   for (slot = (seq * 2654435761u) & (table->capacity - 1); table->slots[slot].used;
+      slot = (slot + 1) & (table->capacity - 1)) {
+   }
+   table->slots[slot].used = 1;
+   table->slots[slot].seq = seq;
+   table->count++;
+   return &table->slots[slot];
+}
+
+static void
+pending_remove(pending_table_t* table, pending_t* p) {
+   size_t mask = table->capacity - 1;
+   size_t hole = (size_t)(p - table->slots);
+   size_t slot = hole;
+
+   table->slots[hole].used = 0;
+   table->count--;
+
+   /* Move later entries of the probe sequence into the hole */
+   for (;;) {
+      size_t home;
+
+      slot = (slot + 1) & mask;
+      if (!table->slots[slot].used) {
+         return;
+      }
+      home = (table->slots[slot].seq * 2654435761u) & mask;
+      if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+         table->slots[hole] = table->slots[slot];
+         table->slots[slot].used = 0;
+         hole = slot;
+      }
+   }
+}
+
+/* Bytes of one direction not yet framed into messages */
+typedef struct {
+   uint8_t* data;
+   size_t length;
+   size_t capacity;
+   uint32_t next_seq;
+   int synchronized;            /* next_seq is known */
+} direction_t;
+
+typedef struct {
+   stats_t* stats;
+   pending_table_t pending;
+   direction_t dir[2];
+} stream_state_t;
+
+static void
+direction_append(direction_t* d, const uint8_t* data, size_t length) {
+   if (d->length + length > d->capacity) {
+      size_t capacity = d->capacity ? d->capacity : 65536;
+
+      while (capacity < d->length + length) {
+         capacity *= 2;
+      }
+      d->data = xrealloc(d->data, capacity);
+      d->capacity = capacity;
+   }
+   memcpy(d->data + d->length, data, length);
+   d->length += length;
+}
+
+static name_stats_t*
+topic_prefix_stats(stats_t* stats, const uint8_t* topic, uint32_t length) {
+   uint32_t end = 0;
+   unsigned components = 0;
+
+   if (length == 0) {
+      return name_table_get(&stats->topics, (const uint8_t*)"Unknown", 7);
+   }
+   while (end < length) {
+      if (topic[end] == '.' && ++components == TOPIC_COMPONENTS) {
+         break;
+      }
+      end++;
+   }
+   return name_table_get(&stats->topics, topic, end);
+}
+
+static void
+analyze_message(stream_state_t* st, const uint8_t* data, size_t length, uint64_t ts_us) {
+   static const rbus_wire_limits_t limits = { MSGPACK_DEPTH_LIMIT, MSGPACK_OBJECT_LIMIT };
+   stats_t* stats = st->stats;
+   rbus_wire_header_t header;
+   const uint8_t* payload;
+   uint32_t payload_length;
+   name_stats_t* topic;
+   message_kind_t kind;
+
+   if (rbus_wire_parse_header(data, length, &header) != RBUS_WIRE_OK) {
+      stats->malformed++;
+      return;
+   }
+   payload = data + header.header_length;
+   payload_length = (uint32_t)(length - header.header_length);
+
+   if (!stats->first_us || ts_us < stats->first_us) {
+      stats->first_us = ts_us;
+   }
+   if (ts_us > stats->last_us) {
+      stats->last_us = ts_us;
+   }
+
+   topic = topic_prefix_stats(stats, data + header.topic_offset, header.topic_length);
+   topic->messages++;
+   topic->bytes += length;
+
+   if (payload_length > 0 && (payload[0] == '{' || payload[0] == '[')) {
+      kind = KIND_CONTROL;
+   } else if (header.flags & RTMSG_FLAG_REQUEST) {
+      rbus_wire_payload_t summary;
+      pending_t* p = pending_insert(&st->pending, header.sequence);
+
+      kind = KIND_REQUEST;
+      p->ts_us = ts_us;
+      p->topic = topic;
+      p->method = RBUS_METHOD_NONE;
+      if (rbus_wire_scan_payload(payload, payload_length, &limits, &summary) == RBUS_WIRE_OK) {
+         p->method = summary.method;
+      }
+   } else if (header.flags & RTMSG_FLAG_RESPONSE) {
+      pending_t* p = pending_find(&st->pending, header.sequence);
+
+      kind = KIND_RESPONSE;
+      if (p) {
+         uint64_t rt = ts_us >= p->ts_us ? ts_us - p->ts_us : 0;
+
+         latency_add(&stats->methods[p->method], rt);
+         latency_add(&p->topic->latency, rt);
+         pending_remove(&st->pending, p);
+      } else {
+         stats->unmatched++;
+      }
+   } else {
+      rbus_mp_object_t name;
+
+      /* Events: [eventName, eventType, ...] */
+      kind = KIND_OTHER;
+      if (payload_length > 0 && rbus_mp_read_head(payload, 0, payload_length, &name) && name.type == RBUS_MP_STR) {
+         name_stats_t* event = name_table_get(&stats->events, payload + name.data_offset, name.via.size);
+
+         /* Streams are analyzed one after another, so events arrive out of time order */
+         kind = KIND_EVENT;
+         if (event->messages == 0 || ts_us < event->first_us) {
+            event->first_us = ts_us;
+         }
+         if (ts_us > event->last_us) {
+            event->last_us = ts_us;
+         }
+         event->messages++;
+         event->bytes += payload_length;
+      }
+   }
+
+   stats->messages[kind]++;
+   stats->bytes[kind] += length;
+}
+
+/*
+ * Frame and analyze every whole message at the start of data; returns the
+ * bytes consumed. Bytes that cannot start a header are skipped up to the next
+ * plausible one.
+ */
+static size_t
+frame_messages(stream_state_t* st, const uint8_t* data, size_t length, uint64_t ts_us) {
+   size_t consumed = 0;
+
+   while (length - consumed >= RBUS_WIRE_FRAME_HEADER_LENGTH) {
+      const uint8_t* p = data + consumed;
+      size_t available = length - consumed;
+      size_t message_length;
+
+      if (!rbus_wire_header_plausible(p, available)) {
+         long next = rbus_wire_find_header(p + 1, available - 1);
+         size_t skip = next < 0 ? available - 1 : (size_t)next + 1;
+
+         st->stats->resync_bytes += skip;
+         consumed += skip;
+         continue;
+      }
+
+      message_length = rbus_wire_message_length(p, available);
+      if (message_length > available) {
+         break;
+      }
+      analyze_message(st, p, message_length, ts_us);
+      consumed += message_length;
+   }
+   return consumed;
+}
+
+static void
+analyze_segment(stream_state_t* st, const segment_t* seg) {
+   direction_t* d = &st->dir[(seg->length_flags & SEGMENT_TO_CLIENT) ? 1 : 0];
+   uint32_t length = seg->length_flags & SEGMENT_LENGTH_MASK;
+   const uint8_t* data = seg->data;
+   uint32_t seq = seg->seq;
+   int32_t delta;
+   size_t consumed;
+
+   /* A SYN starts the direction over, e.g. a reused port pair */
+   if (seg->length_flags & SEGMENT_SYN) {
+      d->length = 0;
+      d->next_seq = seq + 1;
+      d->synchronized = 1;
+      if (length == 0) {
+         return;
+      }
+      seq++;
+   }
+
+   if (!d->synchronized) {
+      d->next_seq = seq;
+      d->synchronized = 1;
+   }
+
+   delta = (int32_t)(seq - d->next_seq);
+   if (delta < 0) {
+      /* Retransmission: keep only what is new */
+      if ((uint32_t)-delta >= length) {
+         return;
+      }
+      data += (uint32_t)-delta;
+      length -= (uint32_t)-delta;
+   } else if (delta > 0) {
+      /* Lost data: what is buffered cannot be completed */
+      st->stats->gaps++;
+      st->stats->resync_bytes += d->length;
+      d->length = 0;
+   }
+   d->next_seq = seq + (uint32_t)(delta < 0 ? (uint32_t)-delta : 0) + length;
+
+   /* Whole messages straight from the capture, copying only what a later segment completes */
+   if (d->length == 0) {
+      consumed = frame_messages(st, data, length, seg->ts_us);
+      if (consumed < length) {
+         direction_append(d, data + consumed, length - consumed);
+      }
+      return;
+   }
+
+   direction_append(d, data, length);
+   consumed = frame_messages(st, d->data, d->length, seg->ts_us);
+   if (consumed > 0) {
+      memmove(d->data, d->data + consumed, d->length - consumed);
+      d->length -= consumed;
+   }
+}
+
+static void
+analyze_stream(stats_t* stats, const stream_t* s) {
+   stream_state_t st;
+
+   memset(&st, 0, sizeof(st));
+   st.stats = stats;
+
+   for (size_t i = 0; i < s->count; i++) {
+      analyze_segment(&st, &s->segments[i]);
+   }
+
+   stats->streams++;
+   stats->unanswered += st.pending.count;
+   stats->resync_bytes += st.dir[0].length + st.dir[1].length;
+   free(st.pending.slots);
+   free(st.dir[0].data);
+   free(st.dir[1].data);
+}
+
+/*
+ * Scheduling
+ */
+static void
+queue_push(work_queue_t* q, size_t item) {
+   if (q->tail == q->capacity) {
+      q->capacity = q->capacity ? q->capacity * 2 : 64;
+      q->items = xrealloc(q->items, q->capacity * sizeof(*q->items));
+   }
+   q->items[q->tail++] = item;
+}
+
+static int
+queue_pop(work_queue_t* q, size_t* item) {
+   int found = 0;
+
+   pthread_mutex_lock(&q->lock);
+   if (q->head < q->tail) {
+      *item = q->items[--q->tail];
+      found = 1;
+   }
+   pthread_mutex_unlock(&q->lock);
+   return found;
+}
+
+static int
+queue_steal(work_queue_t* q, size_t* item) {
+   int found = 0;
+
+   pthread_mutex_lock(&q->lock);
+   if (q->head < q->tail) {
+      *item = q->items[q->head++];
+      found = 1;
+   }
+   pthread_mutex_unlock(&q->lock);
+   return found;
+}
+
+static void*
+analyze_worker(void* arg) {
+   worker_t* w = (worker_t*)arg;
+   size_t item = 0;
+
+   for (;;) {
+      unsigned victim;
+
+      if (queue_pop(&w->queue, &item)) {
+         analyze_stream(&w->stats, streams.list[item]);
+         continue;
+      }
+
+      /* Own queue empty: steal, starting from the next worker round */
+      for (victim = 1; victim < worker_count; victim++) {
+         if (queue_steal(&workers[(w->id + victim) % worker_count].queue, &item)) {
+            break;
+         }
+      }
+      if (victim == worker_count) {
+         return NULL;   /* No work is ever added, so all queues stay empty */
+      }
+      w->streams_stolen++;
+      analyze_stream(&w->stats, streams.list[item]);
+   }
+}
+
+static int
+compare_stream_bytes(const void* a, const void* b) {
+   const stream_t* sa = streams.list[*(const size_t*)a];
+   const stream_t* sb = streams.list[*(const size_t*)b];
+
+   return sa->bytes < sb->bytes ? -1 : sa->bytes > sb->bytes;
+}
+
+/*
+ * Streams are dealt out smallest first, so every queue ends in its largest
+ * streams: owners start with those and thieves pick up the small ones left
+ */
+static void
+schedule_streams(void) {
+   size_t* order = xcalloc(streams.count ? streams.count : 1, sizeof(*order));
+
+   for (size_t i = 0; i < streams.count; i++) {
+      order[i] = i;
+   }
+   qsort(order, streams.count, sizeof(*order), compare_stream_bytes);
+   for (size_t i = 0; i < streams.count; i++) {
+      queue_push(&workers[i % worker_count].queue, order[i]);
+   }
+   free(order);
+}
+
+/*
+ * Report
+ */
+static int
+compare_names(const void* a, const void* b) {
+   const name_stats_t* na = *(const name_stats_t* const*)a;
+   const name_stats_t* nb = *(const name_stats_t* const*)b;
+
+   if (na->messages != nb->messages) {
+      return na->messages > nb->messages ? -1 : 1;
+   }
+   return strcmp(na->name, nb->name);
+}
+
+/* Entries sorted by message count, most first */
+static name_stats_t**
+name_table_sorted(const name_table_t* table) {
+   name_stats_t** sorted = xcalloc(table->count ? table->count : 1, sizeof(*sorted));
+   size_t n = 0;
+
+   for (size_t i = 0; i < table->capacity; i++) {
+      if (table->slots[i]) {
+         sorted[n++] = table->slots[i];
+      }
+   }
+   qsort(sorted, n, sizeof(*sorted), compare_names);
+   return sorted;
+}
+
+/* Name column wide enough for the longest of the names listed, as tshark -z sizes its columns */
+static int
+name_width(name_stats_t* const* names, size_t count) {
+   size_t width = NAME_WIDTH;
+
+   for (size_t i = 0; i < count; i++) {
+      size_t length = strlen(names[i]->name);
+
+      if (length > width) {
+         width = length;
+      }
+   }
+   return (int)width;
+}
+
+static void
+print_latency_header(const char* title, int width) {
+   printf("\n%-*s %10s %10s %10s %10s %10s %10s\n", width, title, "Count", "Min ms", "Avg ms", "P50 ms", "P99 ms",
+      "Max ms");
+}
+
+static void
+print_latency(const char* name, int width, const latency_t* l) {
+   printf("%-*s %10llu %10.3f %10.3f %10.3f %10.3f %10.3f\n", width, name, (unsigned long long)l->count,
+      l->min_us / 1000.0, (double)l->sum_us / (double)l->count / 1000.0,
+      latency_percentile(l, 50) / 1000.0, latency_percentile(l, 99) / 1000.0, l->max_us / 1000.0);
+}
+
+static void
+report(const stats_t* total, uint64_t frames, uint64_t file_bytes, unsigned top,
+   uint64_t index_us, uint64_t analyze_us) {
+   uint64_t messages = 0;
+   uint64_t bytes = 0;
+   uint64_t stolen = 0;
+   double seconds = (index_us + analyze_us) / 1e6;
+   name_stats_t** sorted;
+   size_t shown;
+   int width;
+
+   for (unsigned k = 0; k < KIND_COUNT; k++) {
+      messages += total->messages[k];
+      bytes += total->bytes[k];
+   }
+   for (unsigned i = 0; i < worker_count; i++) {
+      stolen += workers[i].streams_stolen;
+   }
+
+   printf("Files: %u, %.1f MB, %llu frames, %llu RBus TCP streams\n", file_count, file_bytes / 1e6,
+      (unsigned long long)frames, (unsigned long long)total->streams);
+   printf("Capture span: %.3f s\n", total->last_us > total->first_us ? (total->last_us - total->first_us) / 1e6 : 0.0);
+   printf("Indexed in %.2f s, analyzed in %.2f s on %u threads (%llu streams stolen), %.1f MB/s\n",
+      index_us / 1e6, analyze_us / 1e6, worker_count, (unsigned long long)stolen,
+      seconds > 0 ? file_bytes / 1e6 / seconds : 0.0);
+
+   printf("\n%-40s %12s %14s\n", "Messages", "Count", "Bytes");
+   for (unsigned k = 0; k < KIND_COUNT; k++) {
+      printf("%-40s %12llu %14llu\n", kind_names[k], (unsigned long long)total->messages[k],
+         (unsigned long long)total->bytes[k]);
+   }
+   printf("%-40s %12llu %14llu\n", "Total", (unsigned long long)messages, (unsigned long long)bytes);
+
+   printf("\nUnanswered requests: %llu, unmatched responses: %llu, malformed: %llu\n",
+      (unsigned long long)total->unanswered, (unsigned long long)total->unmatched,
+      (unsigned long long)total->malformed);
+   printf("Sequence gaps: %llu, bytes skipped resynchronizing: %llu\n",
+      (unsigned long long)total->gaps, (unsigned long long)total->resync_bytes);
+
+   print_latency_header("Response Time by Method", NAME_WIDTH);
+   for (unsigned m = 0; m < RBUS_METHOD_COUNT; m++) {
+      if (total->methods[m].count) {
+         print_latency(m == RBUS_METHOD_NONE ? "Unknown" : rbus_wire_method_name((rbus_method_t)m), NAME_WIDTH,
+            &total->methods[m]);
+      }
+   }
+
+   sorted = name_table_sorted(&total->topics);
+   shown = total->topics.count < top ? total->topics.count : top;
+   width = name_width(sorted, shown);
+   printf("\n%-*s %12s %14s\n", width, "Topic Prefixes", "Messages", "Bytes");
+   for (size_t i = 0; i < shown; i++) {
+      printf("%-*s %12llu %14llu\n", width, sorted[i]->name, (unsigned long long)sorted[i]->messages,
+         (unsigned long long)sorted[i]->bytes);
+   }
+   print_latency_header("Response Time by Topic Prefix", width);
+   for (size_t i = 0; i < shown; i++) {
+      if (sorted[i]->latency.count) {
+         print_latency(sorted[i]->name, width, &sorted[i]->latency);
+      }
+   }
+   free(sorted);
+
+   sorted = name_table_sorted(&total->events);
+   shown = total->events.count < top ? total->events.count : top;
+   width = name_width(sorted, shown);
+   printf("\n%-*s %12s %10s %14s\n", width, "Event Publications", "Count", "Rate/s", "Payload Bytes");
+   for (size_t i = 0; i < shown; i++) {
+      uint64_t span = sorted[i]->last_us - sorted[i]->first_us;
+
+      printf("%-*s %12llu %10.2f %14llu\n", width, sorted[i]->name, (unsigned long long)sorted[i]->messages,
+         span > 0 ? (sorted[i]->messages - 1) * 1e6 / (double)span : 0.0, (unsigned long long)sorted[i]->bytes);
+   }
+   free(sorted);
+}
+
+static void
+usage(const char* prog) {
+   fprintf(stderr,
+      "Usage: %s [-t <threads>] [-p <port>[,<port>...]] [-n <top>] <capture>...\n"
+      "  -t  Worker threads (default: online CPUs)\n"
+      "  -p  RBus TCP ports (default %d)\n"
+      "  -n  Topic prefixes and event names listed (default %d)\n",
+      prog, RBUS_DEFAULT_TCP_PORT, DEFAULT_TOP);
+}
+
+static int
+parse_ports(const char* arg) {
+   char* copy = strdup(arg);
+   char* save = NULL;
+
+   port_count = 0;
+   for (char* tok = strtok_r(copy, ",", &save); tok; tok = strtok_r(NULL, ",", &save)) {
+      long port = strtol(tok, NULL, 10);
+
+      if (port <= 0 || port > 65535 || port_count == MAX_PORTS) {
+         free(copy);
+         return -1;
+      }
+      ports[port_count++] = (uint16_t)port;
+   }
+   free(copy);
+   return port_count > 0 ? 0 : -1;
+}
+
+int
+main(int argc, char* argv[]) {
+   long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+   unsigned top = DEFAULT_TOP;
+   uint64_t frames = 0;
+   uint64_t file_bytes = 0;
+   uint64_t start;
+   uint64_t index_us;
+   uint64_t analyze_us;
+   pthread_t* indexers;
+   unsigned indexer_count;
+   stats_t total;
+   int opt;
+
+   worker_count = cpus > 0 ? (unsigned)cpus : 1;
+   ports[port_count++] = RBUS_DEFAULT_TCP_PORT;
+
+   while ((opt = getopt(argc, argv, "t:p:n:h")) != -1) {
+      switch (opt) {
+         case 't': worker_count = (unsigned)strtoul(optarg, NULL, 10); break;
+         case 'p':
+            if (parse_ports(optarg) < 0) {
+               fatal("Invalid port list: %s", optarg);
+            }
+            break;
+         case 'n': top = (unsigned)strtoul(optarg, NULL, 10); break;
+         default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+      }
+   }
+   if (optind >= argc || worker_count == 0) {
+      usage(argv[0]);
+      return 1;
+   }
+
+   file_count = (unsigned)(argc - optind);
+   files = xcalloc(file_count, sizeof(*files));
+   for (unsigned i = 0; i < file_count; i++) {
+      files[i].path = argv[optind + i];
+   }
+
+   /* Index the files in parallel, then join their streams in file order */
+   start = now_us();
+   indexer_count = worker_count < file_count ? worker_count : file_count;
+   indexers = xcalloc(indexer_count, sizeof(*indexers));
+   for (unsigned i = 0; i < indexer_count; i++) {
+      if (pthread_create(&indexers[i], NULL, index_worker, NULL) != 0) {
+         fatal("Cannot start thread: %s", strerror(errno));
+      }
+   }
+   for (unsigned i = 0; i < indexer_count; i++) {
+      pthread_join(indexers[i], NULL);
+   }
+   free(indexers);
+
+   for (unsigned i = 0; i < file_count; i++) {
+      capture_file_t* file = &files[i];
+
+      if (file->error[0]) {
+         fprintf(stderr, "%s: %s\n", file->path, file->error);
+      }
+      frames += file->frames;
+      file_bytes += file->size;
+      for (size_t j = 0; j < file->streams.count; j++) {
+         stream_t* s = file->streams.list[j];
+
+         stream_append(stream_table_get(&streams, &s->key), s->segments, s->count);
+         stream_table_get(&streams, &s->key)->bytes += s->bytes;
+         free(s->segments);
+         free(s);
+      }
+      free(file->streams.slots);
+      free(file->streams.list);
+   }
+   index_us = now_us() - start;
+
+   /* Analyze the streams on the workers */
+   start = now_us();
+   workers = xcalloc(worker_count, sizeof(*workers));
+   for (unsigned i = 0; i < worker_count; i++) {
+      workers[i].id = i;
+      pthread_mutex_init(&workers[i].queue.lock, NULL);
+   }
+   schedule_streams();
+   for (unsigned i = 0; i < worker_count; i++) {
+      if (pthread_create(&workers[i].thread, NULL, analyze_worker, &workers[i]) != 0) {
+         fatal("Cannot start thread: %s", strerror(errno));
+      }
+   }
+   for (unsigned i = 0; i < worker_count; i++) {
+      pthread_join(workers[i].thread, NULL);
+   }
+
+   memset(&total, 0, sizeof(total));
+   for (unsigned i = 0; i < worker_count; i++) {
+      stats_merge(&total, &workers[i].stats);
+   }
+   analyze_us = now_us() - start;
+
+   report(&total, frames, file_bytes, top, index_us, analyze_us);
+
+   for (unsigned i = 0; i < file_count; i++) {
+      if (files[i].data) {
+         munmap((void*)files[i].data, files[i].size);
+      }
+   }
+   return 0;
+}
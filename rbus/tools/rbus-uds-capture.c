@@ -0,0 +1,570 @@
+/*
+ * rbus-uds-capture.c - Capture RBus traffic on the Unix domain socket transport
+ *
+ * Copyright 2026
+ * Licensed under the Apache License, Version 2.0
+ *
+ * rtrouted listens on a Unix domain socket by default, which tcpdump cannot
+ * see. This tool sits between the clients and the daemon: it listens on the
+ * socket path the clients use, forwards every connection to the daemon's real
+ * socket, and writes each RBus message that passes through to a pcapng file
+ * using Wireshark's exported-PDU link type, addressed to the "rbus" dissector.
+ *
+ * Typical use:
+ *   rtrouted -f -s unix:///tmp/rtrouted.real
+ *   rbus-uds-capture -u /tmp/rtrouted.real -w rbus.pcapng
+ *
+ * Each connection is given its own pair of loopback ports (client port
+ * 1024 + connection number, daemon port 10002) so Wireshark tracks it as a
+ * separate conversation. "-w -" writes to stdout for live viewing:
+ *   rbus-uds-capture -u /tmp/rtrouted.real -w - | wireshark -k -i -
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "rbus-protocol.h"
+#include "rbus-wire.h"
+
+/* pcapng block types */
+#define PCAPNG_BLOCK_SHB 0x0A0D0D0A
+#define PCAPNG_BLOCK_IDB 0x00000001
+#define PCAPNG_BLOCK_EPB 0x00000006
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+
+/* Wireshark exported PDU link type and tags (epan/exported_pdu.h) */
+#define LINKTYPE_WIRESHARK_UPPER_PDU 252
+#define EXP_PDU_TAG_END_OF_OPT 0
+#define EXP_PDU_TAG_DISSECTOR_NAME 12
+#define EXP_PDU_TAG_IPV4_SRC 20
+#define EXP_PDU_TAG_IPV4_DST 21
+#define EXP_PDU_TAG_PORT_TYPE 24
+#define EXP_PDU_TAG_SRC_PORT 25
+#define EXP_PDU_TAG_DST_PORT 26
+#define EXP_PDU_PT_TCP 2
+
+#define MAX_CONNECTIONS 64
+#define IO_BUFFER_SIZE 65536
+#define CLIENT_PORT_BASE 1024
+#define MAX_PENDING_OUTPUT (4 * 1024 * 1024)   /* Stop reading a side while its peer has this much unsent */
+
+/* Growable byte buffer: reassembly into whole messages, or output a socket has not taken yet */
+typedef struct {
+   uint8_t* data;
+   size_t length;
+   size_t capacity;
+} stream_buffer_t;
+
+/*
+ * Sockets are non-blocking. What a side has sent is queued for its peer and
+ * written as the peer accepts it, so a slow reader only stalls its own
+ * connection. A side that hangs up is closed at once; its peer stays open
+ * until what is queued for it has been written.
+ */
+typedef struct {
+   int in_use;
+   int client_fd;               /* -1 once the client has hung up */
+   int daemon_fd;               /* -1 once the daemon has hung up */
+   uint16_t client_port;
+   stream_buffer_t to_daemon;   /* Capture reassembly, per direction */
+   stream_buffer_t to_client;
+   stream_buffer_t out_daemon;  /* Relayed but not yet written, per destination */
+   stream_buffer_t out_client;
+} connection_t;
+
+static FILE* output = NULL;
+static connection_t connections[MAX_CONNECTIONS];
+static volatile sig_atomic_t stop_requested = 0;
+static unsigned long messages_written = 0;
+
+static void
+handle_signal(int sig) {
+   (void)sig;
+   stop_requested = 1;
+}
+
+static void
+usage(const char* prog) {
+   fprintf(stderr,
+      "Usage: %s -u <daemon socket> [-l <listen socket>] -w <file|->\n"
+      "  -u  Socket rtrouted actually listens on (e.g. /tmp/rtrouted.real)\n"
+      "  -l  Socket to accept clients on (default %s)\n"
+      "  -w  pcapng output file, or - for stdout\n",
+      prog, RBUS_DEFAULT_UDS_PATH);
+}
+
+/*
+ * pcapng output, in host byte order; readers detect it from the byte-order magic
+ */
+static void
+write_u16(uint16_t value) {
+   fwrite(&value, sizeof(value), 1, output);
+}
+
+static void
+write_u32(uint32_t value) {
+   fwrite(&value, sizeof(value), 1, output);
+}
+
+static void
+write_pcapng_header(void) {
+   /* Section header block: no options, unknown section length */
+   write_u32(PCAPNG_BLOCK_SHB);
+   write_u32(28);
+   write_u32(PCAPNG_BYTE_ORDER_MAGIC);
+   write_u16(1);                /* Version 1.0 */
+   write_u16(0);
+   write_u32(0xFFFFFFFF);       /* Section length -1 */
+   write_u32(0xFFFFFFFF);
+   write_u32(28);
+
+   /* Interface description block: exported PDUs, no snaplen limit */
+   write_u32(PCAPNG_BLOCK_IDB);
+   write_u32(20);
+   write_u16(LINKTYPE_WIRESHARK_UPPER_PDU);
+   write_u16(0);                /* Reserved */
+   write_u32(0);                /* Snaplen */
+   write_u32(20);
+}
+
+/* Append an exported-PDU tag; tags are big-endian and padded to 4 bytes */
+static size_t
+put_tag(uint8_t* buf, uint16_t tag, const void* value, uint16_t length) {
+   uint16_t padded = (uint16_t)((length + 3) & ~3);
+
+   buf[0] = (uint8_t)(tag >> 8);
+   buf[1] = (uint8_t)tag;
+   buf[2] = (uint8_t)(padded >> 8);
+   buf[3] = (uint8_t)padded;
+   memset(buf + 4, 0, padded);
+   memcpy(buf + 4, value, length);
+   return 4 + (size_t)padded;
+}
+
+static size_t
+put_tag_u32(uint8_t* buf, uint16_t tag, uint32_t value) {
+   uint8_t be[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value };
+   return put_tag(buf, tag, be, sizeof(be));
+}
+
+/*
+ * Write one message as an enhanced packet block carrying an exported PDU
+ */
+static void
+write_message(const connection_t* conn, int to_daemon, const uint8_t* data, size_t length) {
+   static const uint8_t loopback[4] = { 127, 0, 0, 1 };
+   uint8_t tags[64];
+   size_t tags_length = 0;
+   struct timeval tv;
+   uint64_t ts;
+   uint32_t captured;
+   uint32_t padding;
+   uint32_t block_length;
+
+   tags_length += put_tag(tags + tags_length, EXP_PDU_TAG_DISSECTOR_NAME,
+      RBUS_PROTOCOL_NAME, (uint16_t)strlen(RBUS_PROTOCOL_NAME));
+   tags_length += put_tag(tags + tags_length, EXP_PDU_TAG_IPV4_SRC, loopback, 4);
+   tags_length += put_tag(tags + tags_length, EXP_PDU_TAG_IPV4_DST, loopback, 4);
+   tags_length += put_tag_u32(tags + tags_length, EXP_PDU_TAG_PORT_TYPE, EXP_PDU_PT_TCP);
+   tags_length += put_tag_u32(tags + tags_length, EXP_PDU_TAG_SRC_PORT,
+      to_daemon ? conn->client_port : RBUS_DEFAULT_TCP_PORT);
+   tags_length += put_tag_u32(tags + tags_length, EXP_PDU_TAG_DST_PORT,
+      to_daemon ? RBUS_DEFAULT_TCP_PORT : conn->client_port);
+   tags_length += put_tag(tags + tags_length, EXP_PDU_TAG_END_OF_OPT, NULL, 0);
+
+   gettimeofday(&tv, NULL);
+   ts = (uint64_t)tv.tv_sec * 1000000 + (uint64_t)tv.tv_usec;
+
+   captured = (uint32_t)(tags_length + length);
+   padding = (4 - (captured & 3)) & 3;
+   block_length = 32 + captured + padding;
+
+   write_u32(PCAPNG_BLOCK_EPB);
+   write_u32(block_length);
+   write_u32(0);                        /* Interface 0 */
+   write_u32((uint32_t)(ts >> 32));     /* Timestamp, microseconds */
+   write_u32((uint32_t)ts);
+   write_u32(captured);
+   write_u32(captured);
+   fwrite(tags, 1, tags_length, output);
+   fwrite(data, 1, length, output);
+   fwrite("\0\0\0", 1, padding, output);
+   write_u32(block_length);
+   fflush(output);
+
+   messages_written++;
+}
+
+/*
+ * Message framing. Bytes that do not start a plausible header (e.g. a
+ * connection already running when the tool was started) are written out up
+ * to the next marker as-is; the dissector shows them as unsynchronized data.
+ */
+static size_t
+message_length(const uint8_t* data, size_t available) {
+   long next;
+
+   if (available < RBUS_WIRE_FRAME_HEADER_LENGTH) {
+      return 0;
+   }
+   if (rbus_wire_header_plausible(data, available)) {
+      return rbus_wire_message_length(data, available);
+   }
+
+   next = rbus_wire_find_header(data + 1, available - 1);
+   return next < 0 ? available : (size_t)next + 1;
+}
+
+static int
+stream_append(stream_buffer_t* stream, const uint8_t* data, size_t length) {
+   if (stream->length + length > stream->capacity) {
+      size_t capacity = stream->capacity ? stream->capacity : IO_BUFFER_SIZE;
+      uint8_t* grown;
+
+      while (capacity < stream->length + length) {
+         capacity *= 2;
+      }
+      grown = realloc(stream->data, capacity);
+      if (!grown) {
+         return -1;
+      }
+      stream->data = grown;
+      stream->capacity = capacity;
+   }
+   memcpy(stream->data + stream->length, data, length);
+   stream->length += length;
+   return 0;
+}
+
+/* Write out every complete message buffered for one direction */
+static void
+stream_flush_messages(connection_t* conn, stream_buffer_t* stream, int to_daemon) {
+   size_t consumed = 0;
+
+   for (;;) {
+      size_t length = message_length(stream->data + consumed, stream->length - consumed);
+
+      if (length == 0 || length > stream->length - consumed) {
+         break;
+      }
+      write_message(conn, to_daemon, stream->data + consumed, length);
+      consumed += length;
+   }
+
+   if (consumed > 0) {
+      memmove(stream->data, stream->data + consumed, stream->length - consumed);
+      stream->length -= consumed;
+   }
+}
+
+/*
+ * Connection handling
+ */
+static int
+connect_daemon(const char* path) {
+   struct sockaddr_un addr;
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+   if (fd < 0) {
+      return -1;
+   }
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+   if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+      close(fd);
+      return -1;
+   }
+   return fd;
+}
+
+static int
+listen_clients(const char* path) {
+   struct sockaddr_un addr;
+   int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+   if (fd < 0) {
+      return -1;
+   }
+   unlink(path);
+   memset(&addr, 0, sizeof(addr));
+   addr.sun_family = AF_UNIX;
+   strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+   if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+      close(fd);
+      return -1;
+   }
+   return fd;
+}
+
+static int
+set_nonblocking(int fd) {
+   int flags = fcntl(fd, F_GETFL, 0);
+
+   return (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) ? -1 : 0;
+}
+
+static void
+close_connection(connection_t* conn) {
+   if (conn->client_fd >= 0) {
+      close(conn->client_fd);
+   }
+   if (conn->daemon_fd >= 0) {
+      close(conn->daemon_fd);
+   }
+   free(conn->to_daemon.data);
+   free(conn->to_client.data);
+   free(conn->out_daemon.data);
+   free(conn->out_client.data);
+   memset(conn, 0, sizeof(*conn));
+   conn->client_fd = -1;
+   conn->daemon_fd = -1;
+}
+
+/* Write as much queued output as fd takes without blocking; -1 on a write error */
+static int
+flush_output(int fd, stream_buffer_t* out) {
+   size_t written = 0;
+
+   while (written < out->length) {
+      ssize_t n = write(fd, out->data + written, out->length - written);
+
+      if (n < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+         }
+         return -1;
+      }
+      written += (size_t)n;
+   }
+
+   if (written > 0) {
+      memmove(out->data, out->data + written, out->length - written);
+      out->length -= written;
+   }
+   return 0;
+}
+
+typedef enum {
+   RELAY_OK,
+   RELAY_EOF,       /* The source side hung up */
+   RELAY_FAILED     /* The connection cannot go on */
+} relay_status_t;
+
+/* Queue one read from a side for its peer, try to write it, and record it */
+static relay_status_t
+relay(connection_t* conn, int to_daemon) {
+   static uint8_t buf[IO_BUFFER_SIZE];
+   int src = to_daemon ? conn->client_fd : conn->daemon_fd;
+   int dst = to_daemon ? conn->daemon_fd : conn->client_fd;
+   stream_buffer_t* stream = to_daemon ? &conn->to_daemon : &conn->to_client;
+   stream_buffer_t* out = to_daemon ? &conn->out_daemon : &conn->out_client;
+   ssize_t n = read(src, buf, sizeof(buf));
+
+   if (n < 0) {
+      return (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) ? RELAY_OK : RELAY_EOF;
+   }
+   if (n == 0) {
+      return RELAY_EOF;
+   }
+   if (stream_append(out, buf, (size_t)n) < 0 || flush_output(dst, out) < 0) {
+      return RELAY_FAILED;
+   }
+   if (stream_append(stream, buf, (size_t)n) < 0) {
+      return RELAY_FAILED;
+   }
+   stream_flush_messages(conn, stream, to_daemon);
+   return RELAY_OK;
+}
+
+/* Poll events for one side: read while its peer's queue has room, write while its own queue is not empty */
+static short
+side_events(int peer_fd, const stream_buffer_t* peer_out, const stream_buffer_t* out) {
+   short events = 0;
+
+   if (peer_fd >= 0 && peer_out->length < MAX_PENDING_OUTPUT) {
+      events |= POLLIN;
+   }
+   if (out->length > 0) {
+      events |= POLLOUT;
+   }
+   return events;
+}
+
+int
+main(int argc, char* argv[]) {
+   const char* listen_path = RBUS_DEFAULT_UDS_PATH;
+   const char* daemon_path = NULL;
+   const char* output_path = NULL;
+   unsigned connection_count = 0;
+   int listen_fd;
+   int opt;
+   int i;
+
+   while ((opt = getopt(argc, argv, "l:u:w:h")) != -1) {
+      switch (opt) {
+         case 'l': listen_path = optarg; break;
+         case 'u': daemon_path = optarg; break;
+         case 'w': output_path = optarg; break;
+         default:
+            usage(argv[0]);
+            return opt == 'h' ? 0 : 1;
+      }
+   }
+   if (!daemon_path || !output_path || strcmp(daemon_path, listen_path) == 0) {
+      usage(argv[0]);
+      return 1;
+   }
+
+   output = strcmp(output_path, "-") == 0 ? stdout : fopen(output_path, "wb");
+   if (!output) {
+      fprintf(stderr, "Cannot open %s: %s\n", output_path, strerror(errno));
+      return 1;
+   }
+
+   listen_fd = listen_clients(listen_path);
+   if (listen_fd < 0) {
+      fprintf(stderr, "Cannot listen on %s: %s\n", listen_path, strerror(errno));
+      return 1;
+   }
+
+   signal(SIGINT, handle_signal);
+   signal(SIGTERM, handle_signal);
+   signal(SIGPIPE, SIG_IGN);
+
+   for (i = 0; i < MAX_CONNECTIONS; i++) {
+      connections[i].client_fd = -1;
+      connections[i].daemon_fd = -1;
+   }
+
+   write_pcapng_header();
+   fprintf(stderr, "Forwarding %s -> %s\n", listen_path, daemon_path);
+
+   while (!stop_requested) {
+      struct pollfd fds[1 + 2 * MAX_CONNECTIONS];
+      int owner[1 + 2 * MAX_CONNECTIONS];
+      int from_client[1 + 2 * MAX_CONNECTIONS];
+      nfds_t nfds = 0;
+
+      fds[nfds].fd = listen_fd;
+      fds[nfds].events = POLLIN;
+      owner[nfds++] = -1;
+      for (i = 0; i < MAX_CONNECTIONS; i++) {
+         connection_t* conn = &connections[i];
+
+         if (!conn->in_use) {
+            continue;
+         }
+         if (conn->client_fd >= 0) {
+            fds[nfds].fd = conn->client_fd;
+            fds[nfds].events = side_events(conn->daemon_fd, &conn->out_daemon, &conn->out_client);
+            from_client[nfds] = 1;
+            owner[nfds++] = i;
+         }
+         if (conn->daemon_fd >= 0) {
+            fds[nfds].fd = conn->daemon_fd;
+            fds[nfds].events = side_events(conn->client_fd, &conn->out_client, &conn->out_daemon);
+            from_client[nfds] = 0;
+            owner[nfds++] = i;
+         }
+      }
+
+      if (poll(fds, nfds, -1) < 0) {
+         if (errno == EINTR) {
+            continue;
+         }
+         perror("poll");
+         break;
+      }
+
+      for (nfds_t n = 1; n < nfds; n++) {
+         connection_t* conn = &connections[owner[n]];
+         int* fd = from_client[n] ? &conn->client_fd : &conn->daemon_fd;
+         stream_buffer_t* out = from_client[n] ? &conn->out_client : &conn->out_daemon;
+
+         /* The side may have been closed while handling an earlier descriptor */
+         if (!conn->in_use || *fd != fds[n].fd || fds[n].revents == 0) {
+            continue;
+         }
+
+         if ((fds[n].revents & POLLOUT) && flush_output(*fd, out) < 0) {
+            close_connection(conn);
+            continue;
+         }
+
+         if (fds[n].revents & (POLLIN | POLLHUP | POLLERR)) {
+            relay_status_t status = relay(conn, from_client[n]);
+
+            if (status == RELAY_FAILED) {
+               close_connection(conn);
+               continue;
+            }
+            if (status == RELAY_EOF) {
+               /* Nothing more can be delivered to a side that has gone */
+               close(*fd);
+               *fd = -1;
+               out->length = 0;
+            }
+         }
+
+         /* Once one side is gone, the connection ends when its peer has been sent everything */
+         if ((conn->client_fd < 0 && conn->out_daemon.length == 0) ||
+            (conn->daemon_fd < 0 && conn->out_client.length == 0)) {
+            close_connection(conn);
+         }
+      }
+
+      if (fds[0].revents & POLLIN) {
+         int client_fd = accept(listen_fd, NULL, NULL);
+         int daemon_fd;
+
+         if (client_fd < 0) {
+            continue;
+         }
+         daemon_fd = connect_daemon(daemon_path);
+         for (i = 0; i < MAX_CONNECTIONS && connections[i].in_use; i++) {
+         }
+         if (daemon_fd < 0 || i == MAX_CONNECTIONS ||
+            set_nonblocking(client_fd) < 0 || set_nonblocking(daemon_fd) < 0) {
+            fprintf(stderr, "Dropping client: %s\n",
+               daemon_fd < 0 ? "cannot connect to daemon" :
+               i == MAX_CONNECTIONS ? "too many connections" : "cannot make sockets non-blocking");
+            close(client_fd);
+            if (daemon_fd >= 0) {
+               close(daemon_fd);
+            }
+            continue;
+         }
+         connections[i].in_use = 1;
+         connections[i].client_fd = client_fd;
+         connections[i].daemon_fd = daemon_fd;
+         connections[i].client_port = (uint16_t)(CLIENT_PORT_BASE + connection_count++ % (65535 - CLIENT_PORT_BASE));
+      }
+   }
+
+   for (i = 0; i < MAX_CONNECTIONS; i++) {
+      if (connections[i].in_use) {
+         close_connection(&connections[i]);
+      }
+   }
+   close(listen_fd);
+   unlink(listen_path);
+   fprintf(stderr, "%lu messages written\n", messages_written);
+   if (output != stdout) {
+      fclose(output);
+   }
+   return 0;
+}